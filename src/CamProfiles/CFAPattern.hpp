@@ -25,11 +25,20 @@
 struct CFAPattern {
     enum class Filter;
     enum class Color;
+    template<Filter F, int RowParity> struct RowColors;
 
     CFAPattern(Filter filter);
     Color operator()(int row, int col) const;
     Filter getFilter() const;
 
+    template<typename Kernel>
+    void dispatch(Kernel&& kernel) const;
+
+    static constexpr Color color(Filter filter, int row, int col);
+    static constexpr int channel(Color color);
+    static constexpr bool isGreen(Color color);
+    static constexpr int firstColumn(int col, int parity);
+
 private:
     using Pattern = Color[2][2];
     static const Pattern k_cfaList[];
@@ -104,3 +113,98 @@ inline CFAPattern::Filter CFAPattern::getFilter() const
 {
     return m_filter;
 }
+
+/// <summary>
+/// Run a kernel specialised for the filter
+/// </summary>
+/// <param name="kernel">Template lambda called with the filter as
+/// its template argument, so it is selected once per image</param>
+template<typename Kernel>
+inline void CFAPattern::dispatch(Kernel&& kernel) const
+{
+    switch (m_filter) {
+    case Filter::RGGB:
+        kernel.template operator()<Filter::RGGB>();
+        break;
+    case Filter::GBRG:
+        kernel.template operator()<Filter::GBRG>();
+        break;
+    case Filter::BGGR:
+        kernel.template operator()<Filter::BGGR>();
+        break;
+    default: // Filter::GRBG
+        kernel.template operator()<Filter::GRBG>();
+        break;
+    }
+    return;
+}
+
+/// <summary>
+/// Filter color at compile time
+/// </summary>
+/// <param name="filter">Filter configuration</param>
+/// <param name="row">Row</param>
+/// <param name="col">Column</param>
+/// <returns>Filter color on row and column</returns>
+/// <remarks>
+/// The configurations are RGGB shifted by a row and/or column.
+/// </remarks>
+constexpr CFAPattern::Color CFAPattern::color(Filter filter, int row, int col)
+{
+    const bool rowShift = (filter == Filter::GBRG || filter == Filter::BGGR);
+    const bool colShift = (filter == Filter::BGGR || filter == Filter::GRBG);
+    const bool blueRow = ((row + rowShift) & 1) != 0;
+    const bool secondCol = ((col + colShift) & 1) != 0;
+
+    if (blueRow)
+        return secondCol ? Color::BLUE : Color::GREEN_B;
+    return secondCol ? Color::GREEN_R : Color::RED;
+}
+
+/// <summary>
+/// RGB channel index of the filter color
+/// </summary>
+/// <param name="color">Filter color</param>
+/// <returns>Index 0 for red, 1 for green and 2 for blue</returns>
+constexpr int CFAPattern::channel(Color color)
+{
+    return (color == Color::RED) ? 0 : (color == Color::BLUE ? 2 : 1);
+}
+
+/// <summary>
+/// Test for green filter color
+/// </summary>
+/// <param name="color">Filter color</param>
+/// <returns>True for both greens</returns>
+constexpr bool CFAPattern::isGreen(Color color)
+{
+    return color == Color::GREEN_R || color == Color::GREEN_B;
+}
+
+/// <summary>
+/// First column of a parity
+/// </summary>
+/// <param name="col">Starting column</param>
+/// <param name="parity">Column parity</param>
+/// <returns>The starting or the next column</returns>
+constexpr int CFAPattern::firstColumn(int col, int parity)
+{
+    return col + ((col ^ parity) & 1);
+}
+
+/// <summary>
+/// Colors of a row known at compile time
+/// </summary>
+/// <remarks>
+/// Kernels templated by it process the even and odd columns with
+/// strides of two and without any test of the color.
+/// </remarks>
+template<CFAPattern::Filter F, int RowParity>
+struct CFAPattern::RowColors {
+    static constexpr Color even = color(F, RowParity, 0);
+    static constexpr Color odd = color(F, RowParity, 1);
+
+    // Red or blue of the row and parity of its columns
+    static constexpr Color chroma = isGreen(even) ? odd : even;
+    static constexpr int chromaParity = isGreen(even) ? 1 : 0;
+};
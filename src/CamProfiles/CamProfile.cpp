@@ -29,7 +29,8 @@ using std::string_view;
 /// Apply camera HSV maps if present
 /// </summary>
 /// <param name="val">Value to be processed</param>
-void CamProfile::applyHSVMap(Color::HSV64& val) const
+template<typename T>
+void CamProfile::applyHSVMap(Color::BasicHSV<T>& val) const
 {
     if (m_hsvMap != nullptr) {
         m_hsvMap->transform(val);
@@ -40,13 +41,20 @@ void CamProfile::applyHSVMap(Color::HSV64& val) const
 /// Apply default profile look if present
 /// </summary>
 /// <param name="val">Value to be processed</param>
-void CamProfile::applyProfileLook(Color::HSV64& val) const
+template<typename T>
+void CamProfile::applyProfileLook(Color::BasicHSV<T>& val) const
 {
     if (m_profileLook != nullptr) {
         m_profileLook->transform(val);
     }
 }
 
+// Double and single precision computation
+template void CamProfile::applyHSVMap(Color::HSV64&) const;
+template void CamProfile::applyHSVMap(Color::HSV32&) const;
+template void CamProfile::applyProfileLook(Color::HSV64&) const;
+template void CamProfile::applyProfileLook(Color::HSV32&) const;
+
 /// <summary>
 /// Check if one or more HSV maps exists
 /// </summary>
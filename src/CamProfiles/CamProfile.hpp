@@ -81,8 +81,10 @@ public:
     [[nodiscard]] Mat3x3 getAnalogBalanceMatrix() const;
 
     // HSV Maps
-    void applyHSVMap(Color::HSV64 &val) const;
-    void applyProfileLook(Color::HSV64 &val) const;
+    template<typename T>
+    void applyHSVMap(Color::BasicHSV<T> &val) const;
+    template<typename T>
+    void applyProfileLook(Color::BasicHSV<T> &val) const;
     [[nodiscard]] bool hasHSVMaps() const;
 
     // Factory methods
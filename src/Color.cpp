@@ -58,6 +58,22 @@ static double fn(double val, double white)
     return (903.3 * val + 16) / 116;
 }
 
+double Color::LabTable::exactRoot(double val) noexcept
+{
+    return fn(val, 1.0);
+}
+
+Color::LabTable::LabTable(const CIEXYZ& white)
+    : m_scale{k_steps / (k_range * white.x),
+        k_steps / (k_range * white.y), k_steps / (k_range * white.z)}
+{
+    // One more entry for interpolation of the last step
+    for (int i = 0; i <= k_steps; ++i) {
+        m_root[i] = exactRoot(i * (k_range / k_steps));
+        m_root32[i] = static_cast<float>(m_root[i]);
+    }
+}
+
 void Color::xyz2Lab(
     const CIEXYZ& in, CIELab& out, const CIEXYZ& white)
 {
@@ -67,51 +83,53 @@ void Color::xyz2Lab(
     out.b = 200 * (fy - fn(in.z, white.z));
 }
 
-Color::HSV64 Color::rgb2hsv(const Color::RGB64& rgb)
+template<typename T>
+Color::BasicHSV<T> Color::rgb2hsv(const Color::BasicRGB<T>& rgb)
 {
-    Color::HSV64 res{};
+    Color::BasicHSV<T> res{};
 
     // Calculate value
     res.val = Utils::max3(rgb.r, rgb.g, rgb.b);
-    const double delta = res.val - Utils::min3(rgb.r, rgb.g, rgb.b);
+    const T delta = res.val - Utils::min3(rgb.r, rgb.g, rgb.b);
 
-    if (delta < 0.00001) {
-        res.sat = 0.0; // Black
+    if (delta < T(0.00001)) {
+        res.sat = 0; // Black
     }
     else {
         // Saturation
-        res.sat = delta / (res.val == 0.0 ? 1.0 : res.val);
+        res.sat = delta / (res.val == 0 ? 1 : res.val);
 
         // Hue
         if (rgb.r == res.val) {
             res.hue = (rgb.g - rgb.b) / delta;
         }
         else if (rgb.g == res.val) {
-            res.hue = 2.0 + (rgb.b - rgb.r) / delta;
+            res.hue = 2 + (rgb.b - rgb.r) / delta;
         }
         else if (rgb.b == res.val) {
-            res.hue = 4.0 + (rgb.r - rgb.g) / delta;
+            res.hue = 4 + (rgb.r - rgb.g) / delta;
         }
-        res.hue /= 6.0;
+        res.hue /= 6;
 
         // If hue is negative, then warp
-        if (res.hue < 0.0) {
-            res.hue += 1.0;
+        if (res.hue < 0) {
+            res.hue += 1;
         }
     }
     return res;
 }
 
-Color::RGB64 Color::hsv2rgb(const Color::HSV64& hsv)
+template<typename T>
+Color::BasicRGB<T> Color::hsv2rgb(const Color::BasicHSV<T>& hsv)
 {
-    const double sector = 6 * hsv.hue; // Sector 0 to 6
+    const T sector = 6 * hsv.hue; // Sector 0 to 6
     const int sectorIndex = static_cast<int>(sector);
-    const double f = sector - sectorIndex; // Fractional part inside sector
+    const T f = sector - sectorIndex; // Fractional part inside sector
 
     // RGB ramp functions
-    const double n = hsv.val * (1 - hsv.sat),
-                 o = hsv.val * (1 - hsv.sat * f),
-                 e = hsv.val * (1 - hsv.sat * (1 - f));
+    const T n = hsv.val * (1 - hsv.sat),
+            o = hsv.val * (1 - hsv.sat * f),
+            e = hsv.val * (1 - hsv.sat * (1 - f));
 
     // Compose the output
     switch (sectorIndex) {
@@ -130,3 +148,9 @@ Color::RGB64 Color::hsv2rgb(const Color::HSV64& hsv)
     }
     return {hsv.val, e, n}; // Sector index 0 || 6
 }
+
+// Double and single precision computation
+template Color::HSV64 Color::rgb2hsv(const Color::RGB64&);
+template Color::HSV32 Color::rgb2hsv(const Color::RGB32&);
+template Color::RGB64 Color::hsv2rgb(const Color::HSV64&);
+template Color::RGB32 Color::hsv2rgb(const Color::HSV32&);
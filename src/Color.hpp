@@ -20,28 +20,33 @@
 
 #pragma once
 
+#include <array>
 #include <cinttypes>
+#include <cmath>
 #include <cstdlib>
+#include <type_traits>
 
 #include "Structures/Mat3x3.hpp"
 
 namespace Color {
 
-struct CIEXYZ {
-    double x, y, z;
+template<typename T>
+struct BasicXYZ {
+    T x, y, z;
 };
 
-struct CIELab {
-    double L, a, b;
+template<typename T>
+struct BasicLab {
+    T L, a, b;
 
     // Distance functions
-    [[nodiscard]] double dl(const CIELab& val) const noexcept
+    [[nodiscard]] T dl(const BasicLab& val) const noexcept
     {
         return std::abs(L - val.L);
     }
-    [[nodiscard]] double dc(const CIELab& val) const noexcept
+    [[nodiscard]] T dc(const BasicLab& val) const noexcept
     {
-        const double adiff = a - val.a, bdiff = b - val.b;
+        const T adiff = a - val.a, bdiff = b - val.b;
         return adiff * adiff + bdiff * bdiff;
     }
 };
@@ -50,12 +55,25 @@ struct CIEuv {
     double u, v;
 };
 
-struct HSV64 {
-    double hue, sat, val;
+template<typename T>
+struct BasicHSV {
+    T hue, sat, val;
 };
-struct RGB64 {
-    double r, g, b;
+template<typename T>
+struct BasicRGB {
+    T r, g, b;
 };
+
+// Computation types of double and single precision
+using CIEXYZ = BasicXYZ<double>;
+using CIEXYZ32 = BasicXYZ<float>;
+using CIELab = BasicLab<double>;
+using CIELab32 = BasicLab<float>;
+using HSV64 = BasicHSV<double>;
+using HSV32 = BasicHSV<float>;
+using RGB64 = BasicRGB<double>;
+using RGB32 = BasicRGB<float>;
+
 struct RGB16 {
     uint16_t r, g, b;
 };
@@ -79,19 +97,21 @@ extern const Mat3x3 k_matXYZtoProPhotoRGB;
 ////////////////////////////////////////////////////////////////////////////
 
 void xyz2Lab(const CIEXYZ& in, CIELab& out, const CIEXYZ& white);
-Color::HSV64 rgb2hsv(const Color::RGB64& rgbValue);
-Color::RGB64 hsv2rgb(const Color::HSV64& hsv);
+template<typename T>
+BasicHSV<T> rgb2hsv(const BasicRGB<T>& rgbValue);
+template<typename T>
+BasicRGB<T> hsv2rgb(const BasicHSV<T>& hsv);
 
 template<typename TOut, typename TIn>
 inline auto xyzTo(const Mat3x3& convMatrix, const TIn& xyz) noexcept
 {
-    return convMatrix.multiply<TOut>(xyz.x, xyz.y, xyz.z);
+    return convMatrix.multiply<TOut, decltype(xyz.x)>(xyz.x, xyz.y, xyz.z);
 }
 
 template<typename TOut, typename TIn>
 inline auto rgbTo(const Mat3x3& convMatrix, const TIn& rgb) noexcept
 {
-    return convMatrix.multiply<TOut>(rgb.r, rgb.g, rgb.b);
+    return convMatrix.multiply<TOut, decltype(rgb.r)>(rgb.r, rgb.g, rgb.b);
 }
 
 // Convert uv coordinates to XYZ coordinates
@@ -100,6 +120,60 @@ inline CIEXYZ uvToXYZ(const CIEuv& uv, const double Y) noexcept
     return {1.5 * uv.u / uv.v, Y, (2.0 - 0.5 * uv.u) / uv.v - 5.0};
 }
 
+/// <summary>
+/// Fast conversion XYZ to Lab
+/// </summary>
+/// <remarks>
+/// The cube root of xyz2Lab is read from a table of 4096 steps over
+/// the relative range [0, 2] with linear interpolation. Values out of
+/// the table fall back to the exact formula. The interpolation error
+/// of the root is below 2e-5, that is below 2e-3 in L and 2e-2 in a, b.
+/// Meant for comparisons like the AHD homogeneity test.
+/// </remarks>
+class LabTable {
+public:
+    static constexpr int k_steps = 4096;
+    static constexpr double k_range = 2.0;
+
+    explicit LabTable(const CIEXYZ& white);
+
+    template<typename T>
+    [[nodiscard]] BasicLab<T> operator()(const BasicXYZ<T>& in) const noexcept
+    {
+        const T fy = root<T>(in.y * m_scale.y);
+        return {116 * fy - 16,
+            500 * (root<T>(in.x * m_scale.x) - fy),
+            200 * (fy - root<T>(in.z * m_scale.z))};
+    }
+
+private:
+    // Scale of input to the table index
+    CIEXYZ m_scale;
+    std::array<double, k_steps + 1> m_root;
+    std::array<float, k_steps + 1> m_root32;
+
+    template<typename T>
+    [[nodiscard]] T root(T pos) const noexcept
+    {
+        const auto& table = rootTable<T>();
+        if (pos >= 0 && pos < k_steps) {
+            const int idx = static_cast<int>(pos);
+            const T frac = pos - idx;
+            return table[idx] + frac * (table[idx + 1] - table[idx]);
+        }
+        return static_cast<T>(exactRoot(pos * (k_range / k_steps)));
+    }
+    template<typename T>
+    [[nodiscard]] const std::array<T, k_steps + 1>& rootTable() const noexcept
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return m_root32;
+        else
+            return m_root;
+    }
+    static double exactRoot(double val) noexcept;
+};
+
 inline double kelvin2mired(const double temp)
 {
     return 1e6 / temp;
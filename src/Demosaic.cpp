@@ -24,12 +24,15 @@
 #include "StopWatch.hpp"
 #include "Logger.hpp"
 #include "RawDev.hpp"
+#include "Structures/Image.hpp"
 
 #include "Demosaic/AlgorithmType.hpp"
 #include "Demosaic/Bilinear.hpp"
 #include "Demosaic/Freeman.hpp"
 #include "Demosaic/HQLinear.hpp"
 #include "Demosaic/AHD.hpp"
+#include "Demosaic/RCD.hpp"
+#include "Demosaic/Hybrid.hpp"
 
 #include <iostream>
 using namespace std;
@@ -51,6 +54,12 @@ DemosaicModule::DemosaicModule(const Options &opt)
     case Demosaic::AlgorithmType::HQLinear:
         m_Algorithm = make_shared<Demosaic::HQLinear>();
         break;
+    case Demosaic::AlgorithmType::RCD:
+        m_Algorithm = make_shared<Demosaic::RCD>();
+        break;
+    case Demosaic::AlgorithmType::Hybrid:
+        m_Algorithm = make_shared<Demosaic::Hybrid>();
+        break;
     default: // AlgorithmType::AHD
         m_Algorithm = make_shared<Demosaic::AHD>();
         break;
@@ -91,8 +100,14 @@ void DemosaicModule::printLogo(Logger &os) const
 /// Do the selected demosaicing
 /// </summary>
 /// <param name="img">Image to be demosaiced</param>
+/// <remarks>
+/// The module takes the mosaic over from the image, so the algorithm
+/// reads it as a separate source and it is released afterwards.
+/// </remarks>
 inline void DemosaicModule::process(Image &img)
 {
-    m_Algorithm->demosaic(img);
+    const Mosaic raw = img.takeMosaic(); // Source CFA data
+    img.allocateRGB(raw);
+    m_Algorithm->demosaic(raw, img);
     return;
 }
@@ -20,6 +20,8 @@
 
 #include "AHD.hpp"
 
+#include "Border.hpp"
+#include "RowAdvice.hpp"
 #include "Structures/Array2D.hpp"
 #include "Structures/Mat3x3.hpp"
 #include "CamProfiles/CamProfile.hpp"
@@ -28,8 +30,17 @@
 #include "Utils.hpp"
 #include "Logger.hpp"
 
+#include <algorithm>
 #include <omp.h>
 
+/// <summary>
+/// Construct with the selected tile kernels
+/// </summary>
+/// <param name="kernels">Scalar reference or vectorised kernels</param>
+Demosaic::AHD::AHD(Kernels kernels)
+    : m_Kernels(kernels), m_lab(Color::k_d50)
+{ }
+
 /// <summary>
 /// Virtual empty destructor
 /// </summary>
@@ -39,36 +50,121 @@ Demosaic::AHD::~AHD()
 /// <summary>
 /// Adaptive homogeneity demosaicing algorithm
 /// </summary>
-/// <param name="img">Image to be demosaiced</param>
-void Demosaic::AHD::demosaic(Image& img)
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+void Demosaic::AHD::demosaic(const Mosaic& raw, Image& img)
 {
-    // Matrix for conversion to Lab
-    const Mat3x3 cam2XYZ = img.getCamProfile()->getColorMatrix().inverse();
-    const Rect active = img.getCamProfile()->getActiveArea();
+    const TilePlan plan = planTiles(img);
+    demosaic(raw, img, plan);
+    fillBorder(raw, img, plan.bounds());
+    return;
+}
 
-    const Image raw(img); // Fixed raw image data
+/// <summary>
+/// Tiles of the image, all selected
+/// </summary>
+/// <param name="img">Image for the result</param>
+/// <returns>Tile plan</returns>
+Demosaic::AHD::TilePlan Demosaic::AHD::planTiles(const Image& img) const
+{
+    const Rect active = img.getCamProfile()->getActiveArea();
     const int xmargin = active.left + 2, ymargin = active.top + 2;
-    const int xTileCount = calcTileCount(active.right - active.left - 7, xTileSize - 6);
-    const int tileCount = xTileCount
+    TilePlan plan;
+
+    plan.xCount = calcTileCount(active.right - active.left - 7, xTileSize - 6);
+    const int tileCount = plan.xCount
         * calcTileCount(active.bottom - active.top - 7, yTileSize - 6);
+
+    for (int t = 0; t < tileCount; t++)
+    {
+        const div_t tmpdiv = std::div(t, plan.xCount);
+        const int rbase = ymargin + (yTileSize - 6) * tmpdiv.quot;
+        const int cbase = xmargin + (yTileSize - 6) * tmpdiv.rem;
+        const int erow = std::min(rbase + yTileSize - tilePadding, img.getHeight() - 5);
+        const int ecol = std::min(cbase + xTileSize - tilePadding, img.getWidth() - 5);
+
+        plan.areas.emplace_back(Point(cbase + tilePadding, rbase + tilePadding),
+            Point(ecol, erow));
+    }
+    plan.selected.assign(tileCount, true);
+    return plan;
+}
+
+/// <summary>
+/// Area covered by all tiles of the plan
+/// </summary>
+/// <returns>Bounding rectangle, empty without tiles</returns>
+Rect Demosaic::AHD::TilePlan::bounds() const
+{
+    if (areas.empty())
+        return Rect();
+    return Rect(Point(areas.front().left, areas.front().top),
+        Point(areas.back().right, areas.back().bottom));
+}
+
+/// <summary>
+/// Adaptive homogeneity demosaicing of the selected tiles
+/// </summary>
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <param name="plan">Tiles to demosaic</param>
+void Demosaic::AHD::demosaic(const Mosaic& raw, Image& img, const TilePlan& plan)
+{
+    // Matrix for conversion to Lab
+    const Mat3x3 cam2XYZ = img.getCamProfile()->getColorMatrix().inverse();
+    std::vector<Point> bases; // Base of the selected tiles
+    std::vector<int> tileRows; // Their rows of tiles
+
+    for (size_t t = 0; t < plan.areas.size(); t++) {
+        if (plan.selected[t]) {
+            bases.emplace_back(plan.areas[t].left - tilePadding,
+                plan.areas[t].top - tilePadding);
+            tileRows.push_back(static_cast<int>(t) / plan.xCount);
+        }
+    }
+    RowAdvice advice(raw, std::move(tileRows));
+
+    dispatchPrecision(raw.getPrecision(), [&]<typename T>() {
+        if (m_Kernels == Kernels::Scalar)
+            demosaicScalar<T>(raw, img, cam2XYZ, bases, advice);
+        else
+            demosaicVector<T>(raw, img, cam2XYZ, bases, advice);
+    });
+    return;
+}
+
+/// <summary>
+/// Demosaic tiles by the scalar reference kernels
+/// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <param name="cam2XYZ">Prepared matrix for LAB conversion</param>
+/// <param name="bases">Base points of the tiles</param>
+/// <param name="advice">Memory advice for the rows of tiles</param>
+template<typename T>
+void Demosaic::AHD::demosaicScalar(const Mosaic& raw, Image& img,
+    const Mat3x3& cam2XYZ, const std::vector<Point>& bases, RowAdvice& advice)
+{
+    const int tileCount = static_cast<int>(bases.size());
     const CFAPattern cfa = img.getCamProfile()->getCFAPattern();
 
     #pragma omp parallel
     {
         // Needed data structures (tile 512 cca. 25MB per core)
-        Array2D<Color::RGB64> himg(xTileSize, yTileSize);
-        Array2D<Color::RGB64> vimg(xTileSize, yTileSize);
-        Array2D<Color::CIELab> himgLab(xTileSize, yTileSize);
-        Array2D<Color::CIELab> vimgLab(xTileSize, yTileSize);
+        Array2D<Color::BasicRGB<T>> himg(xTileSize, yTileSize);
+        Array2D<Color::BasicRGB<T>> vimg(xTileSize, yTileSize);
+        Array2D<Color::BasicLab<T>> himgLab(xTileSize, yTileSize);
+        Array2D<Color::BasicLab<T>> vimgLab(xTileSize, yTileSize);
         Array2D<homo_t> hhomo(xTileSize, yTileSize);
         Array2D<homo_t> vhomo(xTileSize, yTileSize);
 
         #pragma omp for schedule(dynamic) nowait
         for (int t = 0; t < tileCount; t++)
         {
-            const div_t tmpdiv = std::div(t, xTileCount);
-            const int rbase = ymargin + (yTileSize - 6) * tmpdiv.quot;
-            const int cbase = xmargin + (yTileSize - 6) * tmpdiv.rem;
+            const int rbase = bases[t].y;
+            const int cbase = bases[t].x;
+            advice.begin(rbase, rbase + yTileSize);
 
             // AHD demosaicing algorithm
             interGreen(raw, cfa, rbase, cbase, himg, vimg);
@@ -77,6 +173,49 @@ void Demosaic::AHD::demosaic(Image& img)
             generateHomogenityMasks(raw, rbase, cbase,
                 himgLab, hhomo, vimgLab, vhomo);
             composeOutput(img, rbase, cbase, himg, hhomo, vimg, vhomo);
+            advice.finish(t, rbase, rbase + yTileSize);
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Demosaic tiles by the vectorised kernels
+/// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <param name="cam2XYZ">Prepared matrix for LAB conversion</param>
+/// <param name="bases">Base points of the tiles</param>
+/// <param name="advice">Memory advice for the rows of tiles</param>
+/// <remarks>
+/// Gives exactly the same results as the scalar kernels.
+/// </remarks>
+template<typename T>
+void Demosaic::AHD::demosaicVector(const Mosaic& raw, Image& img,
+    const Mat3x3& cam2XYZ, const std::vector<Point>& bases, RowAdvice& advice)
+{
+    const int tileCount = static_cast<int>(bases.size());
+    const CFAPattern cfa = img.getCamProfile()->getCFAPattern();
+
+    #pragma omp parallel
+    {
+        VectorTile<T> tile; // Tile 512 cca. 28MB per core
+
+        #pragma omp for schedule(dynamic) nowait
+        for (int t = 0; t < tileCount; t++)
+        {
+            const int rbase = bases[t].y;
+            const int cbase = bases[t].x;
+            advice.begin(rbase, rbase + yTileSize);
+
+            // AHD demosaicing algorithm
+            loadTile(raw, rbase, cbase, tile);
+            interGreen(raw, cfa, rbase, cbase, tile);
+            interRedBlue(raw, cfa, rbase, cbase, tile, 0, cam2XYZ);
+            interRedBlue(raw, cfa, rbase, cbase, tile, 1, cam2XYZ);
+            composeOutput(img, rbase, cbase, tile);
+            advice.finish(t, rbase, rbase + yTileSize);
         }
     }
     return;
@@ -101,41 +240,44 @@ void Demosaic::AHD::printLogo(Logger &os) const
 /// <param name="bcol">Tile base column</param>
 /// <param name="himg">Horizontal interpolated image</param>
 /// <param name="vimg">Vertical interpolated image</param>
+template<typename T>
 void Demosaic::AHD::interGreen(
-    const Image& img, const CFAPattern &cfa, int brow, int bcol,
-    Array2D<Color::RGB64>& himg, Array2D<Color::RGB64>& vimg)
+    const Mosaic& img, const CFAPattern &cfa, int brow, int bcol,
+    Array2D<Color::BasicRGB<T>>& himg, Array2D<Color::BasicRGB<T>>& vimg)
 {
     const int erow = std::min(brow + yTileSize, img.getHeight() - 2);
     const int ecol = std::min(bcol + xTileSize, img.getWidth() - 2);
-    Image::Channel ctype; int cfaShift; // Row information
+    CFAPattern::Color ctype; int cfaShift; // Row information
     cfaShift = initRowInfo(cfa, brow, bcol, ctype);
 
     // Interpolate green values
     for (int row = brow; row < erow; row++)
     {
-        ctype = (ctype == Image::Channel::RED)
-            ? Image::Channel::BLUE : Image::Channel::RED;
+        ctype = (ctype == CFAPattern::Color::RED)
+            ? CFAPattern::Color::BLUE : CFAPattern::Color::RED;
         cfaShift ^= 1; // Invert the CFA shift
 
         for (int col = bcol + cfaShift; col < ecol; col += 2)
         {
-            double val, p, q; // Computation variables
+            T val, p, q; // Computation variables
 
             // Base element load (center)
-            const double mid = img.getValueX(row, col, ctype);
+            const T mid = img.getValueX<T>(row, col, ctype);
 
             // Horizontal interpolation
-            p = img.getValueG(row, col - 1);
-            q = img.getValueG(row, col + 1);
-            val = 0.25 * (2 * (mid + p + q) - img.getValueX(row, col - 2, ctype)
-                - img.getValueX(row, col + 2, ctype));
+            p = img.getValueG<T>(row, col - 1);
+            q = img.getValueG<T>(row, col + 1);
+            val = T(0.25) * (2 * (mid + p + q)
+                - img.getValueX<T>(row, col - 2, ctype)
+                - img.getValueX<T>(row, col + 2, ctype));
             himg[row - brow][col - bcol].g = Utils::median(val, p, q);
 
             // Vertical interpolation
-            p = img.getValueG(row - 1, col);
-            q = img.getValueG(row + 1, col);
-            val = 0.25 * (2 * (mid + p + q) - img.getValueX(row - 2, col, ctype)
-                - img.getValueX(row + 2, col, ctype));
+            p = img.getValueG<T>(row - 1, col);
+            q = img.getValueG<T>(row + 1, col);
+            val = T(0.25) * (2 * (mid + p + q)
+                - img.getValueX<T>(row - 2, col, ctype)
+                - img.getValueX<T>(row + 2, col, ctype));
             vimg[row - brow][col - bcol].g = Utils::median(val, p, q);
         }
     }
@@ -154,26 +296,26 @@ void Demosaic::AHD::interGreen(
 /// Note: ctype and cfaShift must be returned inverted to work!
 /// </remarks>
 inline int Demosaic::AHD::initRowInfo(
-    const CFAPattern &cfa, int brow, int bcol, Image::Channel &ctype)
+    const CFAPattern &cfa, int brow, int bcol, CFAPattern::Color &ctype)
 {
     int cfaShift; // Inverted CFA shift to next nongreen filter
 
     switch (cfa(brow, bcol))
     {
     case CFAPattern::Color::RED:
-        ctype = Image::Channel::BLUE;
+        ctype = CFAPattern::Color::BLUE;
         cfaShift = 1;
         break;
     case CFAPattern::Color::BLUE:
-        ctype = Image::Channel::RED;
+        ctype = CFAPattern::Color::RED;
         cfaShift = 1;
         break;
     case CFAPattern::Color::GREEN_R:
-        ctype = Image::Channel::BLUE;
+        ctype = CFAPattern::Color::BLUE;
         cfaShift = 0;
         break;
     default: // CFAPattern::Color::GREEN_B
-        ctype = Image::Channel::RED;
+        ctype = CFAPattern::Color::RED;
         cfaShift = 0;
         break;
     }
@@ -190,12 +332,13 @@ inline int Demosaic::AHD::initRowInfo(
 /// <param name="timg">Interpolated target image</param>
 /// <param name="imgLab">Output LAB image</param>
 /// <param name="cam2XYZ">Prepared matrix for LAB conversion</param>
+template<typename T>
 void Demosaic::AHD::interRedBlue(
-    const Image& img, const CFAPattern &cfa, int brow, int bcol,
-    Array2D<Color::RGB64>& timg, Array2D<Color::CIELab>& imgLab,
+    const Mosaic& img, const CFAPattern &cfa, int brow, int bcol,
+    Array2D<Color::BasicRGB<T>>& timg, Array2D<Color::BasicLab<T>>& imgLab,
     const Mat3x3& cam2XYZ)
 {
-    Color::RGB64 val; // Pixel value variable
+    Color::BasicRGB<T> val; // Pixel value variable
 
     constexpr int padding = 1; // Border inside tile
     const int erow = std::min(brow + yTileSize - padding, img.getHeight() - 3);
@@ -239,10 +382,11 @@ void Demosaic::AHD::interRedBlue(
 /// <param name="hhomo">Horizontal homogeneity</param>
 /// <param name="vimgLab">Vertical interpolated LAB image</param>
 /// <param name="vhomo">Vertical homogeneity</param>
+template<typename T>
 void Demosaic::AHD::generateHomogenityMasks(
-    const Image& img, const int brow, const int bcol,
-    const Array2D<Color::CIELab>& himgLab, Array2D<homo_t>& hhomo,
-    const Array2D<Color::CIELab>& vimgLab, Array2D<homo_t>& vhomo)
+    const Mosaic& img, const int brow, const int bcol,
+    const Array2D<Color::BasicLab<T>>& himgLab, Array2D<homo_t>& hhomo,
+    const Array2D<Color::BasicLab<T>>& vimgLab, Array2D<homo_t>& vhomo)
 {
     constexpr int padding = 2; // Border inside tile
     const int erow = std::min(brow + yTileSize - padding, img.getHeight() - 4) - brow;
@@ -252,13 +396,13 @@ void Demosaic::AHD::generateHomogenityMasks(
         for (int tc = padding; tc < ecol; tc++) {
 
             // Precalculate Lab differences
-            double ldiff[2][4], cdiff[2][4];
-            const Color::CIELab hdata[] = {
+            T ldiff[2][4], cdiff[2][4];
+            const Color::BasicLab<T> hdata[] = {
                 himgLab[tr][tc],
                 himgLab[tr][tc - 1], himgLab[tr][tc + 1],
                 himgLab[tr - 1][tc], himgLab[tr + 1][tc]
             };
-            const Color::CIELab vdata[] = {
+            const Color::BasicLab<T> vdata[] = {
                 vimgLab[tr][tc],
                 vimgLab[tr][tc - 1], vimgLab[tr][tc + 1],
                 vimgLab[tr - 1][tc], vimgLab[tr + 1][tc]
@@ -271,12 +415,12 @@ void Demosaic::AHD::generateHomogenityMasks(
             }
 
             // Adaptive estimate el
-            const double el = std::min(
+            const T el = std::min(
                 std::max(ldiff[0][0], ldiff[0][1]),
                 std::max(ldiff[1][2], ldiff[1][3])
             );
             // Adaptive estimate ec
-            const double ec = std::min(
+            const T ec = std::min(
                 std::max(cdiff[0][0], cdiff[0][1]),
                 std::max(cdiff[1][2], cdiff[1][3])
             );
@@ -304,15 +448,16 @@ void Demosaic::AHD::generateHomogenityMasks(
 /// <param name="hhomo">Horizontal homogeneity</param>
 /// <param name="vimg">Vertical interpolated image</param>
 /// <param name="vhomo">Vertical homogeneity</param>
+template<typename T>
 void Demosaic::AHD::composeOutput(
     Image& img, const int brow, const int bcol,
-    const Array2D<Color::RGB64>& himg, const Array2D<homo_t>& hhomo,
-    const Array2D<Color::RGB64>& vimg, const Array2D<homo_t>& vhomo)
+    const Array2D<Color::BasicRGB<T>>& himg, const Array2D<homo_t>& hhomo,
+    const Array2D<Color::BasicRGB<T>>& vimg, const Array2D<homo_t>& vhomo)
 {
     constexpr int padding = 3; // Border inside tile
     const int erow = std::min(brow + yTileSize - padding, img.getHeight() - 5) - brow;
     const int ecol = std::min(bcol + xTileSize - padding, img.getWidth() - 5) - bcol;
-    Color::RGB64 value;
+    Color::BasicRGB<T> value;
 
     for (int tr = padding; tr < erow; tr++)
     {
@@ -328,10 +473,10 @@ void Demosaic::AHD::composeOutput(
                 value = vimg[tr][tc]; // Value is vertical
             else
             {
-                const Color::RGB64 hval = himg[tr][tc], vval = vimg[tr][tc];
-                value.r = 0.5 * (hval.r + vval.r); // Homogenity doesn't helped
-                value.g = 0.5 * (hval.g + vval.g); // Average values
-                value.b = 0.5 * (hval.b + vval.b);
+                const Color::BasicRGB<T> hval = himg[tr][tc], vval = vimg[tr][tc];
+                value.r = T(0.5) * (hval.r + vval.r); // Homogenity doesn't helped
+                value.g = T(0.5) * (hval.g + vval.g); // Average values
+                value.b = T(0.5) * (hval.b + vval.b);
             }
             img.setValue(brow + tr, bcol + tc, value);
         }
@@ -379,20 +524,21 @@ inline void Demosaic::AHD::averageHomogenity(
 /// <param name="tr">Row inside tiled image</param>
 /// <param name="tc">Column inseide tiled image</param>
 /// <returns>Interpolated pixel value</returns>
-inline Color::RGB64 Demosaic::AHD::interOnGreenR(
-    const Image& img, const int row, const int col,
-    const Array2D<Color::RGB64>& tileimg, const int tr, const int tc)
+template<typename T>
+inline Color::BasicRGB<T> Demosaic::AHD::interOnGreenR(
+    const Mosaic& img, const int row, const int col,
+    const Array2D<Color::BasicRGB<T>>& tileimg, const int tr, const int tc)
 {
-    Color::RGB64 val;
-    val.g = img.getValueG(row, col); // Green is known
+    Color::BasicRGB<T> val;
+    val.g = img.getValueG<T>(row, col); // Green is known
 
     // R = G * (R1 - G1 + R2 - G2)/2
-    val.r = val.g + 0.5 * (img.getValueR(row, col - 1) - tileimg[tr][tc - 1].g
-        + img.getValueR(row, col + 1) - tileimg[tr][tc + 1].g);
+    val.r = val.g + T(0.5) * (img.getValueR<T>(row, col - 1) - tileimg[tr][tc - 1].g
+        + img.getValueR<T>(row, col + 1) - tileimg[tr][tc + 1].g);
 
     // B = G * (B1 - G1 + B2 - G2)/2
-    val.b = val.g + 0.5 * (img.getValueB(row - 1, col) - tileimg[tr - 1][tc].g
-        + img.getValueB(row + 1, col) - tileimg[tr + 1][tc].g);
+    val.b = val.g + T(0.5) * (img.getValueB<T>(row - 1, col) - tileimg[tr - 1][tc].g
+        + img.getValueB<T>(row + 1, col) - tileimg[tr + 1][tc].g);
     return val;
 }
 
@@ -406,20 +552,21 @@ inline Color::RGB64 Demosaic::AHD::interOnGreenR(
 /// <param name="tr">Row inside tiled image</param>
 /// <param name="tc">Column inseide tiled image</param>
 /// <returns>Interpolated pixel value</returns>
-inline Color::RGB64 Demosaic::AHD::interOnGreenB(
-    const Image& img, const int row, const int col,
-    const Array2D<Color::RGB64>& tileimg, const int tr, const int tc)
+template<typename T>
+inline Color::BasicRGB<T> Demosaic::AHD::interOnGreenB(
+    const Mosaic& img, const int row, const int col,
+    const Array2D<Color::BasicRGB<T>>& tileimg, const int tr, const int tc)
 {
-    Color::RGB64 val;
-    val.g = img.getValueG(row, col); // Green is known
+    Color::BasicRGB<T> val;
+    val.g = img.getValueG<T>(row, col); // Green is known
 
     // B = G * (B1 - G1 + B2 - G2)/2
-    val.b = val.g + 0.5 * (img.getValueB(row, col - 1) - tileimg[tr][tc - 1].g
-        + img.getValueB(row, col + 1) - tileimg[tr][tc + 1].g);
+    val.b = val.g + T(0.5) * (img.getValueB<T>(row, col - 1) - tileimg[tr][tc - 1].g
+        + img.getValueB<T>(row, col + 1) - tileimg[tr][tc + 1].g);
 
     // R = G * (R1 - G1 + R2 - G2)/2
-    val.r = val.g + 0.5 * (img.getValueR(row - 1, col) - tileimg[tr - 1][tc].g
-        + img.getValueR(row + 1, col) - tileimg[tr + 1][tc].g);
+    val.r = val.g + T(0.5) * (img.getValueR<T>(row - 1, col) - tileimg[tr - 1][tc].g
+        + img.getValueR<T>(row + 1, col) - tileimg[tr + 1][tc].g);
     return val;
 }
 
@@ -433,19 +580,20 @@ inline Color::RGB64 Demosaic::AHD::interOnGreenB(
 /// <param name="tr">Row inside tiled image</param>
 /// <param name="tc">Column inseide tiled image</param>
 /// <returns>Interpolated pixel value</returns>
-inline Color::RGB64 Demosaic::AHD::interOnRed(
-    const Image& img, const int row, const int col,
-    const Array2D<Color::RGB64>& tileimg, const int tr, const int tc)
+template<typename T>
+inline Color::BasicRGB<T> Demosaic::AHD::interOnRed(
+    const Mosaic& img, const int row, const int col,
+    const Array2D<Color::BasicRGB<T>>& tileimg, const int tr, const int tc)
 {
-    Color::RGB64 val;
-    val.r = img.getValueR(row, col);
+    Color::BasicRGB<T> val;
+    val.r = img.getValueR<T>(row, col);
     val.g = tileimg[tr][tc].g; // Interpolated G from prev. step
 
     // Interpolate B from diagonal Blue elements
-    val.b = val.g + (img.getValueB(row - 1, col - 1) - tileimg[tr - 1][tc - 1].g
-        + img.getValueB(row + 1, col + 1) - tileimg[tr + 1][tc + 1].g
-        + img.getValueB(row + 1, col - 1) - tileimg[tr + 1][tc - 1].g
-        + img.getValueB(row - 1, col + 1) - tileimg[tr - 1][tc + 1].g) * 0.25;
+    val.b = val.g + (img.getValueB<T>(row - 1, col - 1) - tileimg[tr - 1][tc - 1].g
+        + img.getValueB<T>(row + 1, col + 1) - tileimg[tr + 1][tc + 1].g
+        + img.getValueB<T>(row + 1, col - 1) - tileimg[tr + 1][tc - 1].g
+        + img.getValueB<T>(row - 1, col + 1) - tileimg[tr - 1][tc + 1].g) * T(0.25);
     return val;
 }
 
@@ -459,19 +607,20 @@ inline Color::RGB64 Demosaic::AHD::interOnRed(
 /// <param name="tr">Row inside tiled image</param>
 /// <param name="tc">Column inseide tiled image</param>
 /// <returns>Interpolated pixel value</returns>
-inline Color::RGB64 Demosaic::AHD::interOnBlue(
-    const Image& img, const int row, const int col,
-    const Array2D<Color::RGB64>& tileimg, const int tr, const int tc)
+template<typename T>
+inline Color::BasicRGB<T> Demosaic::AHD::interOnBlue(
+    const Mosaic& img, const int row, const int col,
+    const Array2D<Color::BasicRGB<T>>& tileimg, const int tr, const int tc)
 {
-    Color::RGB64 val;
-    val.b = img.getValueB(row, col);
+    Color::BasicRGB<T> val;
+    val.b = img.getValueB<T>(row, col);
     val.g = tileimg[tr][tc].g; // Interpolated G from prev. step
 
     // Interpolate R from diagonal Red elements
-    val.r = val.g + (img.getValueR(row - 1, col - 1) - tileimg[tr - 1][tc - 1].g
-        + img.getValueR(row + 1, col + 1) - tileimg[tr + 1][tc + 1].g
-        + img.getValueR(row + 1, col - 1) - tileimg[tr + 1][tc - 1].g
-        + img.getValueR(row - 1, col + 1) - tileimg[tr - 1][tc + 1].g) * 0.25;
+    val.r = val.g + (img.getValueR<T>(row - 1, col - 1) - tileimg[tr - 1][tc - 1].g
+        + img.getValueR<T>(row + 1, col + 1) - tileimg[tr + 1][tc + 1].g
+        + img.getValueR<T>(row + 1, col - 1) - tileimg[tr + 1][tc - 1].g
+        + img.getValueR<T>(row - 1, col + 1) - tileimg[tr - 1][tc + 1].g) * T(0.25);
     return val;
 }
 
@@ -481,13 +630,11 @@ inline Color::RGB64 Demosaic::AHD::interOnBlue(
 /// <param name="cam2XYZ">Conversion matrix from camera to XYZ</param>
 /// <param name="src">Source data for conversion</param>
 /// <returns>Converted CIE LAB value</returns>
-inline Color::CIELab
-Demosaic::AHD::camRGB2Lab(const Mat3x3& cam2XYZ, const Color::RGB64& src)
+template<typename T>
+inline Color::BasicLab<T>
+Demosaic::AHD::camRGB2Lab(const Mat3x3& cam2XYZ, const Color::BasicRGB<T>& src)
 {
-    const auto input{Color::rgbTo<Color::CIEXYZ>(cam2XYZ, src)};
-    Color::CIELab output;
-    Color::xyz2Lab(input, output, Color::k_d50);
-    return output;
+    return m_lab(Color::rgbTo<Color::BasicXYZ<T>>(cam2XYZ, src));
 }
 
 /// <summary>
@@ -501,3 +648,406 @@ inline int Demosaic::AHD::calcTileCount(int dim, int rts)
     const double tmpdim = ceil(static_cast<double>(dim) / (rts));
     return static_cast<int>(tmpdim);
 }
+
+///////////////////////////////////////////////////////////////////////////////
+// Vectorised tile kernels
+///////////////////////////////////////////////////////////////////////////////
+
+/// <summary>
+/// Allocate the tile planes
+/// </summary>
+template<typename T>
+Demosaic::AHD::VectorTile<T>::VectorTile()
+    : raw(xTileSize + 2 * border, yTileSize + 2 * border)
+{
+    for (int dir = 0; dir < 2; dir++) {
+        r[dir] = Array2D<T>(xTileSize, yTileSize);
+        g[dir] = Array2D<T>(xTileSize, yTileSize);
+        b[dir] = Array2D<T>(xTileSize, yTileSize);
+        labL[dir] = Array2D<T>(xTileSize, yTileSize);
+        labA[dir] = Array2D<T>(xTileSize, yTileSize);
+        labB[dir] = Array2D<T>(xTileSize, yTileSize);
+    }
+    homo = Array2D<T>(xTileSize, 3);
+    homoSum = Array2D<T>(xTileSize, 1);
+}
+
+/// <summary>
+/// Raw row by the tile coordinates
+/// </summary>
+/// <param name="tr">Tile row from -border</param>
+/// <returns>Pointer to the tile column 0</returns>
+template<typename T>
+inline T* Demosaic::AHD::VectorTile<T>::rawRow(int tr)
+{
+    return raw[tr + border] + border;
+}
+
+/// <summary>
+/// Homogeneity difference row in the ring
+/// </summary>
+/// <param name="tr">Tile row</param>
+/// <returns>Pointer to the tile column 0</returns>
+template<typename T>
+inline T* Demosaic::AHD::VectorTile<T>::homoRow(int tr)
+{
+    return homo[tr % 3];
+}
+
+/// <summary>
+/// Red or blue pixel parity on the row
+/// </summary>
+/// <param name="color">Filter color of the first pixel</param>
+/// <returns>Parity of the red or blue tile columns</returns>
+static inline int colorParity(CFAPattern::Color color)
+{
+    return (color == CFAPattern::Color::GREEN_R
+        || color == CFAPattern::Color::GREEN_B) ? 1 : 0;
+}
+
+/// <summary>
+/// Load the scaled CFA values of the tile with its border
+/// </summary>
+/// <param name="img">Source image</param>
+/// <param name="brow">Tile base row</param>
+/// <param name="bcol">Tile base column</param>
+/// <param name="tile">Tile buffers</param>
+template<typename T>
+void Demosaic::AHD::loadTile(
+    const Mosaic& img, int brow, int bcol, VectorTile<T>& tile)
+{
+    constexpr int border = VectorTile<T>::border;
+    const int erow = std::min(brow + yTileSize + border, img.getHeight());
+    const int ecol = std::min(bcol + xTileSize + border, img.getWidth());
+
+    for (int row = brow - border; row < erow; row++) {
+        img.getValues(row, bcol - border, ecol - bcol + border,
+            tile.rawRow(row - brow) - border);
+    }
+    return;
+}
+
+/// <summary>
+/// Horizontal and vertical green tile interpolation
+/// </summary>
+/// <param name="img">Source image</param>
+/// <param name="cfa">CFA pattern</param>
+/// <param name="brow">Tile base row</param>
+/// <param name="bcol">Tile base column</param>
+/// <param name="tile">Tile buffers</param>
+/// <remarks>
+/// The whole row is interpolated and the green pixels are restored
+/// after, so the main loop has no branches.
+/// </remarks>
+template<typename T>
+void Demosaic::AHD::interGreen(
+    const Mosaic& img, const CFAPattern& cfa, int brow, int bcol,
+    VectorTile<T>& tile)
+{
+    const int erow = std::min(brow + yTileSize, img.getHeight() - 2) - brow;
+    const int ecol = std::min(bcol + xTileSize, img.getWidth() - 2) - bcol;
+
+    for (int tr = 0; tr < erow; tr++)
+    {
+        const T* up2 = tile.rawRow(tr - 2);
+        const T* up = tile.rawRow(tr - 1);
+        const T* mid = tile.rawRow(tr);
+        const T* down = tile.rawRow(tr + 1);
+        const T* down2 = tile.rawRow(tr + 2);
+        T* hg = tile.g[0][tr];
+        T* vg = tile.g[1][tr];
+
+        #pragma omp simd
+        for (int tc = 0; tc < ecol; tc++)
+        {
+            const T center = mid[tc];
+
+            // Horizontal interpolation
+            const T hp = mid[tc - 1], hq = mid[tc + 1];
+            const T hval = T(0.25) * (2 * (center + hp + hq)
+                - mid[tc - 2] - mid[tc + 2]);
+            hg[tc] = Utils::median(hval, hp, hq);
+
+            // Vertical interpolation
+            const T vp = up[tc], vq = down[tc];
+            const T vval = T(0.25) * (2 * (center + vp + vq)
+                - up2[tc] - down2[tc]);
+            vg[tc] = Utils::median(vval, vp, vq);
+        }
+
+        // Green pixels are known
+        for (int tc = colorParity(cfa(brow + tr, bcol)) ^ 1; tc < ecol; tc += 2)
+        {
+            hg[tc] = mid[tc];
+            vg[tc] = mid[tc];
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Bilinear interpolate Red and Blue tile channels
+/// </summary>
+/// <param name="img">Source image</param>
+/// <param name="cfa">CFA pattern</param>
+/// <param name="brow">Tile base row</param>
+/// <param name="bcol">Tile base column</param>
+/// <param name="tile">Tile buffers</param>
+/// <param name="dir">Direction of the green interpolation</param>
+/// <param name="cam2XYZ">Prepared matrix for LAB conversion</param>
+/// <remarks>
+/// On the green pixels the row channel comes from the horizontal
+/// neighbours and the other one from the vertical. On red and blue
+/// pixels the other channel comes from the diagonal neighbours.
+/// The green formulas run over the whole row and the red and blue
+/// pixels are overwritten after.
+/// </remarks>
+template<typename T>
+void Demosaic::AHD::interRedBlue(
+    const Mosaic& img, const CFAPattern& cfa, int brow, int bcol,
+    VectorTile<T>& tile, int dir, const Mat3x3& cam2XYZ)
+{
+    constexpr int padding = 1; // Border inside tile
+    const int erow = std::min(brow + yTileSize - padding, img.getHeight() - 3) - brow;
+    const int ecol = std::min(bcol + xTileSize - padding, img.getWidth() - 3) - bcol;
+    const Array2D<T>& green = tile.g[dir];
+
+    for (int tr = padding; tr < erow; tr++)
+    {
+        const CFAPattern::Color first = cfa(brow + tr, bcol);
+        const bool redRow = (first == CFAPattern::Color::RED
+            || first == CFAPattern::Color::GREEN_R);
+
+        const T* rup = tile.rawRow(tr - 1);
+        const T* rmid = tile.rawRow(tr);
+        const T* rdown = tile.rawRow(tr + 1);
+        const T* gup = green[tr - 1];
+        const T* gmid = green[tr];
+        const T* gdown = green[tr + 1];
+        T* rowColor = redRow ? tile.r[dir][tr] : tile.b[dir][tr];
+        T* otherColor = redRow ? tile.b[dir][tr] : tile.r[dir][tr];
+
+        // As on green pixels
+        #pragma omp simd
+        for (int tc = padding; tc < ecol; tc++)
+        {
+            const T g = gmid[tc];
+            rowColor[tc] = g + T(0.5) * (rmid[tc - 1] - gmid[tc - 1]
+                + rmid[tc + 1] - gmid[tc + 1]);
+            otherColor[tc] = g + T(0.5) * (rup[tc] - gup[tc]
+                + rdown[tc] - gdown[tc]);
+        }
+
+        // Red or blue pixels
+        int tc = colorParity(first);
+        for (tc += (tc < padding) ? 2 : 0; tc < ecol; tc += 2)
+        {
+            rowColor[tc] = rmid[tc];
+            otherColor[tc] = gmid[tc] + (rup[tc - 1] - gup[tc - 1]
+                + rdown[tc + 1] - gdown[tc + 1]
+                + rdown[tc - 1] - gdown[tc - 1]
+                + rup[tc + 1] - gup[tc + 1]) * T(0.25);
+        }
+
+        // Conversion to Lab
+        const T* r = tile.r[dir][tr];
+        const T* b = tile.b[dir][tr];
+        T* labL = tile.labL[dir][tr];
+        T* labA = tile.labA[dir][tr];
+        T* labB = tile.labB[dir][tr];
+        for (int tc = padding; tc < ecol; tc++)
+        {
+            const Color::BasicLab<T> lab =
+                camRGB2Lab<T>(cam2XYZ, {r[tc], gmid[tc], b[tc]});
+            labL[tc] = lab.L;
+            labA[tc] = lab.a;
+            labB[tc] = lab.b;
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Rows of the Lab planes
+/// </summary>
+template<typename T>
+struct LabRows {
+    const T* L;
+    const T* a;
+    const T* b;
+};
+
+/// <summary>
+/// Lab differences to the four neighbours of a pixel
+/// </summary>
+template<typename T>
+struct LabDiffs {
+    T l0, l1, l2, l3; // Lightness (left, right, up, down)
+    T c0, c1, c2, c3; // Chroma
+
+    LabDiffs(const LabRows<T>& up, const LabRows<T>& mid,
+        const LabRows<T>& down, int tc) noexcept;
+    T homogeneity(T el, T ec) const noexcept;
+};
+
+/// <summary>
+/// Calculate the differences
+/// </summary>
+/// <param name="up">Rows above</param>
+/// <param name="mid">Rows of the pixel</param>
+/// <param name="down">Rows below</param>
+/// <param name="tc">Tile column</param>
+template<typename T>
+inline LabDiffs<T>::LabDiffs(const LabRows<T>& up, const LabRows<T>& mid,
+    const LabRows<T>& down, int tc) noexcept
+{
+    const T L = mid.L[tc], a = mid.a[tc], b = mid.b[tc];
+    const auto chroma = [a, b](T na, T nb) {
+        const T adiff = a - na, bdiff = b - nb;
+        return adiff * adiff + bdiff * bdiff;
+    };
+
+    l0 = std::abs(L - mid.L[tc - 1]);
+    l1 = std::abs(L - mid.L[tc + 1]);
+    l2 = std::abs(L - up.L[tc]);
+    l3 = std::abs(L - down.L[tc]);
+    c0 = chroma(mid.a[tc - 1], mid.b[tc - 1]);
+    c1 = chroma(mid.a[tc + 1], mid.b[tc + 1]);
+    c2 = chroma(up.a[tc], up.b[tc]);
+    c3 = chroma(down.a[tc], down.b[tc]);
+}
+
+/// <summary>
+/// Number of neighbours within the adaptive estimates
+/// </summary>
+/// <param name="el">Lightness estimate</param>
+/// <param name="ec">Chroma estimate</param>
+/// <returns>Homogeneity count</returns>
+template<typename T>
+inline T LabDiffs<T>::homogeneity(T el, T ec) const noexcept
+{
+    const auto count = [el, ec](T ldiff, T cdiff) {
+        return ((ldiff <= el) & (cdiff <= ec)) ? T(1) : T(0);
+    };
+    return count(l0, c0) + count(l1, c1) + count(l2, c2) + count(l3, c3);
+}
+
+/// <summary>
+/// Homogeneity difference of one row from the Lab images
+/// </summary>
+/// <param name="tr">Tile row</param>
+/// <param name="ecol">End tile column</param>
+/// <param name="tile">Tile buffers</param>
+/// <remarks>
+/// The difference of horizontal and vertical homogeneity is stored to
+/// the ring and the column sums of the ring are updated by it.
+/// </remarks>
+template<typename T>
+void Demosaic::AHD::homogenityRow(int tr, int ecol, VectorTile<T>& tile)
+{
+    constexpr int padding = 2; // Border inside tile
+    const auto rows = [&tile](int dir, int tr) -> LabRows<T> {
+        return {tile.labL[dir][tr], tile.labA[dir][tr], tile.labB[dir][tr]};
+    };
+    const LabRows<T> hup = rows(0, tr - 1), hmid = rows(0, tr), hdown = rows(0, tr + 1);
+    const LabRows<T> vup = rows(1, tr - 1), vmid = rows(1, tr), vdown = rows(1, tr + 1);
+    T* homo = tile.homoRow(tr); // Replaces row tr - 3
+    T* sum = tile.homoSum[0];
+
+    #pragma omp simd
+    for (int tc = padding; tc < ecol; tc++)
+    {
+        const LabDiffs<T> hdiff(hup, hmid, hdown, tc);
+        const LabDiffs<T> vdiff(vup, vmid, vdown, tc);
+
+        // Adaptive estimates el and ec
+        const T el = Utils::min2(Utils::max2(hdiff.l0, hdiff.l1),
+            Utils::max2(vdiff.l2, vdiff.l3));
+        const T ec = Utils::min2(Utils::max2(hdiff.c0, hdiff.c1),
+            Utils::max2(vdiff.c2, vdiff.c3));
+
+        // Evaluate differences of neighborhood pixels
+        const T diff = hdiff.homogeneity(el, ec)
+            - vdiff.homogeneity(el, ec);
+        sum[tc] += diff - homo[tc];
+        homo[tc] = diff;
+    }
+    return;
+}
+
+/// <summary>
+/// Select the values of the more homogeneous direction
+/// </summary>
+/// <param name="diff">Difference of the homogeneities</param>
+/// <param name="hval">Horizontal values</param>
+/// <param name="vval">Vertical values</param>
+/// <param name="out">Resulting values</param>
+/// <param name="count">Number of values</param>
+/// <remarks>
+/// The selected value is averaged with itself, which is exact, so
+/// the loop has no branches.
+/// </remarks>
+template<typename T>
+static void selectDirection(const T* diff,
+    const T* hval, const T* vval, T* out, int count)
+{
+    #pragma omp simd
+    for (int i = 0; i < count; i++)
+    {
+        const T d = diff[i], h = hval[i], v = vval[i];
+        out[i] = T(0.5) * ((d < T(0) ? v : h) + (d > T(0) ? h : v));
+    }
+    return;
+}
+
+/// <summary>
+/// Compose final demosaiced image from horizontal and vertical image
+/// </summary>
+/// <param name="img">Target image</param>
+/// <param name="brow">Tile base row</param>
+/// <param name="bcol">Tile base column</param>
+/// <param name="tile">Tile buffers</param>
+/// <remarks>
+/// Homogeneity is evaluated one row ahead of the output, so the rows
+/// are touched once. The counts are small integers, so the box sums
+/// of the differences are exact.
+/// </remarks>
+template<typename T>
+void Demosaic::AHD::composeOutput(
+    Image& img, int brow, int bcol, VectorTile<T>& tile)
+{
+    constexpr int padding = 3; // Border inside tile
+    const int erow = std::min(brow + yTileSize - padding, img.getHeight() - 5) - brow;
+    const int ecol = std::min(bcol + xTileSize - padding, img.getWidth() - 5) - bcol;
+    const int count = ecol - padding;
+    T diff[xTileSize], red[xTileSize], green[xTileSize], blue[xTileSize];
+
+    for (int tr = 0; tr < 3; tr++) {
+        std::fill_n(tile.homo[tr], xTileSize, T(0));
+    }
+    std::fill_n(tile.homoSum[0], xTileSize, T(0));
+    for (int tr = padding - 1; tr < padding + 1; tr++) {
+        homogenityRow(tr, ecol + 1, tile);
+    }
+    for (int tr = padding; tr < erow && count > 0; tr++)
+    {
+        homogenityRow(tr + 1, ecol + 1, tile);
+
+        // Box 3x3 smoothing of homogeneity
+        const T* sum = tile.homoSum[0];
+        #pragma omp simd
+        for (int tc = padding; tc < ecol; tc++) {
+            diff[tc - padding] = sum[tc - 1] + sum[tc] + sum[tc + 1];
+        }
+
+        // Evaluate homogenity, average if it doesn't help
+        selectDirection(diff, tile.r[0][tr] + padding,
+            tile.r[1][tr] + padding, red, count);
+        selectDirection(diff, tile.g[0][tr] + padding,
+            tile.g[1][tr] + padding, green, count);
+        selectDirection(diff, tile.b[0][tr] + padding,
+            tile.b[1][tr] + padding, blue, count);
+        img.setRow(brow + tr, bcol + padding, count, red, green, blue);
+    }
+    return;
+}
@@ -20,17 +20,22 @@
 
 #pragma once
 
+#include "Color.hpp"
 #include "Demosaic/Algorithm.hpp"
+#include "Structures/Array2D.hpp"
 #include "Structures/Image.hpp"
+#include "Structures/Rect.hpp"
+
+#include <vector>
 
-template<typename T> class Array2D;
-namespace Color { struct RGB64; struct CIELAB; };
 struct CFAPattern;
 struct Mat3x3;
 class Logger;
 
 namespace Demosaic
 {
+    class RowAdvice;
+
     class AHD : public IAlgorithm
     {
         /// <summary>
@@ -43,51 +48,149 @@ namespace Demosaic
         /// </summary>
         static constexpr int xTileSize = 512, yTileSize = 512;
 
+        /// <summary>
+        /// Border of the tile around its output area
+        /// </summary>
+        static constexpr int tilePadding = 3;
+
+    public:
+        /// <summary>
+        /// Implementation of the tile kernels
+        /// </summary>
+        enum class Kernels {
+            Scalar, // Reference, one pixel at a time
+            Vector  // Structure of arrays, vectorised rows
+        };
+
+        /// <summary>
+        /// Tiles of the image and the selection to demosaic
+        /// </summary>
+        /// <remarks>
+        /// The output areas of the tiles are adjacent, not overlapping.
+        /// Unselected tiles are left as they are in the image.
+        /// </remarks>
+        struct TilePlan {
+            int xCount = 0;             // Tiles on a row
+            std::vector<Rect> areas;    // Output areas of the tiles
+            std::vector<bool> selected; // Tiles to demosaic
+
+            Rect bounds() const;
+        };
+
+    private:
+        /// <summary>
+        /// Tile buffers of the vectorised kernels
+        /// </summary>
+        /// <remarks>
+        /// Every channel has its own plane, so the row loops work on unit
+        /// stride data. The index is the direction (horizontal, vertical).
+        /// The raw plane has a border of two pixels around the tile.
+        /// Only the difference of the horizontal and vertical homogeneity
+        /// is needed, so it is kept in a ring of three rows with running
+        /// column sums for the box filter. It is in the scalar of the planes
+        /// too, as loops with one element size vectorise even without AVX.
+        /// </remarks>
+        template<typename T>
+        struct VectorTile {
+            static constexpr int border = 2;
+            Array2D<T> raw;
+            Array2D<T> r[2], g[2], b[2];
+            Array2D<T> labL[2], labA[2], labB[2];
+            Array2D<T> homo;    // Ring of homogeneity differences
+            Array2D<T> homoSum; // Column sums of the ring
+
+            VectorTile();
+            T* rawRow(int tr);
+            T* homoRow(int tr);
+        };
+
+        Kernels m_Kernels;
+        Color::LabTable m_lab; // Lab for the homogeneity test
+
     public: // IAlgorithm interface
+        explicit AHD(Kernels kernels = Kernels::Vector);
         virtual ~AHD();
-        virtual void demosaic(Image &img);
+        virtual void demosaic(const Mosaic &raw, Image &img);
         virtual void printLogo(Logger &os) const;
 
+    public: // Partial demosaicing
+        TilePlan planTiles(const Image &img) const;
+        void demosaic(const Mosaic &raw, Image &img, const TilePlan &plan);
+
     private: // Tiling helpers
-        int calcTileCount(int dim, int ts);
+        static int calcTileCount(int dim, int ts);
+        template<typename T>
+        void demosaicScalar(const Mosaic &raw, Image &img,
+            const Mat3x3 &cam2XYZ, const std::vector<Point> &bases,
+            RowAdvice &advice);
+        template<typename T>
+        void demosaicVector(const Mosaic &raw, Image &img,
+            const Mat3x3 &cam2XYZ, const std::vector<Point> &bases,
+            RowAdvice &advice);
 
     private: // AHD algorithm functions
+        template<typename T>
         void interGreen(
-            const Image &img, const CFAPattern &cfa, int brow, int bcol,
-            Array2D<Color::RGB64> &himg, Array2D<Color::RGB64> &vimg);
+            const Mosaic &img, const CFAPattern &cfa, int brow, int bcol,
+            Array2D<Color::BasicRGB<T>> &himg, Array2D<Color::BasicRGB<T>> &vimg);
         int initRowInfo(
-            const CFAPattern &cfa, int brow, int bcol, Image::Channel &ctype);
+            const CFAPattern &cfa, int brow, int bcol, CFAPattern::Color &ctype);
+        template<typename T>
         void interRedBlue(
-            const Image &img, const CFAPattern &cfa, int brow, int bcol,
-            Array2D<Color::RGB64> &timg, Array2D<Color::CIELab> &imgLab,
-            const Mat3x3 &cam2XYZ);
+            const Mosaic &img, const CFAPattern &cfa, int brow, int bcol,
+            Array2D<Color::BasicRGB<T>> &timg,
+            Array2D<Color::BasicLab<T>> &imgLab, const Mat3x3 &cam2XYZ);
+        template<typename T>
         void generateHomogenityMasks(
-            const Image &img, const int brow, const int bcol,
-            const Array2D<Color::CIELab> &himgLab, Array2D<homo_t> &hhomo,
-            const Array2D<Color::CIELab> &vimgLab, Array2D<homo_t> &vhomo);
+            const Mosaic &img, const int brow, const int bcol,
+            const Array2D<Color::BasicLab<T>> &himgLab, Array2D<homo_t> &hhomo,
+            const Array2D<Color::BasicLab<T>> &vimgLab, Array2D<homo_t> &vhomo);
+        template<typename T>
         void composeOutput(
             Image &img, const int brow, const int bcol,
-            const Array2D<Color::RGB64> &himg, const Array2D<homo_t> &hhomo,
-            const Array2D<Color::RGB64> &vimg, const Array2D<homo_t> &vhomo);
+            const Array2D<Color::BasicRGB<T>> &himg, const Array2D<homo_t> &hhomo,
+            const Array2D<Color::BasicRGB<T>> &vimg, const Array2D<homo_t> &vhomo);
 
     private: // Interpolation helpers
-        Color::RGB64 interOnGreenR(
-            const Image &img, const int row, const int col,
-            const Array2D<Color::RGB64> &tileimg, const int tr, const int tc);
-        Color::RGB64 interOnGreenB(
-            const Image &img, const int row, const int col,
-            const Array2D<Color::RGB64> &tileimg, const int tr, const int tc);
-        Color::RGB64 interOnRed(
-            const Image &img, const int row, const int col,
-            const Array2D<Color::RGB64> &tileimg, const int tr, const int tc);
-        Color::RGB64 interOnBlue(
-            const Image& img, const int row, const int col,
-            const Array2D<Color::RGB64>& tileimg, const int tr, const int tc);
+        template<typename T>
+        Color::BasicRGB<T> interOnGreenR(
+            const Mosaic &img, const int row, const int col,
+            const Array2D<Color::BasicRGB<T>> &tileimg, const int tr, const int tc);
+        template<typename T>
+        Color::BasicRGB<T> interOnGreenB(
+            const Mosaic &img, const int row, const int col,
+            const Array2D<Color::BasicRGB<T>> &tileimg, const int tr, const int tc);
+        template<typename T>
+        Color::BasicRGB<T> interOnRed(
+            const Mosaic &img, const int row, const int col,
+            const Array2D<Color::BasicRGB<T>> &tileimg, const int tr, const int tc);
+        template<typename T>
+        Color::BasicRGB<T> interOnBlue(
+            const Mosaic& img, const int row, const int col,
+            const Array2D<Color::BasicRGB<T>>& tileimg, const int tr, const int tc);
 
     private: // Homogeneity build helpers
         void averageHomogenity(
             const Array2D<homo_t> &hhomo, const Array2D<homo_t> &vhomo,
             int row, int col, homo_t &hhm, homo_t&vhm);
-        Color::CIELab camRGB2Lab(const Mat3x3 &cam2XYZ, const Color::RGB64 &src);
+        template<typename T>
+        Color::BasicLab<T> camRGB2Lab(
+            const Mat3x3 &cam2XYZ, const Color::BasicRGB<T> &src);
+
+    private: // Vectorised tile kernels
+        template<typename T>
+        void loadTile(const Mosaic &img, int brow, int bcol, VectorTile<T> &tile);
+        template<typename T>
+        void interGreen(
+            const Mosaic &img, const CFAPattern &cfa, int brow, int bcol,
+            VectorTile<T> &tile);
+        template<typename T>
+        void interRedBlue(
+            const Mosaic &img, const CFAPattern &cfa, int brow, int bcol,
+            VectorTile<T> &tile, int dir, const Mat3x3 &cam2XYZ);
+        template<typename T>
+        void homogenityRow(int tr, int ecol, VectorTile<T> &tile);
+        template<typename T>
+        void composeOutput(Image &img, int brow, int bcol, VectorTile<T> &tile);
     };
 };
@@ -23,16 +23,21 @@
 #include <ostream>
 class Image;
 class Logger;
+class Mosaic;
 
 namespace Demosaic
 {
     /// <summary>
     /// Demosaicing algorithm interface
     /// </summary>
+    /// <remarks>
+    /// The algorithm reads the CFA data from the source mosaic
+    /// and writes the result to the channels of the image.
+    /// </remarks>
     class IAlgorithm
     {
     public:
-        virtual void demosaic(Image &img) = 0;
+        virtual void demosaic(const Mosaic &raw, Image &img) = 0;
         virtual void printLogo(Logger &os) const = 0;
     };
 };
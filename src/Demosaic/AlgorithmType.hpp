@@ -27,6 +27,6 @@ namespace Demosaic
     /// </summary>
     enum class AlgorithmType
     {
-        Bilinear, Freeman, HQLinear, AHD
+        Bilinear, Freeman, HQLinear, AHD, RCD, Hybrid
     };
 };
@@ -20,10 +20,15 @@
 
 #include "Bilinear.hpp"
 
+#include "Border.hpp"
+#include "RowAdvice.hpp"
+#include "Structures/Array2D.hpp"
 #include "Structures/Image.hpp"
 #include "CamProfiles/CamProfile.hpp"
-#include "CamProfiles/CFAPattern.hpp"
 #include "Logger.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
 
 /// <summary>
 /// Virtual empty destructor
@@ -34,40 +39,72 @@ Demosaic::Bilinear::~Bilinear()
 /// <summary>
 /// Bilinear demosaicing algorithm
 /// </summary>
-/// <param name="img"></param>
-void Demosaic::Bilinear::demosaic(Image &img)
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <remarks>
+/// The image is processed in bands of rows. Mosaic rows are loaded
+/// once into a ring of three rows, and the kernels are specialised
+/// for the filter and row parity. The rows are advised band by band.
+/// </remarks>
+void Demosaic::Bilinear::demosaic(const Mosaic &raw, Image &img)
 {
     constexpr int padding = 1;
     const Rect active = img.getCamProfile()->getActiveArea();
-    const int erow = active.bottom - padding, ecol = active.right - padding;
+    const int brow = active.top + padding, erow = active.bottom - padding,
+        bcol = active.left + padding, ecol = active.right - padding;
+    const int width = raw.getWidth(), count = ecol - bcol;
+    const int bandCount = (erow - brow + bandHeight - 1) / bandHeight;
     const CFAPattern cfa = img.getCamProfile()->getCFAPattern();
+    RowAdvice advice(raw, bandCount);
 
-    #pragma omp parallel for
-    for (int row = active.top + padding; row < erow; row++)
-    {
-        for (int col = active.left + padding; col < ecol; col++)
-        {
-            switch (cfa(row, col))
+    dispatchPrecision(raw.getPrecision(), [&]<typename T>() {
+        cfa.dispatch([&]<CFAPattern::Filter F>() {
+            #pragma omp parallel
             {
-            case CFAPattern::Color::RED:
-                interGB(img, row, col); // R->GB
-                break;
-            case CFAPattern::Color::BLUE:
-                interRG(img, row, col); // B->RG
-                break;
-            default: // GREEN_R || GREEN_B
-                interRB(img, cfa, row, col); // G->RB
-                break;
+                Array2D<T> ring(width, 3), out(width, 3);
+                const auto load = [&](int row) {
+                    raw.getValues(row, 0, width, ring[row % 3]);
+                };
+
+                #pragma omp for schedule(dynamic)
+                for (int band = 0; band < bandCount; band++)
+                {
+                    const int bbeg = brow + band * bandHeight;
+                    const int bend = std::min(bbeg + bandHeight, erow);
+                    advice.begin(bbeg - padding, bend + padding);
+
+                    for (int row = bbeg - padding;
+                        row < bbeg + padding; row++) {
+                        load(row);
+                    }
+                    for (int row = bbeg; row < bend; row++)
+                    {
+                        load(row + padding);
+                        const Window<T> w{ring[(row - 1) % 3],
+                            ring[row % 3], ring[(row + 1) % 3]};
+
+                        if (Utils::odd(row))
+                            interRow<T, CFAPattern::RowColors<F, 1>>(
+                                w, bcol, ecol, out[0], out[1], out[2]);
+                        else
+                            interRow<T, CFAPattern::RowColors<F, 0>>(
+                                w, bcol, ecol, out[0], out[1], out[2]);
+                        img.setRow(row, bcol, count,
+                            out[0] + bcol, out[1] + bcol, out[2] + bcol);
+                    }
+                    advice.finish(band, bbeg, bend);
+                }
             }
-        } // col loop
-    } // row loop
+        });
+    });
+    fillBorder(raw, img, Rect(Point(bcol, brow), Point(ecol, erow)));
     return;
 }
 
 /// <summary>
 /// Print demosaic logo message
 /// </summary>
-/// <param name="os">Output stream for print</param>
+/// <param name="os">Output stream to print</param>
 void Demosaic::Bilinear::printLogo(Logger &os) const
 {
     os << "Bilinear demosaicing algorithm";
@@ -75,94 +112,85 @@ void Demosaic::Bilinear::printLogo(Logger &os) const
 }
 
 /// <summary>
-/// Interpolate Red and Green on Blue pixel
+/// Interpolate one row
 /// </summary>
-/// <param name="img">Image for interpolation</param>
-/// <param name="row">Image row</param>
-/// <param name="col">Image column</param>
-void Demosaic::Bilinear::interRG(Image &img, int row, int col)
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <typeparam name="Row">Colors of the row</typeparam>
+/// <param name="w">Mosaic rows</param>
+/// <param name="bcol">First column</param>
+/// <param name="ecol">End column</param>
+/// <param name="r">Red row</param>
+/// <param name="g">Green row</param>
+/// <param name="b">Blue row</param>
+template<typename T, typename Row>
+void Demosaic::Bilinear::interRow(const Window<T> &w,
+    int bcol, int ecol, T *r, T *g, T *b)
 {
-    Color::RGB64 value = img.getValue(row, col);
-
-    // Diagonal surrounding (R)
-    const Color::RGB64 r1 = img.getValue(row + 1, col + 1);
-    const Color::RGB64 r2 = img.getValue(row - 1, col - 1);
-    const Color::RGB64 r3 = img.getValue(row + 1, col - 1);
-    const Color::RGB64 r4 = img.getValue(row - 1, col + 1);
-
-    // Axis surrounding (G)
-    const Color::RGB64 g1 = img.getValue(row, col + 1);
-    const Color::RGB64 g2 = img.getValue(row, col - 1);
-    const Color::RGB64 g3 = img.getValue(row + 1, col);
-    const Color::RGB64 g4 = img.getValue(row - 1, col);
-
-    // Interpolate
-    value.r = (r1.r + r2.r + r3.r + r4.r) / 4;
-    value.g = (g1.g + g2.g + g3.g + g4.g) / 4;
-    img.setValue(row, col, value);
+    using CFA = CFAPattern;
+    interChroma<T, Row::chroma>(w,
+        CFA::firstColumn(bcol, Row::chromaParity), ecol, r, g, b);
+    interGreen<T, Row::chroma == CFA::Color::RED ? CFA::Color::GREEN_R
+        : CFA::Color::GREEN_B>(w,
+        CFA::firstColumn(bcol, Row::chromaParity ^ 1), ecol, r, g, b);
     return;
 }
 
 /// <summary>
-/// Interpolate Green and Blue on Red pixel
+/// Interpolate the red or blue pixels of a row
 /// </summary>
-/// <param name="img">Image for interpolation</param>
-/// <param name="row">Image row</param>
-/// <param name="col">Image column</param>
-void Demosaic::Bilinear::interGB(Image &img, int row, int col)
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <typeparam name="C">Color of the pixels</typeparam>
+/// <param name="w">Mosaic rows</param>
+/// <param name="first">First column</param>
+/// <param name="end">End column</param>
+/// <param name="r">Red row</param>
+/// <param name="g">Green row</param>
+/// <param name="b">Blue row</param>
+template<typename T, CFAPattern::Color C>
+void Demosaic::Bilinear::interChroma(const Window<T> &w,
+    int first, int end, T *r, T *g, T *b)
 {
-    Color::RGB64 value = img.getValue(row, col);
-
-    // Diagonal surrounding (B)
-    const Color::RGB64 b1 = img.getValue(row + 1, col + 1);
-    const Color::RGB64 b2 = img.getValue(row - 1, col - 1);
-    const Color::RGB64 b3 = img.getValue(row + 1, col - 1);
-    const Color::RGB64 b4 = img.getValue(row - 1, col + 1);
-
-    // Axis surrounding (G)
-    const Color::RGB64 g1 = img.getValue(row, col + 1);
-    const Color::RGB64 g2 = img.getValue(row, col - 1);
-    const Color::RGB64 g3 = img.getValue(row + 1, col);
-    const Color::RGB64 g4 = img.getValue(row - 1, col);
-
-    // Interpolate
-    value.g = (g1.g + g2.g + g3.g + g4.g) / 4;
-    value.b = (b1.b + b2.b + b3.b + b4.b) / 4;
-    img.setValue(row, col, value);
+    T* own = (C == CFAPattern::Color::RED) ? r : b;
+    T* other = (C == CFAPattern::Color::RED) ? b : r;
+
+    #pragma omp simd
+    for (int c = first; c < end; c += 2)
+    {
+        own[c] = w.mid[c];
+
+        // Axis surrounding (G) and diagonal surrounding
+        g[c] = (w.mid[c + 1] + w.mid[c - 1] + w.down[c] + w.up[c]) / 4;
+        other[c] = (w.down[c + 1] + w.up[c - 1]
+            + w.down[c - 1] + w.up[c + 1]) / 4;
+    }
     return;
 }
 
 /// <summary>
-/// Interpolate Red and Blue on Green pixel
+/// Interpolate the green pixels of a row
 /// </summary>
-/// <param name="img">Image for interpolation</param>
-/// <param name="row">Image row</param>
-/// <param name="col">Image column</param>
-void Demosaic::Bilinear::interRB(
-    Image &img, const CFAPattern &cfa, int row, int col)
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <typeparam name="C">Green of the row</typeparam>
+/// <param name="w">Mosaic rows</param>
+/// <param name="first">First column</param>
+/// <param name="end">End column</param>
+/// <param name="r">Red row</param>
+/// <param name="g">Green row</param>
+/// <param name="b">Blue row</param>
+template<typename T, CFAPattern::Color C>
+void Demosaic::Bilinear::interGreen(const Window<T> &w,
+    int first, int end, T *r, T *g, T *b)
 {
-    Color::RGB64 value = img.getValue(row, col);
-
-    // Axis surrounding
-    const Color::RGB64 h1 = img.getValue(row, col + 1);
-    const Color::RGB64 h2 = img.getValue(row, col - 1);
-    const Color::RGB64 v1 = img.getValue(row + 1, col);
-    const Color::RGB64 v2 = img.getValue(row - 1, col);
+    // Red is on the row of GREEN_R, blue in the column
+    T* horz = (C == CFAPattern::Color::GREEN_R) ? r : b;
+    T* vert = (C == CFAPattern::Color::GREEN_R) ? b : r;
 
-    // Interpolate
-    if (cfa(row, col + 1) == CFAPattern::Color::BLUE)
-    {
-        // Blue is in horizontal values and red in vertical
-        value.r = (v1.r + v2.r) / 2;
-        value.b = (h1.b + h2.b) / 2;
-    }
-    else
+    #pragma omp simd
+    for (int c = first; c < end; c += 2)
     {
-        // Red is in horizontal values and blue in vertical
-        assert(cfa(row + 1, col) == CFAPattern::Color::BLUE);
-        value.r = (h1.r + h2.r) / 2; // Vert. B
-        value.b = (v1.b + v2.b) / 2;
+        horz[c] = (w.mid[c + 1] + w.mid[c - 1]) / 2;
+        g[c] = w.mid[c];
+        vert[c] = (w.down[c] + w.up[c]) / 2;
     }
-    img.setValue(row, col, value);
     return;
 }
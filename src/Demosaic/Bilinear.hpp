@@ -20,23 +20,43 @@
 
 #pragma once
 
+#include "CamProfiles/CFAPattern.hpp"
 #include "Demosaic/Algorithm.hpp"
-struct CFAPattern;
 class Logger;
 
 namespace Demosaic
 {
     class Bilinear : public IAlgorithm
     {
+        /// <summary>
+        /// Rows in a band processed by one thread
+        /// </summary>
+        static constexpr int bandHeight = 32;
+
+        /// <summary>
+        /// Three mosaic rows around the interpolated one
+        /// </summary>
+        template<typename T>
+        struct Window {
+            const T* up;
+            const T* mid;
+            const T* down;
+        };
+
     public: // IAlgorithm interface
         virtual ~Bilinear();
-        virtual void demosaic(Image &img);
+        virtual void demosaic(const Mosaic &raw, Image &img);
         virtual void printLogo(Logger &os) const;
 
-    private: // Helpers
-        static void interRG(Image &, int row, int col);
-        static void interGB(Image &, int row, int col);
-        static void interRB(Image &img,
-            const CFAPattern &cfa, int row, int col);
+    private: // Filters of the row phases
+        template<typename T, typename Row>
+        static void interRow(const Window<T> &w,
+            int bcol, int ecol, T *r, T *g, T *b);
+        template<typename T, CFAPattern::Color C>
+        static void interChroma(const Window<T> &w,
+            int first, int end, T *r, T *g, T *b);
+        template<typename T, CFAPattern::Color C>
+        static void interGreen(const Window<T> &w,
+            int first, int end, T *r, T *g, T *b);
     };
 };
@@ -0,0 +1,125 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Border.hpp"
+
+#include "Structures/Image.hpp"
+#include "Structures/Rect.hpp"
+
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+namespace
+{
+/// <summary>
+/// Set a run of row pixels to their mosaic values
+/// </summary>
+/// <remarks>
+/// The channel of the filter color gets the value, the others zero.
+/// </remarks>
+template<typename T>
+void fillRun(const Mosaic &raw, Image &img, int row, int bcol, int ecol,
+    vector<T> (&rgb)[3], vector<T> &values)
+{
+    const int count = ecol - bcol;
+    if (count <= 0)
+        return;
+
+    const CFAPattern cfa = raw.getCFAPattern();
+    const int channels[2] = {
+        CFAPattern::channel(cfa(row & 1, 0)),
+        CFAPattern::channel(cfa(row & 1, 1))};
+
+    raw.getValues(row, bcol, count, values.data());
+    for (int i = 0; i < count; i++) {
+        const int channel = channels[(bcol + i) & 1];
+        rgb[0][i] = (channel == 0) ? values[i] : T(0);
+        rgb[1][i] = (channel == 1) ? values[i] : T(0);
+        rgb[2][i] = (channel == 2) ? values[i] : T(0);
+    }
+    img.setRow(row, bcol, count, rgb[0].data(), rgb[1].data(), rgb[2].data());
+    return;
+}
+}
+
+/// <summary>
+/// Fill the pixels around the demosaiced area by the mosaic values
+/// </summary>
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <param name="inner">Area written by the algorithm</param>
+/// <remarks>
+/// The image channels are allocated uninitialised, so every algorithm
+/// calls it for the pixels, which it does not interpolate.
+/// </remarks>
+void Demosaic::fillBorder(const Mosaic &raw, Image &img, const Rect &inner)
+{
+    fillBorder(raw, img,
+        Rect::Create(Point(0, 0), img.getWidth(), img.getHeight()), inner);
+    return;
+}
+
+/// <summary>
+/// Fill the pixels of an area around the demosaiced part
+/// </summary>
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <param name="outer">Area to fill</param>
+/// <param name="inner">Part of the area written by the algorithm</param>
+void Demosaic::fillBorder(const Mosaic &raw, Image &img,
+    const Rect &outer, const Rect &inner)
+{
+    const int top = std::max(outer.top, 0);
+    const int bottom = std::min(outer.bottom, img.getHeight());
+    const int left = std::max(outer.left, 0);
+    const int right = std::min(outer.right, img.getWidth());
+    if (right <= left || bottom <= top)
+        return;
+
+    // Written part clipped to the area, possibly empty
+    const int itop = std::clamp(inner.top, top, bottom);
+    const int ibottom = std::clamp(inner.bottom, itop, bottom);
+    const int ileft = std::clamp(inner.left, left, right);
+    const int iright = std::clamp(inner.right, ileft, right);
+    const bool empty = (ileft == iright);
+
+    dispatchPrecision(raw.getPrecision(), [&]<typename T>() {
+        #pragma omp parallel
+        {
+            const int width = right - left;
+            vector<T> rgb[3] = {vector<T>(width),
+                vector<T>(width), vector<T>(width)};
+            vector<T> values(width);
+
+            #pragma omp for schedule(static)
+            for (int row = top; row < bottom; row++) {
+                if (row < itop || row >= ibottom || empty) {
+                    fillRun(raw, img, row, left, right, rgb, values);
+                }
+                else {
+                    fillRun(raw, img, row, left, ileft, rgb, values);
+                    fillRun(raw, img, row, iright, right, rgb, values);
+                }
+            }
+        }
+    });
+    return;
+}
@@ -28,6 +28,7 @@
 #include "Logger.hpp"
 
 #include <iostream>
+#include <utility>
 using namespace std;
 
 /// <summary>
@@ -39,28 +40,47 @@ Demosaic::Freeman::~Freeman()
 /// <summary>
 /// Run freeman median demosaic algorithm
 /// </summary>
-/// <param name="img">Image to be demosaiced</param>
-void Demosaic::Freeman::demosaic(Image &img)
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+void Demosaic::Freeman::demosaic(const Mosaic &raw, Image &img)
 {
     Bilinear bilinear; // Bilinear base
-    bilinear.demosaic(img);
+    bilinear.demosaic(raw, img);
 
-    // Dimensions
     m_ActiveArea = img.getCamProfile()->getActiveArea();
+    dispatchPrecision(img.getPrecision(), [&]<typename T>() {
+        demosaicDiff<T>(img);
+    });
+    return;
+}
+
+/// <summary>
+/// Median filter of the channel differences
+/// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="img">Bilinear demosaiced image</param>
+template<typename T>
+void Demosaic::Freeman::demosaicDiff(Image &img)
+{
+    // Dimensions
     const int width = m_ActiveArea.right - m_ActiveArea.left;
     const int height = m_ActiveArea.bottom - m_ActiveArea.top;
 
     // Channel differences arrays
-    Array2D<double> diffRG(width, height), diffBG(width, height);
-    calcChannelDiff(img, diffRG, diffBG);
+    Array2D<T> diffRG(width, height, k_planePolicy),
+               diffBG(width, height, k_planePolicy);
+    calcChannelDiff(img, diffRG.view(), diffBG.view());
 
-    // Median filter on the data
+    // Median filter on the data, borders stay in both buffers
+    Array2D<T> nextRG(diffRG), nextBG(diffBG);
     for (int i = 0; i < m_MedianIter; ++i)
     {
-        median(diffRG);
-        median(diffBG);
+        median<T>(diffRG.view(), nextRG.view());
+        median<T>(diffBG.view(), nextBG.view());
+        std::swap(diffRG, nextRG);
+        std::swap(diffBG, nextBG);
     }
-    calcImageFromDiff(img, diffRG, diffBG);
+    calcImageFromDiff<T>(img, diffRG.view(), diffBG.view());
     return;
 }
 
@@ -79,23 +99,32 @@ void Demosaic::Freeman::printLogo(Logger &os) const
 /// <summary>
 /// Calculate channel differences R-G, B-G
 /// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
 /// <param name="img">Source image</param>
 /// <param name="diffRG">Output R-G difference</param>
 /// <param name="diffBG">Output B-G difference</param>
+template<typename T>
 void Demosaic::Freeman::calcChannelDiff(
-    const Image &img, Array2D<double> &diffRG, Array2D<double> &diffBG)
+    const Image &img, Array2DView<T> diffRG, Array2DView<T> diffBG)
 {
-    #pragma omp parallel for
-    for (int row = m_ActiveArea.top; row < m_ActiveArea.bottom; row++)
+    const int width = diffRG.getWidth();
+
+    #pragma omp parallel
     {
-        const int tr = row - m_ActiveArea.top;
-        int col = m_ActiveArea.left, tc = 0;
+        Array2D<T> rgb(width, 3);
 
-        for (; col < m_ActiveArea.right; col++, tc++)
+        #pragma omp for
+        for (int row = m_ActiveArea.top; row < m_ActiveArea.bottom; row++)
         {
-            const Color::RGB64 value = img.getValue(row, col);
-            diffRG[tr][tc] = value.r - value.g;
-            diffBG[tr][tc] = value.b - value.g;
+            const int tr = row - m_ActiveArea.top;
+            img.getRow(row, m_ActiveArea.left, width, rgb[0], rgb[1], rgb[2]);
+
+            #pragma omp simd
+            for (int tc = 0; tc < width; tc++)
+            {
+                diffRG[tr][tc] = rgb[0][tc] - rgb[1][tc];
+                diffBG[tr][tc] = rgb[2][tc] - rgb[1][tc];
+            }
         }
     }
     return;
@@ -104,28 +133,34 @@ void Demosaic::Freeman::calcChannelDiff(
 /// <summary>
 /// Image recostruction from channel differences R-G, B-G
 /// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
 /// <param name="img">Target image for reconstruction</param>
 /// <param name="diffRG">Input R-G difference</param>
 /// <param name="diffBG">Input B-G difference</param>
-void Demosaic::Freeman::calcImageFromDiff(
-    Image &img, const Array2D<double> &diffRG, const Array2D<double> &diffBG)
+template<typename T>
+void Demosaic::Freeman::calcImageFromDiff(Image &img,
+    Array2DView<const T> diffRG, Array2DView<const T> diffBG)
 {
-    #pragma omp parallel for
-    for (int row = m_ActiveArea.top; row < m_ActiveArea.bottom; row++)
+    const int width = diffRG.getWidth();
+
+    #pragma omp parallel
     {
-        const int tr = row - m_ActiveArea.top;
-        int col = m_ActiveArea.left, tc = 0;
+        Array2D<T> rgb(width, 3);
 
-        for (; col < m_ActiveArea.right; col++, tc++)
+        #pragma omp for
+        for (int row = m_ActiveArea.top; row < m_ActiveArea.bottom; row++)
         {
-            Color::RGB64 result, value;
-            value = img.getValue(row, col);
+            const int tr = row - m_ActiveArea.top;
+            img.getRow(row, m_ActiveArea.left, width, rgb[0], rgb[1], rgb[2]);
 
             // Like DCRAW, and not complete right, but works...
-            result.r = diffRG[tr][tc] + value.g;
-            result.g = value.g;
-            result.b = diffBG[tr][tc] + value.g;
-            img.setValue(row, col, result);
+            #pragma omp simd
+            for (int tc = 0; tc < width; tc++)
+            {
+                rgb[0][tc] = diffRG[tr][tc] + rgb[1][tc];
+                rgb[2][tc] = diffBG[tr][tc] + rgb[1][tc];
+            }
+            img.setRow(row, m_ActiveArea.left, width, rgb[0], rgb[1], rgb[2]);
         }
     }
     return;
@@ -134,29 +169,29 @@ void Demosaic::Freeman::calcImageFromDiff(
 /// <summary>
 /// Compute median filter on the channel
 /// </summary>
-/// <param name="channel">Channel for medianing</param>
-void Demosaic::Freeman::median(Array2D<double> &channel)
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="src">Channel for medianing</param>
+/// <param name="dst">Filtered channel of the same size, border not written</param>
+template<typename T>
+void Demosaic::Freeman::median(Array2DView<const T> src, Array2DView<T> dst)
 {
-    const Array2D<double> data(channel);
-    const int width = data.getWidth() - 1, height = data.getHeight() - 1;
+    const int width = src.getWidth() - 1, height = src.getHeight() - 1;
 
     #pragma omp parallel for
     for (int row = 1; row < height; row++)
     {
+        const T* up = src[row - 1];
+        const T* mid = src[row];
+        const T* down = src[row + 1];
+        T* out = dst[row];
+
+        #pragma omp simd
         for (int col = 1; col < width; col++)
         {
-            double v[9];
-            v[0] = data[row][col];
-            v[1] = data[row][col - 1];
-            v[2] = data[row][col + 1];
-            v[3] = data[row - 1][col];
-            v[4] = data[row - 1][col - 1];
-            v[5] = data[row - 1][col + 1];
-            v[6] = data[row + 1][col];
-            v[7] = data[row + 1][col - 1];
-            v[8] = data[row + 1][col + 1];
-            qsort(v, 9, sizeof(double), Utils::compareDouble);
-            channel[row][col] = v[4];
+            out[col] = Utils::median9(
+                up[col - 1], up[col], up[col + 1],
+                mid[col - 1], mid[col], mid[col + 1],
+                down[col - 1], down[col], down[col + 1]);
         }
     }
     return;
@@ -21,9 +21,9 @@
 #pragma once
 
 #include "Demosaic/Algorithm.hpp"
+#include "Structures/Array2DView.hpp"
 #include "Structures/Rect.hpp"
 
-template<typename T> class Array2D;
 class Logger;
 
 namespace Demosaic
@@ -36,15 +36,20 @@ namespace Demosaic
     public: // IAlgorithm interface
         Freeman(int medianIter);
         virtual ~Freeman();
-        virtual void demosaic(Image &img);
+        virtual void demosaic(const Mosaic &raw, Image &img);
         virtual void printLogo(Logger &os) const;
 
     private: // Helpers
+        template<typename T>
+        void demosaicDiff(Image &img);
+        template<typename T>
         void calcChannelDiff(const Image &img,
-            Array2D<double> &diffRG, Array2D<double> &diffBG);
+            Array2DView<T> diffRG, Array2DView<T> diffBG);
+        template<typename T>
         void calcImageFromDiff(Image &img,
-            const Array2D<double> &diffRG, const Array2D<double> &diffBG);
-        static void median(Array2D<double> &channel);
+            Array2DView<const T> diffRG, Array2DView<const T> diffBG);
+        template<typename T>
+        static void median(Array2DView<const T> src, Array2DView<T> dst);
     };
 };
 
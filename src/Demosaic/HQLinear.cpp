@@ -28,12 +28,17 @@ Best linear demosaicing algorithm. There is at
 the limit what could be done with linear filter.
 */
 
+#include "Border.hpp"
+#include "RowAdvice.hpp"
+#include "Structures/Array2D.hpp"
 #include "Structures/Image.hpp"
 #include "Structures/Rect.hpp"
 #include "CamProfiles/CamProfile.hpp"
 #include "CamProfiles/CFAPattern.hpp"
 #include "Logger.hpp"
+#include "Utils.hpp"
 
+#include <algorithm>
 #include <iostream>
 using namespace std;
 
@@ -46,257 +51,257 @@ Demosaic::HQLinear::~HQLinear()
 /// <summary>
 /// High-quality linear demosaicing algorithm
 /// </summary>
-/// <param name="img">Image to be demosaiced</param>
-void Demosaic::HQLinear::demosaic(Image &img)
+/// <param name="srcImg">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+void Demosaic::HQLinear::demosaic(const Mosaic &srcImg, Image &img)
 {
-    const Image srcImg(img); // Save source image
-    constexpr int padding = 2;
-    const Rect active = img.getCamProfile()->getActiveArea();
-    const int brow = active.top + padding, erow = active.bottom - padding,
-        bcol = active.left + padding, ecol = active.right - padding;
-    const CFAPattern cfa = img.getCamProfile()->getCFAPattern();
-    Color::RGB64 value; // Current pixel value
-
-    #pragma omp parallel for private(value)
-    for (int row = brow; row < erow; row++)
-    {
-        for (int col = bcol; col < ecol; col++)
-        {
-            switch (cfa(row, col))
-            {
-            case CFAPattern::Color::RED:
-                value.r = srcImg.getValueR(row, col);
-                value.g = interGreenFromRed(srcImg, row, col);
-                value.b = interBlueFromRed(srcImg, row, col);
-                break;
-            case CFAPattern::Color::BLUE:
-                value.r = interRedFromBlue(srcImg, row, col);
-                value.g = interGreenFromBlue(srcImg, row, col);
-                value.b = srcImg.getValueB(row, col);
-                break;
-            case CFAPattern::Color::GREEN_R:
-                value.r = interRedFromGreenR(srcImg, row, col);
-                value.g = srcImg.getValueG(row, col);
-                value.b = interBlueFromGreenR(srcImg, row, col);
-                break;
-            default: // CFAPattern::Color::GREEN_B
-                value.r = interRedFromGreenB(srcImg, row, col);
-                value.g = srcImg.getValueG(row, col);
-                value.b = interBlueFromGreenB(srcImg, row, col);
-                break;
-            }
-            img.setValue(row, col, value); // Save the result
-        } // col loop
-    } // row loop
+    demosaic(srcImg, img,
+        Rect::Create(Point(0, 0), img.getWidth(), img.getHeight()));
     return;
 }
 
 /// <summary>
-/// Print demosaic logo message
+/// High-quality linear interpolation of an area
 /// </summary>
-/// <param name="os">Output stream for print</param>
-void Demosaic::HQLinear::printLogo(Logger &os) const
+/// <param name="srcImg">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <param name="area">Area to interpolate</param>
+/// <remarks>
+/// The area is interpolated inside the active area without its border,
+/// the rest of the area gets the mosaic values. It is processed in bands
+/// of rows by the threads, advised band by band.
+/// </remarks>
+void Demosaic::HQLinear::demosaic(
+    const Mosaic &srcImg, Image &img, const Rect &area)
 {
-    os << "High-Quality linear demosaicing algorithm";
+    const Rect inner = interArea(img, area);
+    fillBorder(srcImg, img, area, inner);
+    if (inner.getWidth() <= 0 || inner.getHeight() <= 0)
+        return;
+
+    const int width = srcImg.getWidth();
+    const int bandCount = (inner.getHeight() + bandHeight - 1) / bandHeight;
+    const CFAPattern cfa = img.getCamProfile()->getCFAPattern();
+    RowAdvice advice(srcImg, bandCount);
+
+    dispatchPrecision(srcImg.getPrecision(), [&]<typename T>() {
+        cfa.dispatch([&]<CFAPattern::Filter F>() {
+            #pragma omp parallel
+            {
+                Array2D<T> ring(width, 5), out(width, 3);
+
+                #pragma omp for schedule(dynamic)
+                for (int band = 0; band < bandCount; band++)
+                {
+                    const int bbeg = inner.top + band * bandHeight;
+                    const int bend = std::min(bbeg + bandHeight, inner.bottom);
+                    advice.begin(bbeg - 2, bend + 2);
+                    interRows<T, F>(srcImg, img, Rect(
+                        Point(inner.left, bbeg), Point(inner.right, bend)),
+                        ring, out);
+                    advice.finish(band, bbeg, bend);
+                }
+            }
+        });
+    });
     return;
 }
 
 /// <summary>
-/// Interpolate Green from Red(Pattern No. 1)
+/// High-quality linear interpolation of an area by the calling thread
 /// </summary>
-/// <param name="img">Source image</param>
-/// <param name="row">Image row</param>
-/// <param name="col">Image column</param>
-/// <returns>Interpolated value</returns>
-double Demosaic::HQLinear::interGreenFromRed(const Image &img, int row, int col)
+/// <param name="srcImg">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <param name="area">Area to interpolate</param>
+/// <remarks>
+/// For tiles distributed over the threads by the caller.
+/// </remarks>
+void Demosaic::HQLinear::demosaicTile(
+    const Mosaic &srcImg, Image &img, const Rect &area)
 {
-    double gsum, rsum;
-
-    // Green for linear interpolation
-    gsum = img.getValueG(row - 1, col);
-    gsum += img.getValueG(row, col + 1);
-    gsum += img.getValueG(row + 1, col);
-    gsum += img.getValueG(row, col - 1);
-
-    // Red for gradient correction
-    rsum = 4 * img.getValueR(row, col);
-    rsum -= img.getValueR(row - 2, col);
-    rsum -= img.getValueR(row, col + 2);
-    rsum -= img.getValueR(row + 2, col);
-    rsum -= img.getValueR(row, col - 2);
-
-    // Resulting interpolated green
-    return (2 * gsum + rsum) / 8;
+    const Rect inner = interArea(img, area);
+    fillBorder(srcImg, img, area, inner);
+    if (inner.getWidth() <= 0 || inner.getHeight() <= 0)
+        return;
+
+    const int width = srcImg.getWidth();
+    dispatchPrecision(srcImg.getPrecision(), [&]<typename T>() {
+        Array2D<T> ring(width, 5), out(width, 3);
+        img.getCamProfile()->getCFAPattern().dispatch(
+            [&]<CFAPattern::Filter F>() {
+                interRows<T, F>(srcImg, img, inner, ring, out);
+            });
+    });
+    return;
 }
 
 /// <summary>
-/// Interpolate Green from Blue (Pattern No. 2)
+/// Part of the area, which can be interpolated
 /// </summary>
-/// <param name="img">Source image</param>
-/// <param name="row">Image row</param>
-/// <param name="col">Image column</param>
-/// <returns>Interpolated value</returns>
-double Demosaic::HQLinear::interGreenFromBlue(const Image &img, int row, int col)
+/// <param name="img">Image for the result</param>
+/// <param name="area">Area to interpolate</param>
+/// <returns>Area clipped to the active area without its border</returns>
+Rect Demosaic::HQLinear::interArea(const Image &img, const Rect &area)
 {
-    double gsum, bsum;
-
-    // Green for linear interpolation
-    gsum = img.getValueG(row - 1, col);
-    gsum += img.getValueG(row, col + 1);
-    gsum += img.getValueG(row + 1, col);
-    gsum += img.getValueG(row, col - 1);
-
-    // Red for gradient correction
-    bsum = 4 * img.getValueR(row, col);
-    bsum -= img.getValueR(row - 2, col);
-    bsum -= img.getValueR(row, col + 2);
-    bsum -= img.getValueR(row + 2, col);
-    bsum -= img.getValueR(row, col - 2);
-
-    // Resulting interpolated green
-    return (2 * gsum + bsum) / 8;
+    constexpr int padding = 2;
+    const Rect active = img.getCamProfile()->getActiveArea();
+    return Rect(Point(std::max(area.left, active.left + padding),
+            std::max(area.top, active.top + padding)),
+        Point(std::min(area.right, active.right - padding),
+            std::min(area.bottom, active.bottom - padding)));
 }
 
 /// <summary>
-/// Interpolate Red from Green on Red line (Pattern No. 3)
+/// Interpolate the rows of an area
 /// </summary>
-/// <param name="img">Source image</param>
-/// <param name="row">Image row</param>
-/// <param name="col">Image column</param>
-/// <returns>Interpolated value</returns>
-double Demosaic::HQLinear::interRedFromGreenR(const Image &img, int row, int col)
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <typeparam name="F">CFA filter pattern</typeparam>
+/// <param name="srcImg">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <param name="rows">Interpolated rows and columns</param>
+/// <param name="ring">Ring of five mosaic rows</param>
+/// <param name="out">Output rows of the channels</param>
+/// <remarks>
+/// Mosaic rows are loaded once into the ring, and the kernels are
+/// specialised for the row parity.
+/// </remarks>
+template<typename T, CFAPattern::Filter F>
+void Demosaic::HQLinear::interRows(const Mosaic &srcImg, Image &img,
+    const Rect &rows, Array2D<T> &ring, Array2D<T> &out)
 {
-    double rsum, gsum;
-
-    // Blinear interpolation of red
-    rsum = img.getValueR(row, col - 1) + img.getValueR(row, col + 1);
-    rsum *= 4;
-
-    // Gradient correction of Green
-    gsum = 5 * img.getValueG(row, col);
-    gsum += (img.getValueG(row - 2, col) + img.getValueG(row + 2, col)) / 2;
-    gsum -= img.getValueG(row + 1, col - 1) + img.getValueG(row + 1, col + 1)
-        + img.getValueG(row - 1, col - 1) + img.getValueG(row - 1, col + 1)
-        + img.getValueG(row, col - 2) + img.getValueG(row, col + 2);
-    return (rsum + gsum) / 8;
+    constexpr int padding = 2;
+    const int bcol = rows.left, ecol = rows.right, count = ecol - bcol;
+    const auto load = [&](int row) {
+        srcImg.getValues(row, bcol - padding,
+            count + 2 * padding, ring[row % 5] + bcol - padding);
+    };
+
+    for (int row = rows.top - padding; row < rows.top + padding; row++) {
+        load(row);
+    }
+    for (int row = rows.top; row < rows.bottom; row++)
+    {
+        load(row + padding);
+        const Window<T> w{ring[(row - 2) % 5], ring[(row - 1) % 5],
+            ring[row % 5], ring[(row + 1) % 5], ring[(row + 2) % 5]};
+
+        if (Utils::odd(row))
+            interRow<T, CFAPattern::RowColors<F, 1>>(
+                w, bcol, ecol, out[0], out[1], out[2]);
+        else
+            interRow<T, CFAPattern::RowColors<F, 0>>(
+                w, bcol, ecol, out[0], out[1], out[2]);
+        img.setRow(row, bcol, count,
+            out[0] + bcol, out[1] + bcol, out[2] + bcol);
+    }
+    return;
 }
 
 /// <summary>
-/// Interpolate Red from Green on Blue line (Pattern No. 4)
+/// Print demosaic logo message
 /// </summary>
-/// <param name="img">Source image</param>
-/// <param name="row">Image row</param>
-/// <param name="col">Image column</param>
-/// <returns>Interpolated value</returns>
-double Demosaic::HQLinear::interRedFromGreenB(const Image &img, int row, int col)
+/// <param name="os">Output stream for print</param>
+void Demosaic::HQLinear::printLogo(Logger &os) const
 {
-    double rsum = img.getValueR(row - 1, col) + img.getValueR(row + 1, col);
-    rsum *= 4;
-
-    double gsum = 5 * img.getValueG(row, col);
-    gsum += (img.getValueG(row, col - 2) + img.getValueG(row, col + 2)) / 2;
-    gsum -= img.getValueG(row + 1, col - 1) + img.getValueG(row + 1, col + 1)
-        + img.getValueG(row - 1, col - 1) + img.getValueG(row - 1, col + 1)
-        + img.getValueG(row - 2, col) + img.getValueG(row + 2, col);
-    return (rsum + gsum) / 8;
+    os << "High-Quality linear demosaicing algorithm";
+    return;
 }
 
 /// <summary>
-/// Interpolate Red from Blue (Pattern No. 5)
+/// Interpolate one row
 /// </summary>
-/// <param name="img">Source image</param>
-/// <param name="row">Image row</param>
-/// <param name="col">Image column</param>
-/// <returns>Interpolated value</returns>
-double Demosaic::HQLinear::interRedFromBlue(const Image &img, int row, int col)
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <typeparam name="Row">Colors of the row</typeparam>
+/// <param name="w">Mosaic rows</param>
+/// <param name="bcol">First column</param>
+/// <param name="ecol">End column</param>
+/// <param name="r">Red row</param>
+/// <param name="g">Green row</param>
+/// <param name="b">Blue row</param>
+template<typename T, typename Row>
+void Demosaic::HQLinear::interRow(const Window<T> &w,
+    int bcol, int ecol, T *r, T *g, T *b)
 {
-    double rsum, bsum;
-
-    // Red for linear interpolation
-    rsum = img.getValueR(row + 1, col - 1);
-    rsum += img.getValueR(row + 1, col + 1);
-    rsum += img.getValueR(row - 1, col + 1);
-    rsum += img.getValueR(row - 1, col - 1);
-
-    // Blue for gradient correct
-    bsum = 4 * img.getValueB(row, col);
-    bsum -= img.getValueB(row - 2, col);
-    bsum -= img.getValueB(row, col + 2);
-    bsum -= img.getValueB(row - 2, col);
-    bsum -= img.getValueB(row, col - 2);
-
-    //  Resulting interpolated red
-    return (2 * rsum + (3.0 / 2) * bsum) / 8;
+    constexpr bool red = (Row::chroma == CFAPattern::Color::RED);
+    T* own = red ? r : b;
+    T* other = red ? b : r;
+
+    interChroma(w, CFAPattern::firstColumn(bcol, Row::chromaParity),
+        ecol, own, g, other);
+    interGreen(w, CFAPattern::firstColumn(bcol, Row::chromaParity ^ 1),
+        ecol, own, g, other);
+    return;
 }
 
 /// <summary>
-/// Interpolate Blue from Green on Blue line (Pattern No. 6)
+/// Interpolate the red or blue pixels of a row
 /// </summary>
-/// <param name="img">Source image</param>
-/// <param name="row">Image row</param>
-/// <param name="col">Image column</param>
-/// <returns>Interpolated value</returns>
-double Demosaic::HQLinear::interBlueFromGreenB(const Image &img, int row, int col)
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="w">Mosaic rows</param>
+/// <param name="first">First red or blue column</param>
+/// <param name="end">End column</param>
+/// <param name="own">Channel of the pixels</param>
+/// <param name="green">Green channel</param>
+/// <param name="other">The other color channel</param>
+template<typename T>
+void Demosaic::HQLinear::interChroma(const Window<T> &w, int first, int end,
+    T *own, T *green, T *other)
 {
-    double bsum, gsum;
+    #pragma omp simd
+    for (int c = first; c < end; c += 2)
+    {
+        const T center = w.mid[c];
 
-    // Blinear interpolation of red
-    bsum = img.getValueB(row, col - 1) + img.getValueB(row, col + 1);
-    bsum *= 4;
+        // Gradient of the own color, shared by both estimations
+        const T grad = 4 * center - w.up2[c] - w.down2[c]
+            - w.mid[c - 2] - w.mid[c + 2];
 
-    // Gradient correction of Green
-    gsum = 5 * img.getValueG(row, col);
-    gsum += (img.getValueG(row - 2, col) + img.getValueG(row + 2, col)) / 2;
-    gsum -= img.getValueG(row + 1, col - 1) + img.getValueG(row + 1, col + 1)
-        + img.getValueG(row - 1, col - 1) + img.getValueG(row - 1, col + 1)
-        + img.getValueG(row, col - 2) + img.getValueG(row, col + 2);
-    return (bsum + gsum) / 8;
-}
+        // Green for linear interpolation with gradient correction
+        const T gsum = w.up[c] + w.mid[c + 1] + w.down[c] + w.mid[c - 1];
 
-/// <summary>
-/// Interpolate Blue from Green on Red line (Pattern No. 7)
-/// </summary>
-/// <param name="img">Source image</param>
-/// <param name="row">Image row</param>
-/// <param name="col">Image column</param>
-/// <returns>Interpolated value</returns>
-double Demosaic::HQLinear::interBlueFromGreenR(const Image &img, int row, int col)
-{
-    double bsum = img.getValueB(row - 1, col) + img.getValueB(row + 1, col);
-    bsum *= 4;
+        // Other color from the diagonals
+        const T dsum = w.down[c - 1] + w.down[c + 1]
+            + w.up[c + 1] + w.up[c - 1];
 
-    double gsum = 5 * img.getValueG(row, col);
-    gsum += (img.getValueG(row, col - 2) + img.getValueG(row, col + 2)) / 2;
-    gsum -= img.getValueG(row + 1, col - 1) + img.getValueG(row + 1, col + 1)
-        + img.getValueG(row - 1, col - 1) + img.getValueG(row - 1, col + 1)
-        + img.getValueG(row - 2, col) + img.getValueG(row + 2, col);
-    return (bsum + gsum) / 8;
+        own[c] = center;
+        green[c] = (2 * gsum + grad) / 8;
+        other[c] = (2 * dsum + T(1.5) * grad) / 8;
+    }
+    return;
 }
 
 /// <summary>
-/// Interpolate Blue from Red(Pattern No. 8)
+/// Interpolate the green pixels of a row
 /// </summary>
-/// <param name="img">Source image</param>
-/// <param name="row">Image row</param>
-/// <param name="col">Image column</param>
-/// <returns>Interpolated value</returns>
-double Demosaic::HQLinear::interBlueFromRed(const Image &img, int row, int col)
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="w">Mosaic rows</param>
+/// <param name="first">First green column</param>
+/// <param name="end">End column</param>
+/// <param name="own">Color of the row, neighbours on the row</param>
+/// <param name="green">Green channel</param>
+/// <param name="other">Other color, neighbours on the column</param>
+template<typename T>
+void Demosaic::HQLinear::interGreen(const Window<T> &w, int first, int end,
+    T *own, T *green, T *other)
 {
-    double bsum, rsum;
-
-    // Blue for linear interpolation
-    bsum  = img.getValueB(row + 1, col - 1);
-    bsum += img.getValueB(row + 1, col + 1);
-    bsum += img.getValueB(row - 1, col + 1);
-    bsum += img.getValueB(row - 1, col - 1);
-
-    // Red for gradient correct
-    rsum  = 4 * img.getValueR(row, col);
-    rsum -= img.getValueR(row - 2, col);
-    rsum -= img.getValueR(row, col + 2);
-    rsum -= img.getValueR(row - 2, col);
-    rsum -= img.getValueR(row, col - 2);
-
-    //  Resulting interpolated blue
-    return (2 * bsum + (3.0 / 2) * rsum) / 8;
+    #pragma omp simd
+    for (int c = first; c < end; c += 2)
+    {
+        const T center = 5 * w.mid[c];
+        const T diag = w.down[c - 1] + w.down[c + 1]
+            + w.up[c - 1] + w.up[c + 1];
+
+        // Bilinear interpolation with gradient correction of green
+        const T hsum = (w.mid[c - 1] + w.mid[c + 1]) * 4;
+        const T hgrad = center + (w.up2[c] + w.down2[c]) / 2
+            - (diag + w.mid[c - 2] + w.mid[c + 2]);
+        const T vsum = (w.up[c] + w.down[c]) * 4;
+        const T vgrad = center + (w.mid[c - 2] + w.mid[c + 2]) / 2
+            - (diag + w.up2[c] + w.down2[c]);
+
+        own[c] = (hsum + hgrad) / 8;
+        green[c] = w.mid[c];
+        other[c] = (vsum + vgrad) / 8;
+    }
+    return;
 }
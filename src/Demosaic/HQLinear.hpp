@@ -20,26 +20,59 @@
 
 #pragma once
 
+#include "CamProfiles/CFAPattern.hpp"
 #include "Demosaic/Algorithm.hpp"
+#include "Structures/Array2D.hpp"
 class Logger;
+class Mosaic;
+struct Rect;
 
 namespace Demosaic
 {
     class HQLinear : public IAlgorithm
     {
+        /// <summary>
+        /// Rows in a band processed by one thread
+        /// </summary>
+        static constexpr int bandHeight = 32;
+
+        /// <summary>
+        /// Five mosaic rows around the interpolated one
+        /// </summary>
+        template<typename T>
+        struct Window {
+            const T* up2;
+            const T* up;
+            const T* mid;
+            const T* down;
+            const T* down2;
+        };
+
     public: // IAlgorithm interface
         virtual ~HQLinear();
-        virtual void demosaic(Image &img);
+        virtual void demosaic(const Mosaic &raw, Image &img);
         virtual void printLogo(Logger &os) const;
 
-    private: // Nine demosaic patterns
-        static double interGreenFromRed(const Image &img, int row, int col);
-        static double interGreenFromBlue(const Image &img, int row, int col);
-        static double interRedFromGreenR(const Image &img, int row, int col);
-        static double interRedFromGreenB(const Image &img, int row, int col);
-        static double interRedFromBlue(const Image &img, int row, int col);
-        static double interBlueFromGreenB(const Image &img, int row, int col);
-        static double interBlueFromGreenR(const Image &img, int row, int col);
-        static double interBlueFromRed(const Image &img, int row, int col);
+    public: // Partial demosaicing
+        void demosaic(const Mosaic &srcImg, Image &img, const Rect &area);
+        static void demosaicTile(
+            const Mosaic &srcImg, Image &img, const Rect &area);
+
+    private: // Rows of the area
+        static Rect interArea(const Image &img, const Rect &area);
+        template<typename T, CFAPattern::Filter F>
+        static void interRows(const Mosaic &srcImg, Image &img,
+            const Rect &rows, Array2D<T> &ring, Array2D<T> &out);
+
+    private: // Filters of the row phases
+        template<typename T, typename Row>
+        static void interRow(const Window<T> &w,
+            int bcol, int ecol, T *r, T *g, T *b);
+        template<typename T>
+        static void interChroma(const Window<T> &w, int first, int end,
+            T *own, T *green, T *other);
+        template<typename T>
+        static void interGreen(const Window<T> &w, int first, int end,
+            T *own, T *green, T *other);
     };
 };
@@ -0,0 +1,451 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Hybrid.hpp"
+
+#include "Border.hpp"
+#include "Structures/Image.hpp"
+#include "CamProfiles/CamProfile.hpp"
+#include "RawDev.hpp"
+#include "Logger.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+/// <summary>
+/// Virtual empty destructor
+/// </summary>
+Demosaic::Hybrid::~Hybrid()
+{ }
+
+/// <summary>
+/// Hybrid demosaicing algorithm
+/// </summary>
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <remarks>
+/// HQLinear runs over the flat tiles and the blending bands of the
+/// detailed ones in one loop, then AHD over the detailed tiles.
+/// </remarks>
+void Demosaic::Hybrid::demosaic(const Mosaic &raw, Image &img)
+{
+    const AHD::TilePlan plan = selectTiles(raw, img);
+    const int tileCount = static_cast<int>(plan.areas.size());
+    const int detailed = static_cast<int>(
+        std::count(plan.selected.begin(), plan.selected.end(), true));
+
+    const int percent = (tileCount > 0)
+        ? static_cast<int>(std::lround(100.0 * detailed / tileCount)) : 0;
+    RawDev::verbout << "Detailed tiles by AHD " << detailed << " of "
+        << tileCount << " (" << percent << "%), flat by HQLinear "
+        << tileCount - detailed << " (" << 100 - percent << "%)";
+    RawDev::verbout.newline(); // Under the logo
+
+    dispatchPrecision(raw.getPrecision(), [&]<typename T>() {
+        std::vector<Band<T>> bands = planBands<T>(plan);
+        const int jobCount = tileCount + static_cast<int>(bands.size());
+        const bool scratch = // Mosaic mapped from a scratch file
+            BufferPool::global().getScratchDir().empty() == false;
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int job = 0; job < jobCount; job++)
+        {
+            const bool isBand = (job >= tileCount);
+            if (!isBand && plan.selected[job])
+                continue;
+
+            const Rect& area = isBand
+                ? bands[job - tileCount].area : plan.areas[job];
+            if (scratch)
+                raw.advise(BufferPool::Advice::WillNeed,
+                    area.top - 2, area.bottom + 2);
+            if (isBand)
+                saveBand(raw, img, bands[job - tileCount]);
+            else
+                HQLinear::demosaicTile(raw, img, area);
+        }
+        m_ahd.demosaic(raw, img, plan);
+        blendBands(img, plan, bands);
+    });
+    fillBorder(raw, img, plan.bounds());
+    return;
+}
+
+/// <summary>
+/// Print demosaic logo message
+/// </summary>
+/// <param name="os">Output stream for print</param>
+void Demosaic::Hybrid::printLogo(Logger &os) const
+{
+    os << "Hybrid of high-quality linear and AHD demosaicing";
+    return;
+}
+
+/// <summary>
+/// Tiles of the image with the detailed ones selected
+/// </summary>
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <returns>Tile plan for AHD</returns>
+/// <remarks>
+/// The noise of a CFA position and level is the median difference of
+/// the flattest tiles there, so the frame gives its own noise profile.
+/// A tile is detailed, when enough of its differences are far over it.
+/// </remarks>
+Demosaic::AHD::TilePlan Demosaic::Hybrid::selectTiles(
+    const Mosaic &raw, const Image &img) const
+{
+    AHD::TilePlan plan = m_ahd.planTiles(img);
+    const int tileCount = static_cast<int>(plan.areas.size());
+    std::vector<Histogram> hists(tileCount);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int t = 0; t < tileCount; t++) {
+        hists[t] = edgeHistogram(raw, plan.areas[t]);
+    }
+
+    // Edge bins by slot, from the tiles with enough differences
+    std::array<int, slots> edgeBins;
+    for (int slot = 0; slot < slots; slot++)
+    {
+        std::vector<int> medians;
+        for (const Histogram& hist : hists) {
+            const Counts& counts = hist[slot];
+            uint32_t total = 0;
+            for (const uint32_t count : counts) {
+                total += count;
+            }
+            if (total >= minCounts)
+                medians.push_back(quantileBin(counts, 0.5));
+        }
+
+        double noise = 0.0;
+        if (!medians.empty()) {
+            const auto nth = medians.begin() + static_cast<int>(
+                noiseQuantile * (medians.size() - 1));
+            std::nth_element(medians.begin(), nth, medians.end());
+            noise = binValue(*nth);
+        }
+        // First bin wholly over the threshold
+        edgeBins[slot] = binOf(std::max(edgeNoise * noise, edgeFloor)) + 1;
+    }
+
+    for (int t = 0; t < tileCount; t++)
+    {
+        uint64_t total = 0, edges = 0;
+        for (int slot = 0; slot < slots; slot++) {
+            const Counts& counts = hists[t][slot];
+            for (int bin = 0; bin < histBins; bin++) {
+                total += counts[bin];
+                edges += (bin >= edgeBins[slot]) ? counts[bin] : 0;
+            }
+        }
+        plan.selected[t] = (total > 0) && (edges > detailShare * total);
+    }
+    return plan;
+}
+
+/// <summary>
+/// Histograms of the same color differences of the area
+/// </summary>
+/// <param name="raw">Source CFA data</param>
+/// <param name="area">Area of the tile</param>
+/// <returns>Histograms of the differences</returns>
+/// <remarks>
+/// Pixels two rows or columns apart have the same filter color,
+/// and their white balance gain is that of their CFA position.
+/// Pairs clipped at black are left out, they have no noise.
+/// </remarks>
+Demosaic::Hybrid::Histogram Demosaic::Hybrid::edgeHistogram(
+    const Mosaic &raw, const Rect &area)
+{
+    Histogram hist{};
+    const int width = area.right - area.left;
+    const int count = width - 2;
+    if (count <= 0 || area.bottom - area.top <= 2)
+        return hist;
+
+    std::vector<double> rows[3] = {std::vector<double>(width),
+        std::vector<double>(width), std::vector<double>(width)};
+    raw.getValues(area.top, area.left, width, rows[0].data());
+    raw.getValues(area.top + 1, area.left, width, rows[1].data());
+
+    for (int row = area.top; row < area.bottom - 2; row++)
+    {
+        const double* mid = rows[(row - area.top) % 3].data();
+        double* down2 = rows[(row - area.top + 2) % 3].data();
+        raw.getValues(row + 2, area.left, width, down2);
+
+        for (int c = 0; c < count; c++)
+        {
+            if (mid[c] <= 0.0)
+                continue;
+            const int position = ((row & 1) << 1) | ((area.left + c) & 1);
+            Counts* counts = &hist[position * levelBins];
+            if (mid[c + 2] > 0.0) {
+                const int level = levelOf(0.5 * (mid[c] + mid[c + 2]));
+                counts[level][binOf(std::abs(mid[c] - mid[c + 2]))]++;
+            }
+            if (down2[c] > 0.0) {
+                const int level = levelOf(0.5 * (mid[c] + down2[c]));
+                counts[level][binOf(std::abs(mid[c] - down2[c]))]++;
+            }
+        }
+    }
+    return hist;
+}
+
+/// <summary>
+/// Histogram slot of the level on a CFA position
+/// </summary>
+/// <param name="level">Mean value of the pair</param>
+/// <returns>Level index</returns>
+int Demosaic::Hybrid::levelOf(double level)
+{
+    if (level < levelMin)
+        return 0;
+    const int index = 1 + exponentOf(level) - exponentOf(levelMin);
+    return std::min(index, levelBins - 1);
+}
+
+/// <summary>
+/// Histogram bin of the difference
+/// </summary>
+/// <param name="difference">Absolute difference</param>
+/// <returns>Bin index</returns>
+/// <remarks>
+/// Octaves come from the exponent, their quarters from
+/// the top mantissa bits, no logarithm is needed.
+/// </remarks>
+int Demosaic::Hybrid::binOf(double difference)
+{
+    if (difference < histMin)
+        return 0;
+    const int quarter = static_cast<int>(
+        (std::bit_cast<uint64_t>(difference) >> 50) & 3);
+    const int octave = exponentOf(difference) - exponentOf(histMin);
+    return std::min(1 + octave * binsPerOctave + quarter, histBins - 1);
+}
+
+/// <summary>
+/// Difference in the middle of the bin
+/// </summary>
+/// <param name="bin">Bin index</param>
+/// <returns>Difference, zero for the first bin</returns>
+double Demosaic::Hybrid::binValue(int bin)
+{
+    if (bin == 0)
+        return 0.0;
+    const int octave = (bin - 1) / binsPerOctave;
+    const int quarter = (bin - 1) % binsPerOctave;
+    return std::ldexp(histMin * (1.0 + (quarter + 0.5) / binsPerOctave), octave);
+}
+
+/// <summary>
+/// Binary exponent of the positive value
+/// </summary>
+/// <param name="value">Positive normal value</param>
+/// <returns>Biased exponent</returns>
+int Demosaic::Hybrid::exponentOf(double value)
+{
+    return static_cast<int>((std::bit_cast<uint64_t>(value) >> 52) & 0x7ff);
+}
+
+/// <summary>
+/// Bin of the quantile of the histogram
+/// </summary>
+/// <param name="counts">Histogram</param>
+/// <param name="quantile">Quantile from 0 to 1</param>
+/// <returns>Bin index</returns>
+int Demosaic::Hybrid::quantileBin(const Counts &counts, double quantile)
+{
+    uint64_t total = 0;
+    for (const uint32_t count : counts) {
+        total += count;
+    }
+
+    const double limit = quantile * static_cast<double>(total);
+    uint64_t sum = 0;
+    for (int bin = 0; bin < histBins; bin++) {
+        sum += counts[bin];
+        if (static_cast<double>(sum) >= limit && sum > 0)
+            return bin;
+    }
+    return 0;
+}
+
+/// <summary>
+/// Sides of the tile with a flat neighbour
+/// </summary>
+/// <param name="plan">Tile plan with the detailed tiles selected</param>
+/// <param name="t">Index of the tile</param>
+/// <returns>Sides to blend</returns>
+Demosaic::Hybrid::Sides Demosaic::Hybrid::flatSides(
+    const AHD::TilePlan &plan, int t)
+{
+    const int count = static_cast<int>(plan.areas.size());
+    const int col = t % plan.xCount;
+    Sides sides;
+
+    sides.top = (t >= plan.xCount) && !plan.selected[t - plan.xCount];
+    sides.bottom = (t + plan.xCount < count) && !plan.selected[t + plan.xCount];
+    sides.left = (col > 0) && !plan.selected[t - 1];
+    sides.right = (col < plan.xCount - 1) && !plan.selected[t + 1];
+    return sides;
+}
+
+/// <summary>
+/// Blending bands of the detailed tiles
+/// </summary>
+/// <param name="plan">Tile plan with the detailed tiles selected</param>
+/// <returns>Bands with allocated values</returns>
+/// <remarks>
+/// The bands of a tile do not overlap, the top and bottom
+/// ones take the whole width with the corners.
+/// </remarks>
+template<typename T>
+std::vector<Demosaic::Hybrid::Band<T>> Demosaic::Hybrid::planBands(
+    const AHD::TilePlan &plan)
+{
+    std::vector<Band<T>> bands;
+
+    for (int t = 0; t < static_cast<int>(plan.areas.size()); t++)
+    {
+        if (!plan.selected[t])
+            continue;
+
+        const Rect& a = plan.areas[t];
+        const Sides sides = flatSides(plan, t);
+        const int top = sides.top ? std::min(a.top + blendWidth, a.bottom) : a.top;
+        const int bottom = sides.bottom ? std::max(a.bottom - blendWidth, top) : a.bottom;
+        const int left = sides.left ? std::min(a.left + blendWidth, a.right) : a.left;
+        const int right = sides.right ? std::max(a.right - blendWidth, left) : a.right;
+
+        const Rect areas[4] = {
+            Rect(Point(a.left, a.top), Point(a.right, top)),
+            Rect(Point(a.left, bottom), Point(a.right, a.bottom)),
+            Rect(Point(a.left, top), Point(left, bottom)),
+            Rect(Point(right, top), Point(a.right, bottom))
+        };
+        for (const Rect& area : areas)
+        {
+            if (area.getWidth() <= 0 || area.getHeight() <= 0)
+                continue;
+
+            const int width = area.getWidth(), height = area.getHeight();
+            bands.push_back(Band<T>{t, area, {Array2D<T>(width, height),
+                Array2D<T>(width, height), Array2D<T>(width, height)}});
+        }
+    }
+    return bands;
+}
+
+/// <summary>
+/// Interpolate and save high-quality linear values of the band
+/// </summary>
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <param name="band">Band to fill</param>
+template<typename T>
+void Demosaic::Hybrid::saveBand(const Mosaic &raw, Image &img, Band<T> &band)
+{
+    const Rect& area = band.area;
+    HQLinear::demosaicTile(raw, img, area);
+
+    for (int row = area.top; row < area.bottom; row++) {
+        const int br = row - area.top;
+        img.getRow(row, area.left, area.getWidth(), band.values[0][br],
+            band.values[1][br], band.values[2][br]);
+    }
+    return;
+}
+
+/// <summary>
+/// Blend AHD results with the saved bands
+/// </summary>
+/// <param name="img">Image with the detailed tiles by AHD</param>
+/// <param name="plan">Tile plan with the detailed tiles selected</param>
+/// <param name="bands">Saved high-quality linear values</param>
+template<typename T>
+void Demosaic::Hybrid::blendBands(Image &img,
+    const AHD::TilePlan &plan, const std::vector<Band<T>> &bands)
+{
+    const int bandCount = static_cast<int>(bands.size());
+
+    #pragma omp parallel
+    {
+        std::vector<T> rgb[3];
+
+        #pragma omp for schedule(dynamic)
+        for (int i = 0; i < bandCount; i++)
+        {
+            const Band<T>& band = bands[i];
+            const Rect& tileArea = plan.areas[band.tile];
+            const Sides sides = flatSides(plan, band.tile);
+            const int width = band.area.getWidth();
+            for (std::vector<T>& channel : rgb) {
+                channel.resize(width);
+            }
+
+            for (int row = band.area.top; row < band.area.bottom; row++)
+            {
+                const int br = row - band.area.top;
+                img.getRow(row, band.area.left, width,
+                    rgb[0].data(), rgb[1].data(), rgb[2].data());
+
+                for (int bc = 0; bc < width; bc++) {
+                    const T w = static_cast<T>(blendWeight(
+                        tileArea, sides, row, band.area.left + bc));
+                    for (int ch = 0; ch < 3; ch++) {
+                        const T hq = band.values[ch][br][bc];
+                        rgb[ch][bc] = hq + w * (rgb[ch][bc] - hq);
+                    }
+                }
+                img.setRow(row, band.area.left, width,
+                    rgb[0].data(), rgb[1].data(), rgb[2].data());
+            }
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Weight of the AHD result in the blending band
+/// </summary>
+/// <param name="area">Area of the detailed tile</param>
+/// <param name="sides">Sides with a flat neighbour</param>
+/// <param name="row">Image row</param>
+/// <param name="col">Image column</param>
+/// <returns>Weight rising linearly from the flat sides</returns>
+double Demosaic::Hybrid::blendWeight(
+    const Rect &area, const Sides &sides, int row, int col)
+{
+    int distance = blendWidth; // To the nearest flat side
+    if (sides.top)
+        distance = std::min(distance, row - area.top);
+    if (sides.bottom)
+        distance = std::min(distance, area.bottom - 1 - row);
+    if (sides.left)
+        distance = std::min(distance, col - area.left);
+    if (sides.right)
+        distance = std::min(distance, area.right - 1 - col);
+    return std::min(1.0, (distance + 0.5) / blendWidth);
+}
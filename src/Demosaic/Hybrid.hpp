@@ -0,0 +1,128 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Demosaic/AHD.hpp"
+#include "Demosaic/HQLinear.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class Logger;
+class Mosaic;
+
+namespace Demosaic
+{
+    /// <summary>
+    /// Hybrid of high-quality linear and AHD demosaicing
+    /// </summary>
+    /// <remarks>
+    /// Flat parts of the frame, like sky or backdrops, gain nothing from
+    /// AHD. Only the AHD tiles with enough edges over the noise of
+    /// the frame are demosaiced by AHD, the rest by HQLinear. Where a detailed
+    /// tile meets a flat one, the results are blended.
+    /// </remarks>
+    class Hybrid : public IAlgorithm
+    {
+        /// <summary>
+        /// Width of the blending band inside a detailed tile
+        /// </summary>
+        static constexpr int blendWidth = 16;
+
+        /// <summary>
+        /// Share of the flattest tiles giving the noise of a slot
+        /// </summary>
+        static constexpr double noiseQuantile = 0.2;
+
+        /// <summary>
+        /// Edge difference in multiples of the noise median,
+        /// and the minimum one for noise free images
+        /// </summary>
+        static constexpr double edgeNoise = 6.0, edgeFloor = 0.01;
+
+        /// <summary>
+        /// Share of edge differences of a detailed tile
+        /// </summary>
+        static constexpr double detailShare = 0.0005;
+
+        /// <summary>
+        /// Logarithmic histograms of the differences by CFA position and
+        /// level, one octave per level and quarter octaves of differences,
+        /// the first bins take everything under the minimum
+        /// </summary>
+        static constexpr int levelBins = 12, histBins = 64, binsPerOctave = 4;
+        static constexpr int slots = 4 * levelBins;
+        static constexpr double levelMin = 1.0 / 1024, histMin = 1.0 / 8192;
+        using Counts = std::array<uint32_t, histBins>;
+        using Histogram = std::array<Counts, slots>;
+
+        /// <summary>
+        /// Differences of a slot needed for its noise median in a tile
+        /// </summary>
+        static constexpr uint32_t minCounts = 256;
+
+        /// <summary>
+        /// Sides of a tile with a flat neighbour
+        /// </summary>
+        struct Sides {
+            bool top, bottom, left, right;
+        };
+
+        /// <summary>
+        /// High-quality linear values of a blending band
+        /// </summary>
+        template<typename T>
+        struct Band {
+            int tile;    // Index of the detailed tile
+            Rect area;   // Band inside the tile
+            Array2D<T> values[3]; // Red, green and blue
+        };
+
+        AHD m_ahd;
+
+    public: // IAlgorithm interface
+        virtual ~Hybrid();
+        virtual void demosaic(const Mosaic &raw, Image &img);
+        virtual void printLogo(Logger &os) const;
+
+    public: // Tile selection
+        AHD::TilePlan selectTiles(const Mosaic &raw, const Image &img) const;
+
+    private: // Tile selection and blending
+        static Histogram edgeHistogram(const Mosaic &raw, const Rect &area);
+        static int levelOf(double level);
+        static int binOf(double difference);
+        static double binValue(int bin);
+        static int exponentOf(double value);
+        static int quantileBin(const Counts &counts, double quantile);
+        static Sides flatSides(const AHD::TilePlan &plan, int t);
+        template<typename T>
+        static std::vector<Band<T>> planBands(const AHD::TilePlan &plan);
+        template<typename T>
+        static void saveBand(const Mosaic &raw, Image &img, Band<T> &band);
+        template<typename T>
+        static void blendBands(Image &img,
+            const AHD::TilePlan &plan, const std::vector<Band<T>> &bands);
+        static double blendWeight(
+            const Rect &area, const Sides &sides, int row, int col);
+    };
+};
@@ -0,0 +1,630 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "RCD.hpp"
+
+/*
+RATIO CORRECTED DEMOSAICING
+
+Luis Sanz Rodríguez, RCD v2.3. Quality close to AHD with no
+visible zipper and maze artefacts, at a fraction of its cost.
+*/
+
+#include "Demosaic/Bilinear.hpp"
+#include "Demosaic/Border.hpp"
+#include "Demosaic/RowAdvice.hpp"
+#include "Structures/Image.hpp"
+#include "Structures/Rect.hpp"
+#include "CamProfiles/CamProfile.hpp"
+#include "CamProfiles/CFAPattern.hpp"
+#include "Utils.hpp"
+#include "Logger.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+// Small values against division by zero
+template<typename T> constexpr T eps = static_cast<T>(1e-5);
+template<typename T> constexpr T epssq = static_cast<T>(1e-10);
+
+/// <summary>
+/// Virtual empty destructor
+/// </summary>
+Demosaic::RCD::~RCD()
+{ }
+
+/// <summary>
+/// Ratio corrected demosaicing algorithm
+/// </summary>
+/// <param name="raw">Source CFA data</param>
+/// <param name="img">Image for the result</param>
+/// <remarks>
+/// The tiles overlap by two borders. Around the active area they
+/// read a mirrored CFA, so the whole area is interpolated by RCD.
+/// </remarks>
+void Demosaic::RCD::demosaic(const Mosaic &raw, Image &img)
+{
+    const Rect active = img.getCamProfile()->getActiveArea();
+    const CFAPattern cfa = img.getCamProfile()->getCFAPattern();
+    const int width = active.right - active.left;
+    const int height = active.bottom - active.top;
+
+    if (width <= border || height <= border) {
+        Bilinear().demosaic(raw, img); // Too small to mirror
+        return;
+    }
+
+    const int step = tileSize - 2 * border;
+    const int xTileCount = (width + step - 1) / step;
+    const int tileCount = xTileCount * ((height + step - 1) / step);
+    std::vector<int> tileRows(tileCount);
+    for (int t = 0; t < tileCount; t++) {
+        tileRows[t] = t / xTileCount;
+    }
+    RowAdvice advice(raw, std::move(tileRows));
+
+    dispatchPrecision(raw.getPrecision(), [&]<typename T>() {
+        #pragma omp parallel
+        {
+            Tile<T> tile; // Tile 192 cca. 3.2MB per core in double
+
+            #pragma omp for schedule(dynamic) nowait
+            for (int t = 0; t < tileCount; t++)
+            {
+                const div_t tmpdiv = std::div(t, xTileCount);
+                tile.top = active.top - border + step * tmpdiv.quot;
+                tile.left = active.left - border + step * tmpdiv.rem;
+                tile.height = std::min(tileSize,
+                    active.bottom + border - tile.top);
+                tile.width = std::min(tileSize,
+                    active.right + border - tile.left);
+                advice.begin(tile.top, tile.top + tile.height);
+
+                // RCD demosaicing algorithm
+                loadTile(raw, active, tile);
+                calcDirectionVH(tile);
+                calcLowPass(cfa, tile);
+                interGreen(cfa, tile);
+                calcDirectionPQ(tile);
+                interRedBlueOnChroma(cfa, tile);
+                interRedBlueOnGreen(cfa, tile);
+                storeTile(img, tile);
+                advice.finish(t, tile.top, tile.top + tile.height);
+            }
+        }
+    });
+    fillBorder(raw, img, active);
+    return;
+}
+
+/// <summary>
+/// Print demosaic logo message
+/// </summary>
+/// <param name="os">Output stream for print</param>
+void Demosaic::RCD::printLogo(Logger &os) const
+{
+    os << "Ratio corrected demosaicing algorithm";
+    return;
+}
+
+/// <summary>
+/// Allocate the tile buffers
+/// </summary>
+template<typename T>
+Demosaic::RCD::Tile<T>::Tile()
+    : top(0), left(0), height(0), width(0),
+      cfa(tileSize, tileSize), vhDir(tileSize, tileSize),
+      pqDir(tileSize, tileSize), lpf(tileSize, tileSize)
+{
+    for (int c = 0; c < 3; c++) {
+        rgb[c] = Array2D<T>(tileSize, tileSize);
+    }
+    hpf[0] = Array2D<T>(tileSize, tileSize);
+    hpf[1] = Array2D<T>(tileSize, tileSize);
+}
+
+/// <summary>
+/// Load the CFA values of the tile
+/// </summary>
+/// <param name="raw">Source CFA data</param>
+/// <param name="active">Active area of the sensor</param>
+/// <param name="tile">Tile buffers</param>
+/// <remarks>
+/// Outside the active area the CFA is mirrored around its edge
+/// pixels, which keeps the CFA phase. All channels start with the
+/// CFA values, so each has its own samples and defined values
+/// in the rest.
+/// </remarks>
+template<typename T>
+void Demosaic::RCD::loadTile(const Mosaic &raw,
+    const Rect &active, Tile<T> &tile)
+{
+    const int first = active.left - tile.left;      // Mirror columns
+    const int last = active.right - 1 - tile.left;  // in the tile
+    const int begin = std::max(0, first);
+    const int end = std::min(tile.width, last + 1);
+
+    for (int tr = 0; tr < tile.height; tr++)
+    {
+        int row = tile.top + tr;
+        if (row < active.top)
+            row = 2 * active.top - row;
+        else if (row >= active.bottom)
+            row = 2 * (active.bottom - 1) - row;
+
+        T* cfa = tile.cfa[tr];
+        raw.getValues(row, tile.left + begin, end - begin, cfa + begin);
+        for (int tc = 0; tc < begin; tc++) {
+            cfa[tc] = cfa[2 * first - tc];
+        }
+        for (int tc = end; tc < tile.width; tc++) {
+            cfa[tc] = cfa[2 * last - tc];
+        }
+        for (int c = 0; c < 3; c++) {
+            std::copy_n(cfa, tile.width, tile.rgb[c][tr]);
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// High pass filter of color differences squared
+/// </summary>
+/// <param name="m3">Sample three pixels before</param>
+/// <param name="m2">Sample two pixels before</param>
+/// <param name="m1">Sample one pixel before</param>
+/// <param name="c">Central sample</param>
+/// <param name="p1">Sample one pixel after</param>
+/// <param name="p2">Sample two pixels after</param>
+/// <param name="p3">Sample three pixels after</param>
+/// <returns>Filter response squared</returns>
+template<typename T>
+static inline T highPass(T m3, T m2, T m1,
+    T c, T p1, T p2, T p3)
+{
+    return Utils::sqr((m3 - m1 - p1 + p3) - 3 * (m2 + p2) + 6 * c);
+}
+
+/// <summary>
+/// Vertical and horizontal local discrimination (Step 1)
+/// </summary>
+/// <param name="tile">Tile buffers</param>
+template<typename T>
+void Demosaic::RCD::calcDirectionVH(Tile<T> &tile)
+{
+    const Array2D<T>& cfa = tile.cfa;
+    Array2D<T>& vhpf = tile.hpf[0];
+    Array2D<T>& hhpf = tile.hpf[1];
+    const int height = tile.height, width = tile.width;
+
+    // Squares of the vertical and horizontal high pass filters
+    for (int tr = 3; tr < height - 3; tr++)
+    {
+        const T* c[7] = {cfa[tr - 3], cfa[tr - 2], cfa[tr - 1],
+            cfa[tr], cfa[tr + 1], cfa[tr + 2], cfa[tr + 3]};
+        T* v = vhpf[tr];
+        T* h = hhpf[tr];
+
+        #pragma omp simd
+        for (int tc = 0; tc < width; tc++) {
+            v[tc] = highPass(c[0][tc], c[1][tc], c[2][tc],
+                c[3][tc], c[4][tc], c[5][tc], c[6][tc]);
+        }
+        #pragma omp simd
+        for (int tc = 3; tc < width - 3; tc++) {
+            const T* m = c[3];
+            h[tc] = highPass(m[tc - 3], m[tc - 2], m[tc - 1],
+                m[tc], m[tc + 1], m[tc + 2], m[tc + 3]);
+        }
+    }
+
+    // Discrimination strength from the neighbourhood
+    for (int tr = 4; tr < height - 4; tr++)
+    {
+        const T* vup = vhpf[tr - 1];
+        const T* vmid = vhpf[tr];
+        const T* vdown = vhpf[tr + 1];
+        const T* h = hhpf[tr];
+        T* dir = tile.vhDir[tr];
+
+        #pragma omp simd
+        for (int tc = 4; tc < width - 4; tc++)
+        {
+            const T vstat = Utils::max2(epssq<T>,
+                vup[tc] + vmid[tc] + vdown[tc]);
+            const T hstat = Utils::max2(epssq<T>,
+                h[tc - 1] + h[tc] + h[tc + 1]);
+            dir[tc] = vstat / (vstat + hstat);
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Low pass filter of the CFA samples (Step 2)
+/// </summary>
+/// <param name="cfa">CFA pattern</param>
+/// <param name="tile">Tile buffers</param>
+/// <remarks>
+/// Only on the red and blue pixels, where the green interpolation
+/// reads it two pixels around its rows and columns.
+/// </remarks>
+template<typename T>
+void Demosaic::RCD::calcLowPass(const CFAPattern &cfa, Tile<T> &tile)
+{
+    const Array2D<T>& raw = tile.cfa;
+
+    for (int tr = 3; tr < tile.height - 3; tr++)
+    {
+        const T* up = raw[tr - 1];
+        const T* mid = raw[tr];
+        const T* down = raw[tr + 1];
+        T* lpf = tile.lpf[tr];
+
+        #pragma omp simd
+        for (int tc = firstChroma(cfa, tile, tr, 3); tc < tile.width - 3; tc += 2)
+        {
+            lpf[tc] = T(0.25) * mid[tc]
+                + T(0.125) * (up[tc] + down[tc] + mid[tc - 1] + mid[tc + 1])
+                + T(0.0625) * (up[tc - 1] + up[tc + 1]
+                    + down[tc - 1] + down[tc + 1]);
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Refined discrimination with the diagonal neighbours
+/// </summary>
+/// <param name="up">Discrimination of the previous row</param>
+/// <param name="mid">Discrimination of the current row</param>
+/// <param name="down">Discrimination of the next row</param>
+/// <param name="tc">Tile column</param>
+/// <returns>The value more distant from the undecided 0.5</returns>
+template<typename T>
+static inline T refineDirection(const T* up,
+    const T* mid, const T* down, int tc)
+{
+    const T central = mid[tc];
+    const T neighbourhood = T(0.25) * (up[tc - 1] + up[tc + 1]
+        + down[tc - 1] + down[tc + 1]);
+    return (std::abs(T(0.5) - central) < std::abs(T(0.5) - neighbourhood))
+        ? neighbourhood : central;
+}
+
+/// <summary>
+/// Interpolate green on red and blue pixels (Step 3)
+/// </summary>
+/// <param name="cfa">CFA pattern</param>
+/// <param name="tile">Tile buffers</param>
+template<typename T>
+void Demosaic::RCD::interGreen(const CFAPattern &cfa, Tile<T> &tile)
+{
+    const Array2D<T>& raw = tile.cfa;
+    const Array2D<T>& lpf = tile.lpf;
+
+    for (int tr = 5; tr < tile.height - 5; tr++)
+    {
+        const T* m4 = raw[tr - 4];
+        const T* m3 = raw[tr - 3];
+        const T* m2 = raw[tr - 2];
+        const T* m1 = raw[tr - 1];
+        const T* c0 = raw[tr];
+        const T* p1 = raw[tr + 1];
+        const T* p2 = raw[tr + 2];
+        const T* p3 = raw[tr + 3];
+        const T* p4 = raw[tr + 4];
+        const T* lup = lpf[tr - 2];
+        const T* lmid = lpf[tr];
+        const T* ldown = lpf[tr + 2];
+        const T* dup = tile.vhDir[tr - 1];
+        const T* dmid = tile.vhDir[tr];
+        const T* ddown = tile.vhDir[tr + 1];
+        T* green = tile.rgb[1][tr];
+
+        #pragma omp simd
+        for (int tc = firstChroma(cfa, tile, tr, 5); tc < tile.width - 5; tc += 2)
+        {
+            const T disc = refineDirection(dup, dmid, ddown, tc);
+
+            // Cardinal gradients
+            const T vdiff = std::abs(m1[tc] - p1[tc]);
+            const T hdiff = std::abs(c0[tc - 1] - c0[tc + 1]);
+            const T ngrad = eps<T> + vdiff + std::abs(c0[tc] - m2[tc])
+                + std::abs(m1[tc] - m3[tc]) + std::abs(m2[tc] - m4[tc]);
+            const T sgrad = eps<T> + vdiff + std::abs(c0[tc] - p2[tc])
+                + std::abs(p1[tc] - p3[tc]) + std::abs(p2[tc] - p4[tc]);
+            const T wgrad = eps<T> + hdiff + std::abs(c0[tc] - c0[tc - 2])
+                + std::abs(c0[tc - 1] - c0[tc - 3])
+                + std::abs(c0[tc - 2] - c0[tc - 4]);
+            const T egrad = eps<T> + hdiff + std::abs(c0[tc] - c0[tc + 2])
+                + std::abs(c0[tc + 1] - c0[tc + 3])
+                + std::abs(c0[tc + 2] - c0[tc + 4]);
+
+            // Cardinal estimations corrected by the low pass ratios
+            // to the same colored pixels two pixels away
+            const T l2 = 2 * lmid[tc];
+            const T nest = m1[tc] * l2 / (eps<T> + lmid[tc] + lup[tc]);
+            const T sest = p1[tc] * l2 / (eps<T> + lmid[tc] + ldown[tc]);
+            const T west = c0[tc - 1] * l2 / (eps<T> + lmid[tc] + lmid[tc - 2]);
+            const T eest = c0[tc + 1] * l2 / (eps<T> + lmid[tc] + lmid[tc + 2]);
+
+            // Vertical and horizontal estimations
+            const T vest = (sgrad * nest + ngrad * sest) / (ngrad + sgrad);
+            const T hest = (wgrad * eest + egrad * west) / (egrad + wgrad);
+            green[tc] = disc * (hest - vest) + vest;
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Diagonal local discrimination (Step 4.1)
+/// </summary>
+/// <param name="tile">Tile buffers</param>
+template<typename T>
+void Demosaic::RCD::calcDirectionPQ(Tile<T> &tile)
+{
+    const Array2D<T>& cfa = tile.cfa;
+    Array2D<T>& phpf = tile.hpf[0];
+    Array2D<T>& qhpf = tile.hpf[1];
+    const int height = tile.height, width = tile.width;
+
+    // Squares of the high pass filters on the diagonals
+    for (int tr = 3; tr < height - 3; tr++)
+    {
+        const T* c[7] = {cfa[tr - 3], cfa[tr - 2], cfa[tr - 1],
+            cfa[tr], cfa[tr + 1], cfa[tr + 2], cfa[tr + 3]};
+        T* p = phpf[tr];
+        T* q = qhpf[tr];
+
+        #pragma omp simd
+        for (int tc = 3; tc < width - 3; tc++)
+        {
+            p[tc] = highPass(c[0][tc - 3], c[1][tc - 2], c[2][tc - 1],
+                c[3][tc], c[4][tc + 1], c[5][tc + 2], c[6][tc + 3]);
+            q[tc] = highPass(c[0][tc + 3], c[1][tc + 2], c[2][tc + 1],
+                c[3][tc], c[4][tc - 1], c[5][tc - 2], c[6][tc - 3]);
+        }
+    }
+
+    // Discrimination strength from the neighbourhood
+    for (int tr = 4; tr < height - 4; tr++)
+    {
+        const T* pup = phpf[tr - 1];
+        const T* pmid = phpf[tr];
+        const T* pdown = phpf[tr + 1];
+        const T* qup = qhpf[tr - 1];
+        const T* qmid = qhpf[tr];
+        const T* qdown = qhpf[tr + 1];
+        T* dir = tile.pqDir[tr];
+
+        #pragma omp simd
+        for (int tc = 4; tc < width - 4; tc++)
+        {
+            const T pstat = Utils::max2(epssq<T>,
+                pup[tc - 1] + pmid[tc] + pdown[tc + 1]);
+            const T qstat = Utils::max2(epssq<T>,
+                qup[tc + 1] + qmid[tc] + qdown[tc - 1]);
+            dir[tc] = pstat / (pstat + qstat);
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Interpolate red on blue and blue on red pixels (Step 4.2)
+/// </summary>
+/// <param name="cfa">CFA pattern</param>
+/// <param name="tile">Tile buffers</param>
+/// <remarks>
+/// The other color is on the diagonals, where the samples are
+/// still the CFA values.
+/// </remarks>
+template<typename T>
+void Demosaic::RCD::interRedBlueOnChroma(const CFAPattern &cfa, Tile<T> &tile)
+{
+    const Array2D<T>& green = tile.rgb[1];
+
+    for (int tr = 7; tr < tile.height - 7; tr++)
+    {
+        const int first = firstChroma(cfa, tile, tr, 7);
+        const bool redRow = (cfa((tile.top + tr) & 1, (tile.left + first) & 1)
+            == CFAPattern::Color::RED);
+        Array2D<T>& color = tile.rgb[redRow ? 2 : 0];
+        const T* cm3 = color[tr - 3];
+        const T* cm1 = color[tr - 1];
+        const T* cp1 = color[tr + 1];
+        const T* cp3 = color[tr + 3];
+        const T* gm2 = green[tr - 2];
+        const T* gm1 = green[tr - 1];
+        const T* g0 = green[tr];
+        const T* gp1 = green[tr + 1];
+        const T* gp2 = green[tr + 2];
+        const T* dup = tile.pqDir[tr - 1];
+        const T* dmid = tile.pqDir[tr];
+        const T* ddown = tile.pqDir[tr + 1];
+        T* out = color[tr];
+
+        #pragma omp simd
+        for (int tc = first; tc < tile.width - 7; tc += 2)
+        {
+            const T disc = refineDirection(dup, dmid, ddown, tc);
+
+            // Diagonal gradients
+            const T pdiff = std::abs(cm1[tc - 1] - cp1[tc + 1]);
+            const T qdiff = std::abs(cm1[tc + 1] - cp1[tc - 1]);
+            const T nwgrad = eps<T> + pdiff + std::abs(cm1[tc - 1] - cm3[tc - 3])
+                + std::abs(g0[tc] - gm2[tc - 2]);
+            const T negrad = eps<T> + qdiff + std::abs(cm1[tc + 1] - cm3[tc + 3])
+                + std::abs(g0[tc] - gm2[tc + 2]);
+            const T swgrad = eps<T> + qdiff + std::abs(cp1[tc - 1] - cp3[tc - 3])
+                + std::abs(g0[tc] - gp2[tc - 2]);
+            const T segrad = eps<T> + pdiff + std::abs(cp1[tc + 1] - cp3[tc + 3])
+                + std::abs(g0[tc] - gp2[tc + 2]);
+
+            // Diagonal color differences
+            const T nwest = cm1[tc - 1] - gm1[tc - 1];
+            const T neest = cm1[tc + 1] - gm1[tc + 1];
+            const T swest = cp1[tc - 1] - gp1[tc - 1];
+            const T seest = cp1[tc + 1] - gp1[tc + 1];
+
+            // P and Q estimations
+            const T pest = (nwgrad * seest + segrad * nwest) / (nwgrad + segrad);
+            const T qest = (negrad * swest + swgrad * neest) / (negrad + swgrad);
+            out[tc] = g0[tc] + disc * (qest - pest) + pest;
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Rows of a channel around the interpolated pixel
+/// </summary>
+template<typename T>
+struct Rows {
+    const T* m3; // Three rows up
+    const T* m1; // Row up
+    T* c0;       // Current row
+    const T* p1; // Row down
+    const T* p3; // Three rows down
+
+    Rows(Array2D<T> &plane, int tr)
+        : m3(plane[tr - 3]), m1(plane[tr - 1]), c0(plane[tr]),
+          p1(plane[tr + 1]), p3(plane[tr + 3])
+    { }
+};
+
+/// <summary>
+/// Interpolate red or blue on a green pixel
+/// </summary>
+/// <param name="c">Rows of the interpolated channel</param>
+/// <param name="g">Rows of the green channel</param>
+/// <param name="tc">Tile column</param>
+/// <param name="grad">Green gradients in N, S, W, E</param>
+/// <param name="disc">Vertical and horizontal discrimination</param>
+/// <returns>Interpolated value</returns>
+template<typename T>
+static inline T colorOnGreen(const Rows<T> &c, const Rows<T> &g,
+    int tc, const T (&grad)[4], T disc)
+{
+    const T* c0 = c.c0;
+    const T* g0 = g.c0;
+
+    // Cardinal gradients
+    const T vdiff = std::abs(c.m1[tc] - c.p1[tc]);
+    const T hdiff = std::abs(c0[tc - 1] - c0[tc + 1]);
+    const T ngrad = grad[0] + vdiff + std::abs(c.m1[tc] - c.m3[tc]);
+    const T sgrad = grad[1] + vdiff + std::abs(c.p1[tc] - c.p3[tc]);
+    const T wgrad = grad[2] + hdiff + std::abs(c0[tc - 1] - c0[tc - 3]);
+    const T egrad = grad[3] + hdiff + std::abs(c0[tc + 1] - c0[tc + 3]);
+
+    // Cardinal color differences
+    const T nest = c.m1[tc] - g.m1[tc];
+    const T sest = c.p1[tc] - g.p1[tc];
+    const T west = c0[tc - 1] - g0[tc - 1];
+    const T eest = c0[tc + 1] - g0[tc + 1];
+
+    // Vertical and horizontal estimations
+    const T vest = (ngrad * sest + sgrad * nest) / (ngrad + sgrad);
+    const T hest = (egrad * west + wgrad * eest) / (egrad + wgrad);
+    return g0[tc] + disc * (hest - vest) + vest;
+}
+
+/// <summary>
+/// Interpolate red and blue on green pixels (Step 4.3)
+/// </summary>
+/// <param name="cfa">CFA pattern</param>
+/// <param name="tile">Tile buffers</param>
+/// <remarks>
+/// Both channels in one pass share the discrimination
+/// and the green gradients.
+/// </remarks>
+template<typename T>
+void Demosaic::RCD::interRedBlueOnGreen(const CFAPattern &cfa, Tile<T> &tile)
+{
+    for (int tr = border; tr < tile.height - border; tr++)
+    {
+        const Rows<T> red(tile.rgb[0], tr);
+        const Rows<T> green(tile.rgb[1], tr);
+        const Rows<T> blue(tile.rgb[2], tr);
+        const T* gm2 = tile.rgb[1][tr - 2];
+        const T* gp2 = tile.rgb[1][tr + 2];
+        const T* g0 = green.c0;
+        const T* dup = tile.vhDir[tr - 1];
+        const T* dmid = tile.vhDir[tr];
+        const T* ddown = tile.vhDir[tr + 1];
+        T* rout = red.c0;
+        T* bout = blue.c0;
+
+        #pragma omp simd
+        for (int tc = firstChroma(cfa, tile, tr, border) ^ 1;
+            tc < tile.width - border; tc += 2)
+        {
+            const T disc = refineDirection(dup, dmid, ddown, tc);
+            const T grad[4] = {
+                eps<T> + std::abs(g0[tc] - gm2[tc]),
+                eps<T> + std::abs(g0[tc] - gp2[tc]),
+                eps<T> + std::abs(g0[tc] - g0[tc - 2]),
+                eps<T> + std::abs(g0[tc] - g0[tc + 2])
+            };
+            rout[tc] = colorOnGreen(red, green, tc, grad, disc);
+            bout[tc] = colorOnGreen(blue, green, tc, grad, disc);
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Store the valid inner part of the tile
+/// </summary>
+/// <param name="img">Target image</param>
+/// <param name="tile">Tile buffers</param>
+template<typename T>
+void Demosaic::RCD::storeTile(Image &img, Tile<T> &tile)
+{
+    const int count = tile.width - 2 * border;
+
+    for (int tr = border; tr < tile.height - border; tr++) {
+        img.setRow(tile.top + tr, tile.left + border, count,
+            tile.rgb[0][tr] + border, tile.rgb[1][tr] + border,
+            tile.rgb[2][tr] + border);
+    }
+    return;
+}
+
+/// <summary>
+/// First red or blue column of a tile row
+/// </summary>
+/// <param name="cfa">CFA pattern</param>
+/// <param name="tile">Tile buffers</param>
+/// <param name="tr">Tile row</param>
+/// <param name="tc">Starting tile column</param>
+/// <returns>The starting or the next column</returns>
+template<typename T>
+inline int Demosaic::RCD::firstChroma(const CFAPattern &cfa,
+    const Tile<T> &tile, int tr, int tc)
+{
+    // Only the parity, the mirrored border starts before the image
+    const CFAPattern::Color color = cfa((tile.top + tr) & 1, (tile.left + tc) & 1);
+    return CFAPattern::isGreen(color) ? tc + 1 : tc;
+}
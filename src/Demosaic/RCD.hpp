@@ -0,0 +1,99 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Demosaic/Algorithm.hpp"
+#include "Structures/Array2D.hpp"
+
+struct CFAPattern;
+struct Rect;
+class Logger;
+
+namespace Demosaic
+{
+    /// <summary>
+    /// Ratio corrected demosaicing
+    /// </summary>
+    /// <remarks>
+    /// RCD by Luis Sanz Rodríguez. The green is interpolated from the
+    /// ratios of a low pass filter in the direction given by the local
+    /// discrimination of vertical and horizontal high frequencies.
+    /// Red and blue are interpolated as color differences to the green,
+    /// on red and blue pixels along the diagonals.
+    /// </remarks>
+    class RCD : public IAlgorithm
+    {
+        /// <summary>
+        /// Tile size with the border for parallel interpolation
+        /// </summary>
+        static constexpr int tileSize = 192;
+
+        /// <summary>
+        /// Border of the tile, which is not valid in the output
+        /// </summary>
+        static constexpr int border = 10;
+
+        /// <summary>
+        /// Tile buffers
+        /// </summary>
+        template<typename T>
+        struct Tile {
+            int top, left;     // Position in the image
+            int height, width; // Size, smaller on the image edge
+            Array2D<T> cfa;
+            Array2D<T> rgb[3];
+            Array2D<T> vhDir, pqDir; // Directional discrimination
+            Array2D<T> lpf;          // Low pass filter of the CFA
+            Array2D<T> hpf[2];       // High pass filters squared
+
+            Tile();
+        };
+
+    public: // IAlgorithm interface
+        virtual ~RCD();
+        virtual void demosaic(const Mosaic &raw, Image &img);
+        virtual void printLogo(Logger &os) const;
+
+    private: // RCD algorithm steps
+        template<typename T>
+        static void loadTile(const Mosaic &raw,
+            const Rect &active, Tile<T> &tile);
+        template<typename T>
+        static void calcDirectionVH(Tile<T> &tile);
+        template<typename T>
+        static void calcLowPass(const CFAPattern &cfa, Tile<T> &tile);
+        template<typename T>
+        static void interGreen(const CFAPattern &cfa, Tile<T> &tile);
+        template<typename T>
+        static void calcDirectionPQ(Tile<T> &tile);
+        template<typename T>
+        static void interRedBlueOnChroma(const CFAPattern &cfa, Tile<T> &tile);
+        template<typename T>
+        static void interRedBlueOnGreen(const CFAPattern &cfa, Tile<T> &tile);
+        template<typename T>
+        static void storeTile(Image &img, Tile<T> &tile);
+
+    private: // Helpers
+        template<typename T>
+        static int firstChroma(const CFAPattern &cfa,
+            const Tile<T> &tile, int tr, int tc);
+    };
+};
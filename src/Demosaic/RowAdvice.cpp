@@ -0,0 +1,88 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "RowAdvice.hpp"
+
+#include "Structures/BufferPool.hpp"
+#include "Structures/Mosaic.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="raw">Source CFA data</param>
+/// <param name="tileRows">Row of tiles of each tile</param>
+Demosaic::RowAdvice::RowAdvice(const Mosaic &raw, std::vector<int> tileRows)
+    : m_raw(raw),
+      m_scratch(BufferPool::global().getScratchDir().empty() == false),
+      m_tileRows(std::move(tileRows))
+{
+    const int rowCount = m_tileRows.empty() ? 0
+        : *std::max_element(m_tileRows.begin(), m_tileRows.end()) + 1;
+    m_left = std::make_unique<std::atomic<int>[]>(rowCount);
+
+    for (const int row : m_tileRows) {
+        m_left[row]++;
+    }
+}
+
+/// <summary>
+/// Constructor for bands, each a row of its own
+/// </summary>
+/// <param name="raw">Source CFA data</param>
+/// <param name="bandCount">Number of bands</param>
+Demosaic::RowAdvice::RowAdvice(const Mosaic &raw, int bandCount)
+    : RowAdvice(raw, [bandCount] {
+        std::vector<int> rows(bandCount);
+        std::iota(rows.begin(), rows.end(), 0);
+        return rows;
+    }())
+{ }
+
+/// <summary>
+/// Advise the mosaic rows of a tile to be read in
+/// </summary>
+/// <param name="top">First mosaic row read by the tile</param>
+/// <param name="bottom">Row after the last one</param>
+void Demosaic::RowAdvice::begin(int top, int bottom) const
+{
+    if (m_scratch)
+        m_raw.advise(BufferPool::Advice::WillNeed, top, bottom);
+    return;
+}
+
+/// <summary>
+/// Mark the tile finished
+/// </summary>
+/// <param name="t">Index of the tile</param>
+/// <param name="top">First row of the tile</param>
+/// <param name="bottom">Row after the last one</param>
+/// <returns>True for the last tile of its row</returns>
+bool Demosaic::RowAdvice::finish(int t, int top, int bottom)
+{
+    if (--m_left[m_tileRows[t]] > 0)
+        return false;
+
+    if (m_scratch)
+        m_raw.advise(BufferPool::Advice::DontNeed, top, bottom);
+    return true;
+}
@@ -0,0 +1,56 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class Mosaic;
+
+namespace Demosaic
+{
+    /// <summary>
+    /// Memory advice for the rows of tiles and bands
+    /// </summary>
+    /// <remarks>
+    /// Only with a scratch directory, when the mosaic is mapped from
+    /// a file. The mosaic rows of a tile are read in before it is
+    /// processed. When the last tile of a row of tiles is finished,
+    /// its mosaic rows are paged out first, so the mosaic pages band
+    /// by band, even when the tiles run in any order. The image is
+    /// written next and never advised.
+    /// </remarks>
+    class RowAdvice
+    {
+        const Mosaic &m_raw;
+        bool m_scratch; // Mosaic mapped from a scratch file
+        std::vector<int> m_tileRows; // Row of tiles of each tile
+        std::unique_ptr<std::atomic<int>[]> m_left; // Unfinished tiles
+
+    public:
+        RowAdvice(const Mosaic &raw, std::vector<int> tileRows);
+        RowAdvice(const Mosaic &raw, int bandCount);
+
+        void begin(int top, int bottom) const;
+        bool finish(int t, int top, int bottom);
+    };
+};
@@ -0,0 +1,426 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Fast8.hpp"
+
+#include "CamProfiles/CamProfile.hpp"
+#include "Options.hpp"
+#include "Output.hpp"
+#include "ProcRGB.hpp"
+#include "RawDev.hpp"
+#include "Structures/Image.hpp"
+#include "Structures/Rect.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+/// <summary>
+/// Run the fast pipeline and write the output
+/// </summary>
+/// <param name="img">Raw image</param>
+/// <param name="opt">Processing options</param>
+void Fast8Module::run(Image& img, const Options& opt)
+{
+    const Array2D<Color::RGB8> data = develop(img, opt);
+    OutputModule::run(img, data.view(), opt);
+    return;
+}
+
+/// <summary>
+/// Develop the raw image into the 8-bit output area
+/// </summary>
+/// <param name="img">Raw image, its mosaic is scaled in place</param>
+/// <param name="opt">Processing options</param>
+/// <returns>Output area in the output color space</returns>
+Array2D<Color::RGB8> Fast8Module::develop(Image& img, const Options& opt)
+{
+    const ScaleModule::Levels levels = ScaleModule::calcLevels(img, opt);
+    Fast8Module fast(opt);
+    return fast.process(img, levels);
+}
+
+/// <summary>
+/// Construct and prepare the curve tables
+/// </summary>
+/// <param name="opt">Processing options</param>
+Fast8Module::Fast8Module(const Options& opt)
+    : m_Algorithm(opt.getDemosaicAlg()),
+      m_ColorProfile(opt.getColorProfile()),
+      m_NoCrop(opt.getNoCrop()),
+      m_Tone(ProcRGBModule::toneTable(opt))
+{
+    assert(m_Algorithm == Demosaic::AlgorithmType::Bilinear
+        || m_Algorithm == Demosaic::AlgorithmType::HQLinear);
+    buildGamma();
+    return;
+}
+
+/// <summary>
+/// Output gamma curve with the 8-bit quantization
+/// </summary>
+void Fast8Module::buildGamma()
+{
+    m_Gamma.resize(65536);
+    for (size_t i = 0; i < m_Gamma.size(); i++) {
+        const double value = Image::clip(
+            OutputModule::gammaCurve(m_ColorProfile, i / 65535.0));
+        m_Gamma[i] = static_cast<uint8_t>(floor(255.0 * value));
+    }
+    return;
+}
+
+/// <summary>
+/// Process the output area pixel by pixel
+/// </summary>
+/// <param name="img">Raw image</param>
+/// <param name="levels">Raw scaling levels</param>
+/// <returns>Output area in the output color space</returns>
+Array2D<Color::RGB8> Fast8Module::process(
+    Image& img, const ScaleModule::Levels& levels)
+{
+    const shared_ptr<CamProfile> profile = img.getCamProfile();
+    Mosaic& mosaic = img.getMosaic();
+
+    RawDev::verbout << "Scaling raw values by tables" << endl;
+    scale(mosaic, levels);
+
+    const bool hqlinear = (m_Algorithm == Demosaic::AlgorithmType::HQLinear);
+    RawDev::verbout << (hqlinear ? "High-Quality linear" : "Bilinear")
+        << " demosaicing, RGB processing and "
+        << kColorProfileNames[m_ColorProfile] << " output in one pass"
+        << endl;
+
+    const FixedMatrix cam2work(ProcRGBModule::workMatrix(*profile));
+    const FixedMatrix work2out(OutputModule::outputMatrix(m_ColorProfile));
+    const bool mapHSV = profile->hasHSVMaps();
+    const HSVMaps hsvMaps(*profile);
+    const CFAPattern cfa = mosaic.getCFAPattern();
+
+    // Demosaiced part, the rest keeps the raw values
+    const int padding = hqlinear ? 2 : 1;
+    const Rect active = profile->getActiveArea();
+    const Rect inner(Point(active.left + padding, active.top + padding),
+        Point(active.right - padding, active.bottom - padding));
+
+    const Rect area = img.getOutputArea(m_NoCrop);
+    Array2D<Color::RGB8> result(area.getWidth(), area.getHeight());
+
+    cfa.dispatch([&]<CFAPattern::Filter F>() {
+        #pragma omp parallel
+        {
+            Array2D<int32_t> rgb(mosaic.getWidth(), 3);
+
+            #pragma omp for schedule(static)
+            for (int y = 0; y < result.getHeight(); y++) {
+                const int row = area.top + y;
+                if (Utils::odd(row))
+                    demosaicRow<CFAPattern::RowColors<F, 1>>(mosaic, row,
+                        area, inner, hqlinear, rgb[0], rgb[1], rgb[2]);
+                else
+                    demosaicRow<CFAPattern::RowColors<F, 0>>(mosaic, row,
+                        area, inner, hqlinear, rgb[0], rgb[1], rgb[2]);
+
+                Color::RGB8* out = result[y];
+                for (int x = 0; x < result.getWidth(); x++) {
+                    const int col = area.left + x;
+                    Pixel v = {rgb[0][col], rgb[1][col], rgb[2][col]};
+
+                    // Camera to working space
+                    cam2work.apply(v);
+                    if (mapHSV)
+                        hsvMaps.apply(v);
+
+                    // Tone curves and output space
+                    for (int32_t& sample : v) {
+                        sample = m_Tone[sample];
+                    }
+                    work2out.apply(v);
+                    out[x] = {m_Gamma[v[0]], m_Gamma[v[1]], m_Gamma[v[2]]};
+                }
+            }
+        }
+    });
+    return result;
+}
+
+/// <summary>
+/// Subtract black and scale the raw values in place
+/// </summary>
+/// <param name="mosaic">Raw mosaic</param>
+/// <param name="levels">Black point and channel scales</param>
+/// <remarks>
+/// The results are 16-bit samples, where 65535 stands for one.
+/// </remarks>
+void Fast8Module::scale(Mosaic& mosaic, const ScaleModule::Levels& levels)
+{
+    const CFAPattern cfa = mosaic.getCFAPattern();
+    const double scales[3] = {levels.scaleR, levels.scaleG, levels.scaleB};
+    vector<uint16_t> tables[3];
+
+    for (int c = 0; c < 3; c++) {
+        tables[c].resize(65536);
+        for (size_t i = 0; i < tables[c].size(); i++) {
+            const double value = Image::clip(
+                (static_cast<double>(i) - levels.black) * scales[c]);
+            tables[c][i] = static_cast<uint16_t>(lround(value * 65535.0));
+        }
+    }
+
+    const auto table = [&](int row, int col) -> const uint16_t* {
+        const CFAPattern::Color color = cfa(row, col);
+        const int channel = (color == CFAPattern::Color::RED) ? 0
+            : (color == CFAPattern::Color::BLUE ? 2 : 1);
+        return tables[channel].data();
+    };
+
+    const int width = mosaic.getWidth(), height = mosaic.getHeight();
+    #pragma omp parallel for schedule(static)
+    for (int row = 0; row < height; row++) {
+        uint16_t* data = mosaic.getRawRow(row);
+        const uint16_t* even = table(row, 0);
+        const uint16_t* odd = table(row, 1);
+
+        for (int col = 0; col + 1 < width; col += 2) {
+            data[col] = even[data[col]];
+            data[col + 1] = odd[data[col + 1]];
+        }
+        if (width % 2 != 0)
+            data[width - 1] = even[data[width - 1]];
+    }
+    return;
+}
+
+/// <summary>
+/// Demosaic a row of the output area
+/// </summary>
+/// <typeparam name="Row">Colors of the row</typeparam>
+/// <param name="raw">Scaled mosaic</param>
+/// <param name="row">Image row</param>
+/// <param name="area">Output area</param>
+/// <param name="inner">Interpolated area</param>
+/// <param name="hqlinear">High-quality linear, otherwise bilinear</param>
+/// <param name="r">Red row by image column</param>
+/// <param name="g">Green row by image column</param>
+/// <param name="b">Blue row by image column</param>
+/// <remarks>
+/// Pixels outside the interpolated area keep the raw value
+/// in the channel of their filter color.
+/// </remarks>
+template<typename Row>
+void Fast8Module::demosaicRow(Mosaic& raw, int row, const Rect& area,
+    const Rect& inner, bool hqlinear, int32_t* r, int32_t* g, int32_t* b)
+{
+    const uint16_t* mid = raw.getRawRow(row);
+    int32_t* const channels[3] = {r, g, b};
+    for (int col = area.left; col < area.right; col++) {
+        r[col] = g[col] = b[col] = 0;
+        channels[CFAPattern::channel(Utils::odd(col) ? Row::odd : Row::even)][col]
+            = mid[col];
+    }
+
+    const int bcol = std::max(area.left, inner.left);
+    const int ecol = std::min(area.right, inner.right);
+    if (row < inner.top || row >= inner.bottom || bcol >= ecol)
+        return;
+
+    const auto rowAt = [&](int dr) -> const uint16_t* {
+        return raw.getRawRow(std::clamp(row + dr, 0, raw.getHeight() - 1));
+    };
+    const Window w{rowAt(-2), rowAt(-1), mid, rowAt(1), rowAt(2)};
+    if (hqlinear)
+        Fast8Module::hqlinear<Row>(w, bcol, ecol, r, g, b);
+    else
+        Fast8Module::bilinear<Row>(w, bcol, ecol, r, g, b);
+    return;
+}
+
+/// <summary>
+/// Bilinear demosaicing of a row
+/// </summary>
+/// <typeparam name="Row">Colors of the row</typeparam>
+/// <param name="w">Mosaic rows</param>
+/// <param name="bcol">First column</param>
+/// <param name="ecol">End column</param>
+/// <param name="r">Red row by image column</param>
+/// <param name="g">Green row by image column</param>
+/// <param name="b">Blue row by image column</param>
+template<typename Row>
+void Fast8Module::bilinear(const Window& w,
+    int bcol, int ecol, int32_t* r, int32_t* g, int32_t* b)
+{
+    constexpr bool red = (Row::chroma == CFAPattern::Color::RED);
+    int32_t* own = red ? r : b;
+    int32_t* other = red ? b : r;
+
+    for (int c = CFAPattern::firstColumn(bcol, Row::chromaParity);
+        c < ecol; c += 2) {
+        own[c] = w.mid[c];
+        g[c] = (w.up[c] + w.mid[c + 1] + w.down[c] + w.mid[c - 1] + 2) >> 2;
+        other[c] = (w.up[c - 1] + w.up[c + 1]
+            + w.down[c - 1] + w.down[c + 1] + 2) >> 2;
+    }
+    // Green pixels, the color of the row is on the sides
+    for (int c = CFAPattern::firstColumn(bcol, Row::chromaParity ^ 1);
+        c < ecol; c += 2) {
+        own[c] = (w.mid[c - 1] + w.mid[c + 1] + 1) >> 1;
+        g[c] = w.mid[c];
+        other[c] = (w.up[c] + w.down[c] + 1) >> 1;
+    }
+    return;
+}
+
+/// <summary>
+/// High-quality linear demosaicing of a row
+/// </summary>
+/// <typeparam name="Row">Colors of the row</typeparam>
+/// <param name="w">Mosaic rows</param>
+/// <param name="bcol">First column</param>
+/// <param name="ecol">End column</param>
+/// <param name="r">Red row by image column</param>
+/// <param name="g">Green row by image column</param>
+/// <param name="b">Blue row by image column</param>
+/// <remarks>
+/// The filters are the ones of Demosaic::HQLinear scaled to integer
+/// weights over 8 or 16, so both give the same results up to rounding.
+/// </remarks>
+template<typename Row>
+void Fast8Module::hqlinear(const Window& w,
+    int bcol, int ecol, int32_t* r, int32_t* g, int32_t* b)
+{
+    const auto div8 = [](int32_t sum) { return clampSample((sum + 4) >> 3); };
+    const auto div16 = [](int32_t sum) { return clampSample((sum + 8) >> 4); };
+    constexpr bool red = (Row::chroma == CFAPattern::Color::RED);
+    int32_t* own = red ? r : b;
+    int32_t* other = red ? b : r;
+
+    for (int c = CFAPattern::firstColumn(bcol, Row::chromaParity);
+        c < ecol; c += 2) {
+        const int32_t center = w.mid[c];
+        const int32_t axis = w.up[c] + w.mid[c + 1] + w.down[c] + w.mid[c - 1];
+        const int32_t diag = w.up[c - 1] + w.up[c + 1]
+            + w.down[c - 1] + w.down[c + 1];
+        const int32_t grad = 4 * center
+            - w.up2[c] - w.mid[c + 2] - w.down2[c] - w.mid[c - 2];
+
+        own[c] = center;
+        g[c] = div8(2 * axis + grad);
+        other[c] = div16(4 * diag + 3 * grad);
+    }
+    // Green pixels, the color of the row is on the sides
+    for (int c = CFAPattern::firstColumn(bcol, Row::chromaParity ^ 1);
+        c < ecol; c += 2) {
+        const int32_t diag = w.up[c - 1] + w.up[c + 1]
+            + w.down[c - 1] + w.down[c + 1];
+        const int32_t base = 10 * w.mid[c] - 2 * diag;
+
+        own[c] = div16(8 * (w.mid[c - 1] + w.mid[c + 1]) + base
+            + w.up2[c] + w.down2[c] - 2 * (w.mid[c - 2] + w.mid[c + 2]));
+        g[c] = w.mid[c];
+        other[c] = div16(8 * (w.up[c] + w.down[c]) + base
+            + w.mid[c - 2] + w.mid[c + 2] - 2 * (w.up2[c] + w.down2[c]));
+    }
+    return;
+}
+
+/// <summary>
+/// Convert matrix into fixed point
+/// </summary>
+/// <param name="mat">Matrix in double</param>
+/// <remarks>
+/// The fraction bits are selected so that no 32-bit sum of three
+/// 16-bit samples can overflow.
+/// </remarks>
+Fast8Module::FixedMatrix::FixedMatrix(const Mat3x3& mat)
+{
+    double maxSum = 0.0;
+    for (const auto& row : mat.mdata) {
+        maxSum = max(maxSum, fabs(row[0]) + fabs(row[1]) + fabs(row[2]));
+    }
+
+    constexpr double limit = numeric_limits<int32_t>::max();
+    shift = 16;
+    while (shift > 1 && (maxSum * (1 << shift) + 2.0) * 65535.0
+        + (1 << shift) >= limit) {
+        shift--;
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            coef[i][j] = static_cast<int32_t>(
+                lround(mat.mdata[i][j] * (1 << shift)));
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Multiply the sample by the matrix
+/// </summary>
+/// <param name="value">Sample, clamped to the 16-bit range after</param>
+void Fast8Module::FixedMatrix::apply(Pixel& value) const
+{
+    const int32_t half = 1 << (shift - 1);
+    int32_t result[3];
+
+    for (int i = 0; i < 3; i++) {
+        const int32_t sum = coef[i][0] * value[0]
+            + coef[i][1] * value[1] + coef[i][2] * value[2];
+        result[i] = clampSample((sum + half) >> shift);
+    }
+    std::copy(result, result + 3, value);
+    return;
+}
+
+/// <summary>
+/// Construct with the camera maps
+/// </summary>
+/// <param name="profile">Camera profile with the maps</param>
+Fast8Module::HSVMaps::HSVMaps(const CamProfile& profile)
+    : profile(profile)
+{
+}
+
+/// <summary>
+/// Map the sample through the camera maps
+/// </summary>
+/// <param name="value">Sample in the 16-bit range</param>
+/// <remarks>
+/// Same round trip over HSV as the RGB processing, the float
+/// rounding stays below a 16-bit code.
+/// </remarks>
+void Fast8Module::HSVMaps::apply(Pixel& value) const
+{
+    constexpr float scale = 1.0f / 65535.0f;
+    Color::HSV32 hsv = Color::rgb2hsv(Color::RGB32{
+        value[0] * scale, value[1] * scale, value[2] * scale});
+    profile.applyHSVMap(hsv);
+    profile.applyProfileLook(hsv);
+    const Color::RGB32 rgb = Color::hsv2rgb(hsv);
+
+    const float channels[3] = {rgb.r, rgb.g, rgb.b};
+    for (int c = 0; c < 3; c++) {
+        value[c] = clampSample(static_cast<int32_t>(
+            lroundf(channels[c] * 65535.0f)));
+    }
+    return;
+}
@@ -0,0 +1,123 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+#include <vector>
+
+#include "CamProfiles/CFAPattern.hpp"
+#include "ColorProfiles/ColorProfile.hpp"
+#include "Color.hpp"
+#include "Demosaic/AlgorithmType.hpp"
+#include "Scale.hpp"
+#include "Structures/Array2D.hpp"
+#include "Structures/Mat3x3.hpp"
+
+class CamProfile;
+class Image;
+class Mosaic;
+class Options;
+struct Rect;
+
+/// <summary>
+/// Fast 8-bit output pipeline in integer arithmetic
+/// </summary>
+/// <remarks>
+/// Replaces the scale, demosaic, RGB processing and output modules
+/// by one pass over the output area. Samples are 16-bit integers with
+/// 32-bit intermediates, the tone and gamma curves are tables. Only the
+/// bilinear and HQLinear demosaicing are supported, by row kernels of
+/// the CFA row phases. The camera HSV maps are applied in floats.
+/// </remarks>
+class Fast8Module
+{
+public:
+    using Pixel = int32_t[3]; // RGB sample with intermediate range
+
+    /// <summary>
+    /// Color matrix in fixed point
+    /// </summary>
+    struct FixedMatrix {
+        int32_t coef[3][3];
+        int shift;
+
+        explicit FixedMatrix(const Mat3x3& mat);
+        void apply(Pixel& value) const;
+    };
+
+    /// <summary>
+    /// Camera HSV maps in single precision
+    /// </summary>
+    /// <remarks>
+    /// The maps are interpolated in their own hue, saturation and value
+    /// cells. An RGB lattice cannot follow the hue steps of the maps.
+    /// </remarks>
+    struct HSVMaps {
+        const CamProfile& profile;
+
+        explicit HSVMaps(const CamProfile& profile);
+        void apply(Pixel& value) const;
+    };
+
+private:
+    Demosaic::AlgorithmType m_Algorithm;
+    ColorProfile m_ColorProfile;
+    bool m_NoCrop;
+    std::vector<uint16_t> m_Tone; // Tone curves
+    std::vector<uint8_t> m_Gamma; // Output gamma and quantization
+
+public:
+    static void run(Image& img, const Options& opt);
+    static Array2D<Color::RGB8> develop(Image& img, const Options& opt);
+
+private:
+    explicit Fast8Module(const Options& opt);
+    Array2D<Color::RGB8> process(Image& img, const ScaleModule::Levels& levels);
+    static void scale(Mosaic& mosaic, const ScaleModule::Levels& levels);
+    void buildGamma();
+
+private: // Demosaicing of one row
+    /// <summary>
+    /// Mosaic rows around the interpolated one
+    /// </summary>
+    struct Window {
+        const uint16_t *up2, *up, *mid, *down, *down2;
+    };
+
+    template<typename Row>
+    static void demosaicRow(Mosaic& raw, int row, const Rect& area,
+        const Rect& inner, bool hqlinear, int32_t* r, int32_t* g, int32_t* b);
+    template<typename Row>
+    static void bilinear(const Window& w,
+        int bcol, int ecol, int32_t* r, int32_t* g, int32_t* b);
+    template<typename Row>
+    static void hqlinear(const Window& w,
+        int bcol, int ecol, int32_t* r, int32_t* g, int32_t* b);
+    static int32_t clampSample(int32_t value);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline int32_t Fast8Module::clampSample(int32_t value)
+{
+    return (value < 0) ? 0 : (value > 65535 ? 65535 : value);
+}
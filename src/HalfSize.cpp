@@ -0,0 +1,190 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "HalfSize.hpp"
+
+#include "CamProfiles/CamProfile.hpp"
+#include "Logger.hpp"
+#include "RawDev.hpp"
+#include "StopWatch.hpp"
+#include "Structures/Image.hpp"
+#include "Structures/Rect.hpp"
+
+#include <vector>
+using namespace std;
+
+namespace {
+
+/// <summary>
+/// Camera profile of the half-size image
+/// </summary>
+/// <remarks>
+/// Keeps everything of the source profile, only the sensor areas
+/// are in the cell coordinates.
+/// </remarks>
+class HalfSizeProfile : public CamProfile {
+    shared_ptr<CamProfile> m_source;
+
+public:
+    explicit HalfSizeProfile(const shared_ptr<CamProfile> &source);
+
+    [[nodiscard]] string_view getCameraName() const override;
+    [[nodiscard]] CamID getCameraID() const override;
+
+private:
+    static Rect halve(const Rect &area);
+};
+
+HalfSizeProfile::HalfSizeProfile(const shared_ptr<CamProfile> &source)
+    : CamProfile(*source), m_source(source)
+{
+    setActiveArea(halve(source->getActiveArea()));
+    setCrop(halve(source->getCrop()));
+}
+
+string_view HalfSizeProfile::getCameraName() const
+{
+    return m_source->getCameraName();
+}
+
+CamID HalfSizeProfile::getCameraID() const
+{
+    return m_source->getCameraID();
+}
+
+/// <summary>
+/// Halve the area to the cells fully inside
+/// </summary>
+/// <param name="area">Area in sensor pixels</param>
+/// <returns>Area in cells</returns>
+Rect HalfSizeProfile::halve(const Rect &area)
+{
+    return {Point((area.left + 1) / 2, (area.top + 1) / 2),
+            Point(area.right / 2, area.bottom / 2)};
+}
+
+} // namespace
+
+/// <summary>
+/// Run half-size development of the scaled mosaic
+/// </summary>
+/// <param name="img">Scaled raw image, half-size RGB afterwards</param>
+void HalfSizeModule::run(Image &img)
+{
+    StopWatch watch(true);
+
+    const Mosaic raw = img.takeMosaic(); // Source CFA data
+    RawDev::verbout << "Superpixels of " << raw.getWidth() / 2 << "x"
+        << raw.getHeight() / 2 << " cells, greens averaged";
+    RawDev::verbout.newline();
+
+    img.setCamProfile(halfProfile(img.getCamProfile()));
+    raw.advise(BufferPool::Advice::Sequential);
+    collapse(raw, img);
+
+    watch.stop(); // Measuring time of collapsing
+    RawDev::verbout << "Collapsing took " << watch << endl;
+    return;
+}
+
+/// <summary>
+/// Make the camera profile for the half-size image
+/// </summary>
+/// <param name="profile">Profile of the sensor image</param>
+/// <returns>Profile with halved active area and crop</returns>
+shared_ptr<CamProfile> HalfSizeModule::halfProfile(
+    const shared_ptr<CamProfile> &profile)
+{
+    return make_shared<HalfSizeProfile>(profile);
+}
+
+/// <summary>
+/// Collapse every 2x2 cell of the mosaic into one RGB pixel
+/// </summary>
+/// <param name="raw">Scaled CFA data</param>
+/// <param name="img">Image getting the half-size RGB channels</param>
+/// <remarks>
+/// Odd last row or column of the mosaic has no full cell and is dropped.
+/// </remarks>
+void HalfSizeModule::collapse(const Mosaic &raw, Image &img)
+{
+    assert(raw.isScaled());
+    const int width = raw.getWidth() / 2, height = raw.getHeight() / 2;
+    img.allocateRGB(width, height, raw.getPrecision());
+
+    dispatchPrecision(raw.getPrecision(), [&]<typename T>() {
+        raw.getCFAPattern().dispatch([&]<CFAPattern::Filter F>() {
+            #pragma omp parallel
+            {
+                vector<T> top(2 * width), bottom(2 * width);
+                vector<T> r(width), g(width), b(width);
+
+                #pragma omp for schedule(static)
+                for (int row = 0; row < height; row++) {
+                    raw.getValues(2 * row, 0, 2 * width, top.data());
+                    raw.getValues(2 * row + 1, 0, 2 * width, bottom.data());
+                    collapseRow<T, F>(top.data(), bottom.data(),
+                        width, r.data(), g.data(), b.data());
+                    img.setRow(row, 0, width, r.data(), g.data(), b.data());
+                }
+            }
+        });
+    });
+    return;
+}
+
+/// <summary>
+/// Collapse one row of cells
+/// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <typeparam name="F">CFA filter pattern</typeparam>
+/// <param name="top">Even mosaic row</param>
+/// <param name="bottom">Odd mosaic row</param>
+/// <param name="count">Number of cells</param>
+/// <param name="r">Red output values</param>
+/// <param name="g">Green output values</param>
+/// <param name="b">Blue output values</param>
+template<typename T, CFAPattern::Filter F>
+void HalfSizeModule::collapseRow(const T *top, const T *bottom,
+    int count, T *r, T *g, T *b)
+{
+    using Color = CFAPattern::Color;
+
+    // Position of a filter color in the cell, row in bit 1 and column in bit 0
+    constexpr auto position = [](Color color) {
+        int pos = 0;
+        while (CFAPattern::color(F, pos >> 1, pos & 1) != color)
+            pos++;
+        return pos;
+    };
+    constexpr int red = position(Color::RED), blue = position(Color::BLUE);
+    constexpr int greenR = position(Color::GREEN_R);
+    constexpr int greenB = position(Color::GREEN_B);
+    const T *rows[2] = {top, bottom};
+
+    #pragma omp simd
+    for (int i = 0; i < count; i++) {
+        r[i] = rows[red >> 1][2 * i + (red & 1)];
+        g[i] = T(0.5) * (rows[greenR >> 1][2 * i + (greenR & 1)]
+            + rows[greenB >> 1][2 * i + (greenB & 1)]);
+        b[i] = rows[blue >> 1][2 * i + (blue & 1)];
+    }
+    return;
+}
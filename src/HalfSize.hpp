@@ -0,0 +1,52 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "CamProfiles/CFAPattern.hpp"
+
+class CamProfile;
+class Image;
+class Mosaic;
+
+/// <summary>
+/// Half-size superpixel development instead of demosaicing
+/// </summary>
+/// <remarks>
+/// Every 2x2 cell of the CFA is collapsed into one RGB pixel with
+/// the red, blue and the average of both greens. Active area and crop
+/// are halved to the cells fully inside, so the rest of the pipeline
+/// works on a quarter of the pixels.
+/// </remarks>
+class HalfSizeModule
+{
+public:
+    static void run(Image &img);
+    static std::shared_ptr<CamProfile> halfProfile(
+        const std::shared_ptr<CamProfile> &profile);
+    static void collapse(const Mosaic &raw, Image &img);
+
+private:
+    template<typename T, CFAPattern::Filter F>
+    static void collapseRow(const T *top, const T *bottom,
+        int count, T *r, T *g, T *b);
+};
@@ -0,0 +1,290 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "BitReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+/// <summary>
+/// Setup the reader at the actual stream position
+/// </summary>
+/// <param name="stream">Stream positioned at the entropy coded data</param>
+/// <param name="bufferLen">Size of the data block</param>
+BitReader::BitReader(std::istream& stream, size_t bufferLen)
+    : m_stream(stream), m_bufferLen(bufferLen)
+    , m_data(nullptr), m_dataLen(0)
+    , m_pos(nullptr), m_end(nullptr)
+    , m_streamPos(stream.tellg()), m_markerPos(-1)
+    , m_pendingFF(false), m_dataEnd(false)
+    , m_reservoir(0), m_bits(0), m_padBits(0)
+{
+    assert(bufferLen >= 2);
+    m_buffer = std::make_unique<uint8_t[]>(bufferLen);
+    return;
+}
+
+/// <summary>
+/// Setup the reader for a stream with all data in memory
+/// </summary>
+/// <param name="stream">Stream positioned at the entropy coded data</param>
+/// <param name="data">Stream data (eg. memory mapped file)</param>
+/// <param name="dataLen">Length of the stream data</param>
+/// <remarks>
+/// The bits are read straight from the data without any copy.
+/// The stream is only positioned at the data end by finish.
+/// </remarks>
+BitReader::BitReader(
+    std::istream& stream, const uint8_t* data, size_t dataLen)
+    : BitReader(stream, data, dataLen,
+        static_cast<uint64_t>(std::streamoff(stream.tellg())) << 3)
+{}
+
+/// <summary>
+/// Setup the reader in memory at the given bit position
+/// </summary>
+/// <param name="stream">Stream for positioning at the data end</param>
+/// <param name="data">Stream data (eg. memory mapped file)</param>
+/// <param name="dataLen">Length of the stream data</param>
+/// <param name="bitPos">Start position as obtained by bitPosition</param>
+/// <remarks>
+/// The stream is not touched here, so readers for different parts
+/// of the data can be created in parallel.
+/// </remarks>
+BitReader::BitReader(std::istream& stream,
+    const uint8_t* data, size_t dataLen, uint64_t bitPos)
+    : m_stream(stream), m_bufferLen(0)
+    , m_data(data), m_dataLen(dataLen)
+    , m_pos(nullptr), m_end(nullptr)
+    , m_streamPos(static_cast<std::streamoff>(bitPos >> 3))
+    , m_markerPos(-1), m_pendingFF(false), m_dataEnd(false)
+    , m_reservoir(0), m_bits(0), m_padBits(0)
+{
+    if (m_streamPos < 0 || static_cast<size_t>(m_streamPos) > dataLen)
+        m_dataEnd = true; // Nothing to read
+    get(static_cast<int>(bitPos & 7)); // Skip the used bits
+    return;
+}
+
+/// <summary>
+/// Position of the next bit in the stream
+/// </summary>
+/// <returns>Stream position in bits</returns>
+/// <remarks>
+/// Available only for data in memory. The loaded bytes are walked
+/// back in the data while skipping the stuffed 0x00 bytes.
+/// </remarks>
+uint64_t BitReader::bitPosition() const
+{
+    assert(m_data != nullptr);
+    const uint8_t* p = (m_pos != nullptr) ? m_pos : m_data + m_streamPos;
+    const int bits = std::max(m_bits - m_padBits, 0); // Loaded data bits
+
+    for (int bytes = (bits + 7) >> 3; bytes > 0; bytes--)
+    {
+        p--; // Previous data byte
+        if (*p == 0x00 && p > m_data && p[-1] == 0xff)
+            p--; // Skip the stuffing
+    }
+    if (bits == 0 && m_pos != nullptr && p[-1] == 0xff)
+        p++; // Next data byte follows the stuffing
+    const uint64_t used = static_cast<uint64_t>(-bits & 7);
+    return (static_cast<uint64_t>(p - m_data) << 3) + used;
+}
+
+/// <summary>
+/// Return the stream to the end of the data
+/// </summary>
+/// <remarks>
+/// The stream is read ahead in blocks, so it is positioned
+/// back to the marker, which terminated the data.
+/// </remarks>
+void BitReader::finish()
+{
+    m_stream.clear();
+    m_stream.seekg(endPosition());
+    return;
+}
+
+/// <summary>
+/// Stream position after the data
+/// </summary>
+/// <returns>Position of the marker, which terminated the data</returns>
+std::streamoff BitReader::endPosition() const
+{
+    if (m_markerPos >= 0)
+        return m_markerPos;
+    return m_streamPos - (m_pendingFF ? 1 : 0);
+}
+
+/// <summary>
+/// Fill the bit reservoir with at least 57 bits
+/// </summary>
+void BitReader::refill()
+{
+    while (m_bits <= 56)
+    {
+        if (m_end - m_pos >= 8)
+        {
+            // Load 8 bytes at once, but count only the whole ones.
+            // The rest gets the same value at the next refill.
+            uint64_t word = 0;
+            for (int i = 0; i < 8; i++)
+                word = (word << 8) | m_pos[i];
+            m_reservoir |= word >> m_bits;
+            const int bytes = (64 - m_bits) >> 3;
+            m_pos += bytes;
+            m_bits += bytes << 3;
+        }
+        else if (m_pos < m_end)
+        {
+            m_reservoir |= static_cast<uint64_t>(*m_pos++) << (56 - m_bits);
+            m_bits += 8;
+        }
+        else if (fillBuffer() == false)
+        {
+            m_bits += 8; // Zero padding behind the data end
+            m_padBits += 8;
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Read and unstuff the next data block
+/// </summary>
+/// <returns>False if there are no more data</returns>
+bool BitReader::fillBuffer()
+{
+    if (m_dataEnd == true)
+        return false;
+    else if (m_data != nullptr)
+        return fillMapped();
+
+    uint8_t* buff = m_buffer.get();
+    size_t len = 0;
+    if (m_pendingFF == true)
+    {
+        buff[len++] = 0xff; // Continue with the split pair
+        m_pendingFF = false;
+    }
+    const std::streamoff base = m_streamPos - static_cast<std::streamoff>(len);
+
+    m_stream.read(reinterpret_cast<char*>(buff + len),
+        static_cast<std::streamsize>(m_bufferLen - len));
+    const std::streamsize count = m_stream.gcount();
+    m_streamPos += count;
+    len += static_cast<size_t>(count);
+    if (m_stream.good() == false)
+        m_dataEnd = true; // No more data in the stream
+
+    m_pos = buff;
+    m_end = buff + unstuff(buff, len, base);
+    return true;
+}
+
+/// <summary>
+/// Remove the byte stuffing in place and find the data end
+/// </summary>
+/// <param name="buff">Block with the raw data</param>
+/// <param name="len">Block length</param>
+/// <param name="base">Stream position of the block</param>
+/// <returns>Length of the unstuffed data</returns>
+size_t BitReader::unstuff(uint8_t* buff, size_t len, std::streamoff base)
+{
+    const uint8_t* in = buff;
+    const uint8_t* const end = buff + len;
+    uint8_t* out = buff;
+
+    while (in < end)
+    {
+        const uint8_t* ff = static_cast<const uint8_t*>(
+            std::memchr(in, 0xff, static_cast<size_t>(end - in)));
+        if (ff == nullptr)
+            ff = end; // Rest of the block is plain data
+        const size_t plain = static_cast<size_t>(ff - in);
+        if (out != in)
+            std::memmove(out, in, plain);
+        out += plain;
+
+        if (ff == end)
+            break;
+        else if (ff + 1 == end)
+        {
+            // Pair split by the block end
+            m_pendingFF = (m_dataEnd == false);
+            break;
+        }
+        else if (ff[1] != 0x00)
+        {
+            // Marker terminates the data
+            m_markerPos = base + (ff - buff);
+            m_dataEnd = true;
+            break;
+        }
+        *out++ = 0xff; // Stuffed 0xff00 pair
+        in = ff + 2;
+    }
+    return static_cast<size_t>(out - buff);
+}
+
+/// <summary>
+/// Serve the next data run in place from the memory
+/// </summary>
+/// <returns>False if there are no more data</returns>
+/// <remarks>
+/// Run ends before the next 0xff. A stuffed 0xff00 pair is then
+/// served as a run with its first byte only.
+/// </remarks>
+bool BitReader::fillMapped()
+{
+    const uint8_t* src = m_data + m_streamPos;
+    const size_t len = m_dataLen - static_cast<size_t>(m_streamPos);
+    const uint8_t* ff = static_cast<const uint8_t*>(
+        std::memchr(src, 0xff, len));
+
+    if (ff == nullptr)
+    {
+        m_pos = src; // Plain data up to the end
+        m_end = src + len;
+        m_streamPos += static_cast<std::streamoff>(len);
+        m_dataEnd = true;
+    }
+    else if (ff != src)
+    {
+        m_pos = src; // Plain data up to the 0xff
+        m_end = ff;
+        m_streamPos += ff - src;
+    }
+    else if (len >= 2 && ff[1] == 0x00)
+    {
+        m_pos = ff; // Stuffed 0xff00 pair
+        m_end = ff + 1;
+        m_streamPos += 2;
+    }
+    else
+    {
+        if (len >= 2)
+            m_markerPos = m_streamPos; // Marker terminates the data
+        m_pos = m_end = src;
+        m_dataEnd = true;
+    }
+    return true;
+}
@@ -0,0 +1,137 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cinttypes>
+#include <istream>
+#include <memory>
+
+#include "NonCopyable.hpp"
+
+/// <summary>
+/// Bit reader for the lossless JPEG entropy coded data
+/// </summary>
+/// <remarks>
+/// The data are read in large blocks and the 0xff00 byte stuffing
+/// is removed from a block in one pass. Bits are then served from
+/// a 64-bit reservoir. The data end at the first marker. Reading
+/// behind the end gives zero bits, which is reported by overrun.
+/// Data in a memory mapping are served in place instead, split
+/// only at the stuffed 0xff bytes.
+/// </remarks>
+class BitReader : NonCopyable
+{
+public:
+    static constexpr size_t kBufferLen = 1 << 20; // 1MB data block
+    static constexpr int kMaxBits = 32; // Max. bits for one peek
+
+private:
+    std::istream& m_stream;
+    std::unique_ptr<uint8_t[]> m_buffer;
+    size_t m_bufferLen;
+
+    // Whole stream data if in memory
+    const uint8_t* m_data;
+    size_t m_dataLen;
+
+    // Unstuffed data of the actual block
+    const uint8_t* m_pos;
+    const uint8_t* m_end;
+
+    // Position in the stream
+    std::streamoff m_streamPos; // Next unread byte
+    std::streamoff m_markerPos; // Data end marker, -1 if not found
+    bool m_pendingFF; // Block ended with 0xff
+    bool m_dataEnd;
+
+    // Bit reservoir (MSB aligned)
+    uint64_t m_reservoir;
+    int m_bits, m_padBits;
+
+public:
+    explicit BitReader(std::istream& stream, size_t bufferLen = kBufferLen);
+    BitReader(std::istream& stream, const uint8_t* data, size_t dataLen);
+    BitReader(std::istream& stream,
+        const uint8_t* data, size_t dataLen, uint64_t bitPos);
+
+    uint32_t peek(int bits);
+    void consume(int bits);
+    uint32_t get(int bits);
+
+    bool overrun() const;
+    void finish();
+    std::streamoff endPosition() const;
+    uint64_t bitPosition() const;
+
+private:
+    void refill();
+    bool fillBuffer();
+    bool fillMapped();
+    size_t unstuff(uint8_t* buff, size_t len, std::streamoff base);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// <summary>
+/// Look at the next bits without removing them
+/// </summary>
+/// <param name="bits">Number of bits (max. kMaxBits)</param>
+/// <returns>Next bits as unsigned value</returns>
+inline uint32_t BitReader::peek(int bits)
+{
+    assert(bits >= 0 && bits <= kMaxBits);
+    if (m_bits < bits)
+        refill();
+    return static_cast<uint32_t>((m_reservoir >> 32) >> (32 - bits));
+}
+
+/// <summary>
+/// Remove already peeked bits
+/// </summary>
+/// <param name="bits">Number of bits to remove</param>
+inline void BitReader::consume(int bits)
+{
+    assert(bits >= 0 && bits <= m_bits);
+    m_reservoir <<= bits;
+    m_bits -= bits;
+    return;
+}
+
+/// <summary>
+/// Get and remove the next bits
+/// </summary>
+/// <param name="bits">Number of bits (max. kMaxBits)</param>
+/// <returns>Extracted bits as unsigned value</returns>
+inline uint32_t BitReader::get(int bits)
+{
+    const uint32_t val = peek(bits);
+    consume(bits);
+    return val;
+}
+
+/// <summary>
+/// Check if more bits were consumed than the data contain
+/// </summary>
+inline bool BitReader::overrun() const
+{
+    return m_bits < m_padBits;
+}
@@ -22,17 +22,24 @@
 
 #include "TiffHeader.hpp"
 #include "RawHeader.hpp"
-#include "HuffTree.hpp"
+#include "HuffTable.hpp"
+#include "BitReader.hpp"
+#include "DecodeIndex.hpp"
 #include "Exception.hpp"
 #include "Utils.hpp"
 
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <omp.h>
+
 using namespace std;
 
 /// <summary>
 /// Define Huffman Tables structure
 /// </summary>
 struct CR2Reader::DHTHeader {
-    HuffTree huff[4];
+    HuffTable huff[4];
 };
 
 /// <summary>
@@ -56,25 +63,84 @@ struct CR2Reader::SOSHeader {
     uint8_t components, tableSel[4][2]; // [Channel]->DC|AC
 };
 
+/// <summary>
+/// Part of the scan decoded from a guessed start position
+/// </summary>
+/// <remarks>
+/// Only the difference values are stored, as the predictors
+/// are not known before all the parts are linked together.
+/// </remarks>
+struct CR2Reader::SpecPart {
+    uint64_t startBit, endBit; // Nominal part of the data
+    int startPhase;            // Component of the first symbol
+    bool guessed;              // Start position not known to be valid
+    std::vector<uint16_t> diffs;
+    std::vector<uint64_t> head; // Positions of the first symbols
+    std::vector<uint64_t> tail; // Positions of symbols behind the end
+    size_t tailFirst;           // Symbol index of the first tail position
+    size_t syncFirst;           // First symbol after a skipped bad code
+    uint64_t stopBit;           // Position after the last symbol
+    bool ended;                 // Data end or bad code reached
+    bool badCode;
+    size_t first, last;         // Linked symbols of the part
+    uint64_t global;            // Image index of the first linked symbol
+};
+
+namespace {
+
+/// <summary>
+/// Sink storing the raw data as they are
+/// </summary>
+class ArraySink : public RawSink
+{
+    Array2D<uint16_t>& m_img;
+
+public:
+    explicit ArraySink(Array2D<uint16_t>& img) : m_img(img) {}
+
+    void allocate(int width, int height) override
+    {
+        m_img = Array2D<uint16_t>(width, height, k_planePolicy);
+        return;
+    }
+
+    void store(int row, int col, const uint16_t* data, int len) override
+    {
+        std::copy(data, data + len, m_img[row] + col);
+        return;
+    }
+};
+
+}
+
 /// <summary>
 /// Open image for read
 /// </summary>
 void CR2Reader::open()
 {
-    m_file.open(m_fileName, ifstream::binary);
-    if (m_file.is_open() == true) {
+    if (m_useMapping == true && m_map.open(m_fileName) == true)
+    {
+        m_input.rdbuf(&m_map); // Parse straight from the mapping
+    }
+    else
+    {
+        m_file.open(m_fileName, ifstream::binary);
+        if (m_file.is_open() == false)
+        {
+            throw IOException(CR2Reader::kModuleName,
+                m_fileName, "Input raw file could not be opened.");
+        }
         // Setup the read buffer
         m_file.rdbuf()->pubsetbuf(// Set file reader buffer
             m_readBuffer.get(), CR2Reader::kReadBufferLen);
-
-        // Read raw format TIFF structure
-        TiffHeader th; readTiffHeader(th);
-        RawHeader cr2; readRawHeader(cr2);
-        readIFDstructure(th); // Reads the IFD structure
-        checkIntegrity(cr2);  // Links, tag len, ...
+        m_input.rdbuf(m_file.rdbuf());
     }
-    else throw IOException(CR2Reader::kModuleName,
-        m_fileName, "Input raw file could not be opened.");
+
+    // Read raw format TIFF structure
+    TiffHeader th; readTiffHeader(th);
+    RawHeader cr2; readRawHeader(cr2);
+    readIFDstructure(th); // Reads the IFD structure
+    checkIntegrity(cr2);  // Links, tag len, ...
     return;
 }
 
@@ -85,8 +151,8 @@ void CR2Reader::open()
 void CR2Reader::readTiffHeader(TiffHeader& th)
 {
     char header[8]; // Header buffer
-    m_file.read(header, sizeof(header));
-    if (m_file.good() == false)
+    m_input.read(header, sizeof(header));
+    if (m_input.good() == false)
     {
         throw IOException(CR2Reader::kModuleName,
             m_fileName, "Failed to read the TIFF header.");
@@ -120,8 +186,8 @@ void CR2Reader::readTiffHeader(TiffHeader& th)
 void CR2Reader::readRawHeader(RawHeader& cr2h)
 {
     char header[8];
-    m_file.read(header, sizeof(header));
-    if (m_file.good() == false)
+    m_input.read(header, sizeof(header));
+    if (m_input.good() == false)
     {
         throw IOException(CR2Reader::kModuleName,
             m_fileName, "Failed to read the CR2 header.");
@@ -154,15 +220,15 @@ void CR2Reader::readIFDstructure(const TiffHeader& th)
     uint32_t offset = th.firstIFDoffset;
     while (offset != 0)
     {
-        m_file.seekg(offset, ifstream::beg);
-        if (m_file.good() == false)
+        m_input.seekg(offset, ifstream::beg);
+        if (m_input.good() == false)
         {
             throw IOException(CR2Reader::kModuleName, m_fileName,
                 "Seek to the next IFD failed. Maybe wrong offset value.");
         }
         m_dirs.push_back(TiffDir(offset));
         m_actDir++; // Set next directory
-        offset = m_dirs[m_actDir].read(m_file);
+        offset = m_dirs[m_actDir].read(m_input);
     }
     return;
 }
@@ -195,6 +261,17 @@ void CR2Reader::checkIntegrity(RawHeader& cr2h) const
 /// </summary>
 /// <param name="img"></param>
 void CR2Reader::read(Array2D<uint16_t>& img)
+{
+    ArraySink sink(img);
+    read(sink);
+    return;
+}
+
+/// <summary>
+/// Read RAW image data from the file
+/// </summary>
+/// <param name="sink">Receiver of the unsliced image data</param>
+void CR2Reader::read(RawSink& sink)
 {
     // Seek to the image data begin
     seekToImageData();
@@ -209,17 +286,17 @@ void CR2Reader::read(Array2D<uint16_t>& img)
     SOSHeader sos; // Start of Scan Header
     readSOSheader(sos, sof3);
 
-    int slices[3]; // Slice info
-    loadSlicingInfo(slices);
+    loadSlicingInfo(m_slices); // Slice info
 
     // Image data
     int height = sof3.lines;
-    const int width = slices[0] * slices[1] + slices[2];
-    modelCorrect(width, height, slices); // Model correctures
-    img = Array2D<uint16_t>(width, height); // Allocate new image
+    const int width = m_slices[0] * m_slices[1] + m_slices[2];
+    modelCorrect(width, height, m_slices); // Model correctures
+    m_rawHeight = height;
+    sink.allocate(width, height); // Allocate new image
 
     // Read RAW image data
-    readRawImage(img, slices, dht, sof3, sos);
+    readRawImage(sink, dht, sof3, sos);
     readMarker("EndOfImage", 0xd9); // Match end of image marker
     return;
 }
@@ -230,7 +307,7 @@ void CR2Reader::read(Array2D<uint16_t>& img)
 void CR2Reader::seekToImageData()
 {
     // If the file is closed
-    if (m_file.is_open() == false)
+    if (m_input.rdbuf() == nullptr)
     {
         throw IOException(CR2Reader::kModuleName,
             m_fileName, "Can't read data as the file is not open.");
@@ -241,8 +318,8 @@ void CR2Reader::seekToImageData()
     m_dirs[3].getTag(TiffTag::ID::StripOffsets, stripOffset);
 
     // Goto the image data start
-    m_file.seekg(stripOffset, ifstream::beg);
-    if (m_file.good() == false)
+    m_input.seekg(stripOffset, ifstream::beg);
+    if (m_input.good() == false)
     {
         throw IOException(CR2Reader::kModuleName,
             m_fileName, "Seek to the image data section failed");
@@ -256,8 +333,8 @@ void CR2Reader::seekToImageData()
 void CR2Reader::readMarker(const char* name, unsigned char code)
 {
     unsigned char marker[2];
-    m_file.read(reinterpret_cast<char*>(marker), 2);
-    if (m_file.good() == false)
+    m_input.read(reinterpret_cast<char*>(marker), 2);
+    if (m_input.good() == false)
     {
         stringstream ss;
         ss << "Failed to read '" << name << "' marker.";
@@ -283,8 +360,8 @@ void CR2Reader::readDHTheader(DHTHeader& hdr)
 
     // Read len of DHT
     uint16_t len; // Lenght of the header
-    m_file.read(reinterpret_cast<char*>(&len), sizeof(len));
-    if (m_file.good() == false)
+    m_input.read(reinterpret_cast<char*>(&len), sizeof(len));
+    if (m_input.good() == false)
     {
         throw IOException(CR2Reader::kModuleName,
             m_fileName, "Failed to read DHT header lenght.");
@@ -300,8 +377,8 @@ void CR2Reader::readDHTheader(DHTHeader& hdr)
 
     // Load header
     unique_ptr<char[]> header = make_unique<char[]>(len);
-    m_file.read(header.get(), len);
-    if (m_file.good() == false)
+    m_input.read(header.get(), len);
+    if (m_input.good() == false)
     {
         throw IOException(CR2Reader::kModuleName,
             m_fileName, "Failed to read DHT data.");
@@ -350,7 +427,20 @@ int CR2Reader::makeHuffmanTree(DHTHeader& hdr, char* base)
         throw FormatException(CR2Reader::kModuleName,
             m_fileName, "Corrupted huffman table detected.");
     }
-    hdr.huff[tindex](hinfo, hinfo + 16); // Build huffman tree
+    if (HuffTable::isPrefixCode(hinfo) == false)
+    {
+        throw FormatException(CR2Reader::kModuleName,
+            m_fileName, "Oversubscribed huffman table detected.");
+    }
+    for (i = 0; i < keywordCount; i++)
+    {
+        if (hinfo[16 + i] > 16) // Max. difference length
+        {
+            throw FormatException(CR2Reader::kModuleName,
+                m_fileName, "Corrupted huffman table detected.");
+        }
+    }
+    hdr.huff[tindex](hinfo, hinfo + 16); // Build huffman table
     return keywordCount;
 }
 
@@ -363,7 +453,7 @@ void CR2Reader::readSOF3header(SOF3Header& hdr)
     readMarker("StartOfFrame3", 0xc3);
 
     uint16_t len; // Read header len
-    m_file.read(reinterpret_cast<char*>(&len), sizeof(len));
+    m_input.read(reinterpret_cast<char*>(&len), sizeof(len));
     len = Utils::byteSwapU16(len);
     if (len != 14 && len != 20)
     {
@@ -373,8 +463,8 @@ void CR2Reader::readSOF3header(SOF3Header& hdr)
 
     // Load header
     unique_ptr<char[]> header = make_unique<char[]>(len);
-    m_file.read(header.get(), len - 2);
-    if (m_file.good() == false) {
+    m_input.read(header.get(), len - 2);
+    if (m_input.good() == false) {
         throw IOException(CR2Reader::kModuleName,
             m_fileName, "Failed to read SOF3 header data.");
     }
@@ -419,7 +509,7 @@ void CR2Reader::readSOSheader(SOSHeader& hdr, const SOF3Header& sof3)
     readMarker("StartOfScan", 0xda);
 
     uint16_t len; // Read SOS header len
-    m_file.read(reinterpret_cast<char*>(&len), sizeof(len));
+    m_input.read(reinterpret_cast<char*>(&len), sizeof(len));
     len = Utils::byteSwapU16(len);
     if (len != 14 && len != 10)
     {
@@ -429,8 +519,8 @@ void CR2Reader::readSOSheader(SOSHeader& hdr, const SOF3Header& sof3)
 
     // Read data
     unique_ptr<char[]> header = make_unique<char[]>(len);
-    m_file.read(header.get(), len - 2);
-    if (m_file.good() == false) {
+    m_input.read(header.get(), len - 2);
+    if (m_input.good() == false) {
         throw IOException(CR2Reader::kModuleName,
             m_fileName, "Failed to read SOS header data.");
     }
@@ -516,248 +606,649 @@ void CR2Reader::modelCorrect(
 /// <summary>
 /// Read and decompress RAW image data values
 /// </summary>
-/// <param name="img">Image for storing the resulting data</param>
-/// <param name="slices">Information about data slicing</param>
+/// <param name="sink">Receiver of the unsliced image data</param>
 /// <param name="dht">Huffman tables header</param>
 /// <param name="sof3">Start of frame header</param>
 /// <param name="sos">Start of scan header</param>
-void CR2Reader::readRawImage(Array2D<uint16_t>& img, const int (&slices)[3],
+/// <remarks>
+/// Decoded lines are stored straight to their unsliced position,
+/// so there is no intermediate image of the whole scan.
+/// </remarks>
+void CR2Reader::readRawImage(RawSink& sink,
     const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos)
 {
-    Array2D<uint16_t> dimg(sof3.samples * sof3.components, sof3.lines + 1);
-    const uint16_t pval = 1 << (sof3.samplePrec - 1);
+    if (m_map.isOpen() == false)
+    {
+        BitReader bits(m_input);
+        decodeImage(bits, sink, dht, sof3, sos, nullptr);
+    }
+    else if (m_useIndex == false)
+    {
+        if (decodeSpeculative(sink, dht, sof3, sos) == false)
+        {
+            // Bits straight from the mapping
+            BitReader bits(m_input, m_map.data(), m_map.size());
+            decodeImage(bits, sink, dht, sof3, sos, nullptr);
+        }
+    }
+    else readIndexed(sink, dht, sof3, sos);
+    return;
+}
 
-    if (sof3.components == 4) // Most common case
+/// <summary>
+/// Read image data with help of the decode index
+/// </summary>
+/// <param name="sink">Receiver of the unsliced image data</param>
+/// <param name="dht">Huffman tables header</param>
+/// <param name="sof3">Start of frame header</param>
+/// <param name="sos">Start of scan header</param>
+/// <remarks>
+/// With a valid sidecar index the scan is decoded in parallel.
+/// Otherwise it is decoded serially and the index is created.
+/// </remarks>
+void CR2Reader::readIndexed(RawSink& sink,
+    const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos)
+{
+    const string indexName = m_fileName + DecodeIndex::kExtension;
+    error_code ec; // Zero time if not available
+    const auto fileTime = filesystem::last_write_time(m_fileName, ec);
+
+    DecodeIndex::Key key;
+    key.fileSize = m_map.size();
+    key.fileTime = static_cast<uint64_t>(
+        ec ? 0 : fileTime.time_since_epoch().count());
+    key.scanStart = static_cast<uint64_t>(streamoff(m_input.tellg()));
+    key.lines = sof3.lines;
+    key.samples = sof3.samples;
+    key.components = sof3.components;
+
+    DecodeIndex index(key);
+    if (index.load(indexName) == true
+        && decodeParallel(index, sink, dht, sof3, sos) == true)
     {
-        dimg[0][0] = pval;
-        dimg[0][1] = pval;
-        dimg[0][2] = pval;
-        dimg[0][3] = pval;
-        decode4(dimg, dht, sof3, sos); // Create image
-        unslice(img, dimg, slices);
+        return; // Indexed decode succeeded
     }
+
+    // Serial decode with index creation
+    index.clear();
+    m_input.clear();
+    m_input.seekg(static_cast<streamoff>(key.scanStart), istream::beg);
+    BitReader bits(m_input, m_map.data(), m_map.size());
+    decodeImage(bits, sink, dht, sof3, sos, &index);
+    index.save(indexName); // Index is optional, so ignore failures
+    return;
+}
+
+/// <summary>
+/// Decode the entropy coded data
+/// </summary>
+/// <param name="bits">Entropy coded data reader</param>
+/// <param name="sink">Receiver of the unsliced image data</param>
+/// <param name="dht">Huffman tables header</param>
+/// <param name="sof3">Start of frame header</param>
+/// <param name="sos">Start of scan header</param>
+/// <param name="index">Index to be filled (optional)</param>
+void CR2Reader::decodeImage(BitReader& bits, RawSink& sink,
+    const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos,
+    DecodeIndex* index)
+{
+    const int pval = 1 << (sof3.samplePrec - 1);
+    int prev[4] = {pval, pval, pval, pval};
+
+    if (sof3.components == 4) // Most common case
+        decode4(bits, sink, dht, sof3, sos, 0, sof3.lines, prev, index);
     else // Generic case
+        decode(bits, sink, dht, sof3, sos, 0, sof3.lines, prev, index);
+    if (bits.overrun() == true)
     {
-        for (int c = 0; c < sof3.components; c++)
-            dimg[0][c] = pval;
-        decode(dimg, dht, sof3, sos); // Create image
-        unslice(img, dimg, slices);
+        throw FormatException(CR2Reader::kModuleName, m_fileName,
+            "Unexpected end of the raw image data.");
     }
+    bits.finish(); // Stream back to the end marker
     return;
 }
 
 /// <summary>
-/// Decode image data stored in RAW
+/// Decode the entropy coded data in parallel by the index
 /// </summary>
-/// <param name="dimg">Decoded image before unslicing</param>
+/// <param name="index">Restart points of the data</param>
+/// <param name="sink">Receiver of the unsliced image data</param>
 /// <param name="dht">Huffman tables header</param>
 /// <param name="sof3">Start of frame header</param>
 /// <param name="sos">Start of scan header</param>
-inline void CR2Reader::decode(Array2D<uint16_t> &dimg,
-    const DHTHeader &dht, const SOF3Header &sof3, const SOSHeader &sos)
+/// <returns>False if the data don't match the index</returns>
+/// <remarks>
+/// Each part must end exactly at the next restart point with
+/// the recorded predictor values, else the index is stale.
+/// </remarks>
+bool CR2Reader::decodeParallel(const DecodeIndex& index, RawSink& sink,
+    const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos)
 {
-    int prev[4];
+    const int count = index.getCount();
+    int failures = 0;
 
-    for (int line = 1; line <= sof3.lines; line++)
+    #pragma omp parallel for schedule(dynamic) reduction(+ : failures)
+    for (int part = 0; part < count; part++)
     {
-        // Restar prev value for next line decoding
-        for (int c = 0; c < sof3.components; c++)
-        {
-            prev[c] = dimg[line - 1][c];
-        }
-        // Decode next line
-        for (int col = 0; col < sof3.samples; col++)
-        {
-            for (int c = 0; c < sof3.components; c++)
+        const DecodeIndex::Entry& start = index[part];
+        const int firstLine = part * DecodeIndex::kLineStep;
+        const int endLine =
+            std::min(firstLine + DecodeIndex::kLineStep, int(sof3.lines));
+        int prev[4] = {start.prev[0], start.prev[1],
+            start.prev[2], start.prev[3]};
+
+        try {
+            BitReader bits(m_input, m_map.data(), m_map.size(), start.bitPos);
+            if (sof3.components == 4)
+                decode4(bits, sink, dht, sof3, sos,
+                    firstLine, endLine, prev, nullptr);
+            else decode(bits, sink, dht, sof3, sos,
+                    firstLine, endLine, prev, nullptr);
+
+            if (part + 1 < count) // Check the next restart point
             {
-                const HuffTree &ht = dht.huff[sos.tableSel[c][0]];
-                prev[c] += decodeDiffValue(ht);
-                dimg[line][sof3.components * col + c] = static_cast<uint16_t>(prev[c]);
+                const DecodeIndex::Entry& next = index[part + 1];
+                bool match = bits.bitPosition() == next.bitPos;
+                for (int c = 0; c < sof3.components; c++)
+                    match = match && prev[c] == next.prev[c];
+                failures += match ? 0 : 1;
             }
+            else if (bits.overrun() == false)
+                bits.finish(); // Stream back to the end marker
+            else failures++;
+        }
+        catch (const Exception&) {
+            failures++; // Bad data for the part
         }
     }
-    return;
+    return failures == 0;
 }
 
 /// <summary>
-/// Decode image data stored in RAW special for most common config
-/// with 4 value components.
+/// Decode the entropy coded data speculatively in parallel
 /// </summary>
-/// <param name="dimg">Decoded image before unslicing</param>
+/// <param name="sink">Receiver of the unsliced image data</param>
 /// <param name="dht">Huffman tables header</param>
 /// <param name="sof3">Start of frame header</param>
 /// <param name="sos">Start of scan header</param>
-inline void CR2Reader::decode4(Array2D<uint16_t>& dimg,
+/// <returns>False if the data are too small for parallel decoding</returns>
+/// <remarks>
+/// The scan is split into parts at evenly spaced byte offsets. Decoding
+/// from a guessed offset produces garbage at first, but the Huffman
+/// codes synchronise themselves after a few symbols. The parts are
+/// then linked at the first symbol position, which both neighbours
+/// decoded with the same component. A part without such a position is
+/// decoded again from the end of the previous one.
+/// </remarks>
+bool CR2Reader::decodeSpeculative(RawSink& sink,
     const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos)
 {
-    const int samples4 = 4 * sof3.samples;
-    uint16_t* p = dimg[0]; // Previous line
-
-    for (int line = 1; line <= sof3.lines; line++)
+    const uint8_t* data = m_map.data();
+    const uint64_t scanStart =
+        static_cast<uint64_t>(streamoff(m_input.tellg()));
+    uint64_t scanEnd = m_map.size();
+    uint32_t stripOffset, stripBytes; // Scan limited by the strip
+    if (m_dirs[3].getTag(TiffTag::ID::StripOffsets, stripOffset)
+        && m_dirs[3].getTag(TiffTag::ID::StripByteCounts, stripBytes))
     {
-        // Restart prev value for next line decoding
-        int prev[4] = {p[0], p[1], p[2], p[3]};
+        scanEnd = std::min<uint64_t>(
+            scanEnd, uint64_t(stripOffset) + stripBytes);
+    }
+    if (scanEnd <= scanStart)
+        return false;
+
+    const uint64_t scanLen = scanEnd - scanStart;
+    const int count = static_cast<int>(std::min<uint64_t>(
+        omp_get_max_threads(), scanLen / CR2Reader::kSpecPartLen));
+    if (count < 2)
+        return false;
+
+    // Split the data evenly (never behind a 0xff byte)
+    const int comps = sof3.components;
+    const uint64_t symbols =
+        uint64_t(sof3.lines) * sof3.samples * sof3.components;
+    vector<SpecPart> parts(count);
+    for (int i = 0; i < count; i++)
+    {
+        uint64_t start = scanStart + scanLen * i / count;
+        while (i > 0 && data[start - 1] == 0xff)
+            start++;
+        parts[i].startBit = start << 3;
+        parts[i].startPhase = 0;
+        parts[i].guessed = i > 0;
+        parts[i].diffs.reserve(symbols / count + symbols / (4 * count));
+    }
+    for (int i = 0; i < count; i++)
+    {
+        parts[i].endBit = (i + 1 < count)
+            ? parts[i + 1].startBit : numeric_limits<uint64_t>::max();
+    }
 
-        // Decode next line
-        for (int col = 0; col < samples4; col += 4)
+    #pragma omp parallel for schedule(static, 1)
+    for (int i = 0; i < count; i++)
+        decodeSpecPart(parts[i], dht, sos, comps);
+
+    // Link the parts in the data order
+    parts[0].first = 0;
+    parts[0].global = 0;
+    int used = 0;
+    for (int i = 0; used == 0; i++)
+    {
+        SpecPart& part = parts[i];
+        SpecPart& next = parts[std::min(i + 1, count - 1)];
+        if (part.ended == true || i + 1 == count)
+        {
+            part.last = part.diffs.size();
+            used = i + 1; // Real end of the data
+        }
+        else if (linkSpecParts(part, next, sos, comps, part.last, next.first)
+            && part.last >= part.first)
+        {
+            next.global = part.global + part.last - part.first;
+        }
+        else
         {
-            // Make prev to next cycle
-            p = dimg[line];
+            // Serial decode of the next part
+            part.last = part.diffs.size();
+            next.global = part.global + part.last - part.first;
+            next.startBit = part.stopBit;
+            next.startPhase = static_cast<int>(next.global % comps);
+            next.guessed = false;
+            decodeSpecPart(next, dht, sos, comps);
+            next.first = 0;
+        }
+    }
+    const SpecPart& end = parts[used - 1];
+    if (end.global + end.last - end.first < symbols)
+    {
+        throw FormatException(CR2Reader::kModuleName, m_fileName,
+            end.badCode ? "Bad huffman code prefix in the data section."
+            : "Unexpected end of the raw image data.");
+    }
+    storeSpecParts(sink, parts, used, sof3);
+
+    // Stream back to the end marker
+    BitReader bits(m_input, data, m_map.size(), end.stopBit);
+    while (bits.overrun() == false)
+        bits.get(BitReader::kMaxBits);
+    bits.finish();
+    return true;
+}
 
-            // Build up prev vector
-            prev[0] += decodeDiffValue(dht.huff[sos.tableSel[0][0]]);
-            prev[1] += decodeDiffValue(dht.huff[sos.tableSel[1][0]]);
-            prev[2] += decodeDiffValue(dht.huff[sos.tableSel[2][0]]);
-            prev[3] += decodeDiffValue(dht.huff[sos.tableSel[3][0]]);
+/// <summary>
+/// Decode difference values of one speculative part
+/// </summary>
+/// <param name="part">Part with the start position and phase set</param>
+/// <param name="dht">Huffman tables header</param>
+/// <param name="sos">Start of scan header</param>
+/// <param name="comps">Number of components</param>
+/// <remarks>
+/// The part is decoded up to its nominal end and a few symbols more
+/// for the link to the next part. Symbol positions are recorded only
+/// at the part bounds, as obtaining a position is not cheap. Bad codes
+/// before the synchronisation of a guessed start are skipped bit by
+/// bit, otherwise they end the part like the end of the data.
+/// </remarks>
+void CR2Reader::decodeSpecPart(SpecPart& part,
+    const DHTHeader& dht, const SOSHeader& sos, int comps)
+{
+    const HuffTable* tables[4];
+    for (int c = 0; c < comps; c++)
+        tables[c] = &dht.huff[sos.tableSel[c][0]];
+
+    part.diffs.clear();
+    part.head.clear();
+    part.tail.clear();
+    part.syncFirst = 0;
+    part.badCode = false;
+
+    BitReader bits(m_input, m_map.data(), m_map.size(), part.startBit);
+    int c = part.startPhase;
+    auto next = [&]() {
+        try {
+            const int diff = decodeDiffValue(bits, *tables[c]);
+            if (bits.overrun() == true)
+                return false; // Data end reached
+            part.diffs.push_back(static_cast<uint16_t>(diff));
+        }
+        catch (const FormatException&) {
+            part.badCode = true;
+            return false;
+        }
+        c = (c + 1 < comps) ? c + 1 : 0;
+        return true;
+    };
 
-            // Store image value
-            p[col] = static_cast<uint16_t>(prev[0]);
-            p[col + 1] = static_cast<uint16_t>(prev[1]);
-            p[col + 2] = static_cast<uint16_t>(prev[2]);
-            p[col + 3] = static_cast<uint16_t>(prev[3]);
+    bool more = true;
+    while (more == true && part.head.size() < CR2Reader::kSyncSymbols)
+    {
+        const uint64_t pos = bits.bitPosition();
+        more = next();
+        if (more == true)
+            part.head.push_back(pos);
+        else if (part.badCode == true && part.guessed == true)
+        {
+            // Not synchronised yet, so try the next bit
+            bits.consume(1);
+            part.syncFirst = part.diffs.size();
+            part.badCode = false;
+            more = true;
         }
     }
+    while (more == true && bits.bitPosition() < part.endBit)
+    {
+        for (int k = 0; more == true && k < CR2Reader::kCheckSymbols; k++)
+            more = next();
+    }
+    part.tailFirst = part.diffs.size();
+    while (more == true && part.tail.size() < CR2Reader::kSyncSymbols)
+    {
+        part.tail.push_back(bits.bitPosition());
+        more = next();
+    }
+
+    part.ended = !more;
+    part.stopBit = bits.bitPosition();
     return;
 }
 
 /// <summary>
-/// Unslicing decoded image data
+/// Find the first symbol shared by two neighbouring parts
 /// </summary>
-/// <param name="img">Final output image to be filled</param>
-/// <param name="dimg">Decode image values</param>
-/// <param name="slices">Information about slicing</param>
-inline void CR2Reader::unslice(Array2D<uint16_t> &img,
-    const Array2D<uint16_t> &ximg, const int(&slices)[3])
+/// <param name="part">Part with the valid tail</param>
+/// <param name="next">Next part decoded from the guessed start</param>
+/// <param name="sos">Start of scan header</param>
+/// <param name="comps">Number of components</param>
+/// <param name="last">End symbol index of the valid part</param>
+/// <param name="first">First valid symbol index of the next part</param>
+/// <returns>True if the parts are synchronised</returns>
+/// <remarks>
+/// Decoding from the same position with the same sequence of tables
+/// gives the same symbols, so the next part is valid from there on.
+/// Its components may still be shifted, if the table selectors repeat,
+/// but the differences are stored by the symbol index anyway.
+/// </remarks>
+bool CR2Reader::linkSpecParts(const SpecPart& part, const SpecPart& next,
+    const SOSHeader& sos, int comps, size_t& last, size_t& first) const
 {
-    const int height = img.getHeight(), sliceCount = slices[0];
-    const uint16_t *p = ximg[1];
-
-    for (int slice = 0, colBase = 0; slice <= sliceCount; slice++)
+    size_t k = 0, j = next.syncFirst;
+    while (k < part.tail.size() && j < next.head.size())
     {
-        const int sliceWith = (slice >= sliceCount) ? slices[2] : slices[1];
-        const int endCol = colBase + sliceWith;
+        if (part.tail[k] < next.head[j])
+        {
+            k++; continue;
+        }
+        else if (part.tail[k] > next.head[j])
+        {
+            j++; continue;
+        }
 
-        for (int row = 0; row < height; row++)
+        // Same position, so compare the tables
+        const size_t p = part.startPhase + part.tailFirst + k;
+        const size_t q = next.startPhase + j;
+        bool same = true;
+        for (int c = 0; c < comps; c++)
         {
-            for (int col = colBase; col < endCol; col++)
-            {
-                img[row][col] = *p++;
-            }
+            same = same && sos.tableSel[(p + c) % comps][0]
+                == sos.tableSel[(q + c) % comps][0];
+        }
+        if (same == true)
+        {
+            last = part.tailFirst + k;
+            first = j;
+            return true;
         }
-        colBase += sliceWith;
+        k++; j++;
     }
-    return;
+    return false;
 }
 
 /// <summary>
-/// Decode one difference value
+/// Turn the linked differences into sample values and store them
 /// </summary>
-/// <param name="htree">Component associated huffman tree</param>
-/// <returns>Decoded difference value</returns>
-int CR2Reader::decodeDiffValue(const HuffTree& htree)
+/// <param name="sink">Receiver of the unsliced image data</param>
+/// <param name="parts">Linked speculative parts</param>
+/// <param name="used">Number of parts up to the data end</param>
+/// <param name="sof3">Start of frame header</param>
+/// <remarks>
+/// Only the line starts depend on the previous line, so they are
+/// done serially and the rest of the lines in parallel. Values wrap
+/// at 16 bits like the stored values of the serial decode.
+/// </remarks>
+void CR2Reader::storeSpecParts(RawSink& sink,
+    const vector<SpecPart>& parts, int used, const SOF3Header& sof3)
 {
-    HuffTree::iterator hi = htree.begin();
-    int len = 0, diff = 0;
+    const int comps = sof3.components;
+    const int rowLen = sof3.samples * comps;
+
+    // Copy differences of the image symbols [pos, pos + len)
+    auto gather = [&](uint64_t pos, int len, uint16_t* out) {
+        auto it = upper_bound(parts.begin(), parts.begin() + used, pos,
+            [](uint64_t x, const SpecPart& part) { return x < part.global; });
+        for (--it; len > 0; ++it)
+        {
+            const size_t offset = it->first + (pos - it->global);
+            const int run = static_cast<int>(
+                std::min<uint64_t>(len, it->last - offset));
+            copy_n(it->diffs.begin() + offset, run, out);
+            out += run; pos += run; len -= run;
+        }
+    };
 
-    // Traverse huffman tree
-    while (hi != HuffTree::end && hi.leaf(len) == false)
+    // Line start values
+    const uint16_t pval = static_cast<uint16_t>(1 << (sof3.samplePrec - 1));
+    uint16_t prev[4] = {pval, pval, pval, pval};
+    vector<uint16_t> starts(size_t(sof3.lines) * comps);
+    for (int line = 0; line < sof3.lines; line++)
     {
-        const int x = getbit();
-        hi.next(x);
+        uint16_t diff[4];
+        gather(uint64_t(line) * rowLen, comps, diff);
+        for (int c = 0; c < comps; c++)
+        {
+            prev[c] = static_cast<uint16_t>(prev[c] + diff[c]);
+            starts[size_t(line) * comps + c] = prev[c];
+        }
     }
-    if (hi != HuffTree::end)
+
+    #pragma omp parallel
     {
-        if (len > 0) // Calculate difference codes
+        vector<uint16_t> buffer(rowLen); // Decoded line
+        uint16_t* p = buffer.data();
+
+        #pragma omp for
+        for (int line = 0; line < sof3.lines; line++)
         {
-            diff = getbits(len);
-            if ((1 << (len - 1)) > diff)
-                diff -= (1 << len) - 1;
+            gather(uint64_t(line) * rowLen, rowLen, p);
+            for (int c = 0; c < comps; c++)
+                p[c] = starts[size_t(line) * comps + c];
+            for (int col = comps; col < rowLen; col++)
+                p[col] = static_cast<uint16_t>(p[col] + p[col - comps]);
+            storeLine(sink, line, p, rowLen);
         }
-        return diff;
     }
-    throw FormatException(CR2Reader::kModuleName, m_fileName,
-        "Bad huffman code prefix in the data section.");
+    return;
 }
 
 /// <summary>
-/// Masking of bit at position (index)
+/// Decode image lines stored in RAW
 /// </summary>
-const uint8_t CR2Reader::kBitMasks[] = {
-    0, 1, 2, 4, 8, 16, 32, 64, 128
-};
+/// <param name="bits">Entropy coded data reader</param>
+/// <param name="sink">Receiver of the unsliced image data</param>
+/// <param name="dht">Huffman tables header</param>
+/// <param name="sof3">Start of frame header</param>
+/// <param name="sos">Start of scan header</param>
+/// <param name="firstLine">First line to be decoded</param>
+/// <param name="endLine">Line after the last decoded line</param>
+/// <param name="prev">Predictor values at the first line start,
+/// on return for the line after the last one</param>
+/// <param name="index">Index to be filled (optional)</param>
+inline void CR2Reader::decode(BitReader& bits, RawSink& sink,
+    const DHTHeader &dht, const SOF3Header &sof3, const SOSHeader &sos,
+    int firstLine, int endLine, int (&prev)[4], DecodeIndex* index)
+{
+    const int rowLen = sof3.samples * sof3.components;
+    vector<uint16_t> buffer(rowLen); // Decoded line
+    uint16_t* p = buffer.data();
+
+    for (int line = firstLine; line < endLine; line++)
+    {
+        // Restar prev value for next line decoding
+        if (line > firstLine)
+        {
+            for (int c = 0; c < sof3.components; c++)
+                prev[c] = p[c];
+        }
+        if (index != nullptr && DecodeIndex::isRestartLine(line))
+            index->add(bits.bitPosition(), prev);
+
+        // Decode next line
+        for (int col = 0; col < sof3.samples; col++)
+        {
+            for (int c = 0; c < sof3.components; c++)
+            {
+                const HuffTable &ht = dht.huff[sos.tableSel[c][0]];
+                prev[c] += decodeDiffValue(bits, ht);
+                p[sof3.components * col + c] = static_cast<uint16_t>(prev[c]);
+            }
+        }
+        storeLine(sink, line, p, rowLen);
+    }
+
+    // Predictors for the next line
+    for (int c = 0; c < sof3.components && endLine > firstLine; c++)
+        prev[c] = p[c];
+    return;
+}
 
 /// <summary>
-/// Get single bit from the stream
+/// Decode image lines stored in RAW special for most common config
+/// with 4 value components.
 /// </summary>
-/// <returns>Zero for 0. Otherwise nonzero for 1.</returns>
-int CR2Reader::getbit()
+/// <param name="bits">Entropy coded data reader</param>
+/// <param name="sink">Receiver of the unsliced image data</param>
+/// <param name="dht">Huffman tables header</param>
+/// <param name="sof3">Start of frame header</param>
+/// <param name="sos">Start of scan header</param>
+/// <param name="firstLine">First line to be decoded</param>
+/// <param name="endLine">Line after the last decoded line</param>
+/// <param name="prev">Predictor values at the first line start,
+/// on return for the line after the last one</param>
+/// <param name="index">Index to be filled (optional)</param>
+inline void CR2Reader::decode4(BitReader& bits, RawSink& sink,
+    const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos,
+    int firstLine, int endLine, int (&prev)[4], DecodeIndex* index)
 {
-    if (m_availBits <= 0)
-        loadNextByte(); // Load new 8bits
-    const int val = m_bitbuff & CR2Reader::kBitMasks[m_availBits];
-    m_availBits--; // Move selector to next bit
-    return val;
+    const int samples4 = 4 * sof3.samples;
+    vector<uint16_t> buffer(samples4); // Decoded line
+    uint16_t* p = buffer.data();
+
+    for (int line = firstLine; line < endLine; line++)
+    {
+        // Restart prev value for next line decoding
+        if (line > firstLine)
+        {
+            prev[0] = p[0];
+            prev[1] = p[1];
+            prev[2] = p[2];
+            prev[3] = p[3];
+        }
+        if (index != nullptr && DecodeIndex::isRestartLine(line))
+            index->add(bits.bitPosition(), prev);
+
+        // Decode next line
+        for (int col = 0; col < samples4; col += 4)
+        {
+            // Build up prev vector
+            prev[0] += decodeDiffValue(bits, dht.huff[sos.tableSel[0][0]]);
+            prev[1] += decodeDiffValue(bits, dht.huff[sos.tableSel[1][0]]);
+            prev[2] += decodeDiffValue(bits, dht.huff[sos.tableSel[2][0]]);
+            prev[3] += decodeDiffValue(bits, dht.huff[sos.tableSel[3][0]]);
+
+            // Store image value
+            p[col] = static_cast<uint16_t>(prev[0]);
+            p[col + 1] = static_cast<uint16_t>(prev[1]);
+            p[col + 2] = static_cast<uint16_t>(prev[2]);
+            p[col + 3] = static_cast<uint16_t>(prev[3]);
+        }
+        storeLine(sink, line, p, samples4);
+    }
+
+    // Predictors for the next line
+    if (endLine > firstLine)
+    {
+        prev[0] = p[0];
+        prev[1] = p[1];
+        prev[2] = p[2];
+        prev[3] = p[3];
+    }
+    return;
 }
 
 /// <summary>
-/// Get requested number of bits from the stream
+/// Store a decoded line at its unsliced position
 /// </summary>
-/// <param name="bits">Number of bits to be extracted</param>
-/// <returns>Zero for 0. Otherwise nonzero for 1.</returns>
+/// <param name="sink">Receiver of the unsliced image data</param>
+/// <param name="line">Decoded line number</param>
+/// <param name="data">Decoded line values</param>
+/// <param name="len">Number of values in the line</param>
 /// <remarks>
-/// Fastest variant when collecting data bitwise.
-/// Other methods (dcraw, raw therapee, ..) working with
-/// more bytes are slower than this. Every change make
-/// the code slower. Maybe own buffering and reader could
-/// work, but I havent tested it yet. Maybe in the future!
+/// The slices are stored one after another in the decoded data,
+/// each of them row by row. So a line is split only where it
+/// crosses the slice width.
 /// </remarks>
-int CR2Reader::getbits(int bits)
+void CR2Reader::storeLine(RawSink& sink,
+    int line, const uint16_t* data, int len) const
 {
-    if (bits >= 0 && bits <= 24)
-    {
-        int val = 0;
+    const int sliceCount = m_slices[0];
+    const uint64_t sliceSize = uint64_t(m_slices[1]) * m_rawHeight;
+    uint64_t pos = uint64_t(line) * len;
 
-        while (bits > 0)
-        {
-            if (m_availBits <= 0)
-                loadNextByte();
-            for (; m_availBits > 0 && bits > 0; bits--)
-            {
-                m_availBits--; // Pop first bit
-                val = (val << 1) | ((m_bitbuff >> m_availBits) & 1);
-            }
-        }
-        return val;
+    for (int k = 0; k < len;)
+    {
+        const int slice = static_cast<int>(
+            std::min<uint64_t>(pos / sliceSize, sliceCount));
+        const int sliceWidth =
+            (slice >= sliceCount) ? m_slices[2] : m_slices[1];
+        const uint64_t offset = pos - slice * sliceSize;
+        const int row = static_cast<int>(offset / sliceWidth);
+        const int col = static_cast<int>(offset % sliceWidth);
+        if (row >= m_rawHeight)
+            break; // Data behind the image
+
+        const int run = std::min(sliceWidth - col, len - k);
+        sink.store(row, slice * m_slices[1] + col, data + k, run);
+        k += run; pos += run;
     }
-    else throw FormatException(CR2Reader::kModuleName,
-        m_fileName, "Too many or few bits for extraction.");
+    return;
 }
 
 /// <summary>
-/// Load next byte, 8bits, from the input stream
+/// Decode one difference value
 /// </summary>
-void CR2Reader::loadNextByte()
+/// <param name="bits">Entropy coded data reader</param>
+/// <param name="table">Component associated huffman table</param>
+/// <returns>Decoded difference value</returns>
+/// <remarks>
+/// Most codes are resolved with a single table probe including
+/// the difference bits. Only long codes take the slower path.
+/// </remarks>
+inline int CR2Reader::decodeDiffValue(BitReader& bits, const HuffTable& table)
 {
-    m_bitbuff = m_file.get();
-    if (m_file.good() == true)
+    const HuffTable::Entry entry =
+        table.lookup(bits.peek(HuffTable::kLookupBits));
+    if (entry.totalLen > 0)
     {
-        if (m_bitbuff == 0xff)
-        {
-            const int n = m_file.get();
-            if (m_file.good() == false)
-            {
-                throw IOException(CR2Reader::kModuleName, m_fileName,
-                    "Failed to extract an number of image data bits.");
-            }
-            if (n != 0)
-            {
-                throw FormatException(CR2Reader::kModuleName, m_fileName,
-                    "After 0xff must follow 0x00 in the raw image data.");
-            }
-        }
-        m_availBits = 8; // We read and have 8bits
-        return;
+        bits.consume(entry.totalLen); // Code and difference resolved
+        return entry.value;
+    }
+
+    int codeLen = entry.codeLen, diffLen = entry.value;
+    if (codeLen == 0 && table.decodeLong(
+        bits.peek(HuffTable::kMaxCodeLen), codeLen, diffLen) == false)
+    {
+        throw FormatException(CR2Reader::kModuleName, m_fileName,
+            "Bad huffman code prefix in the data section.");
     }
-    throw IOException(CR2Reader::kModuleName, m_fileName,
-        "Failed to extract an number of image data bits.");
+    bits.consume(codeLen);
+    return HuffTable::extend(static_cast<int>(bits.get(diffLen)), diffLen);
 }
@@ -27,11 +27,15 @@
 
 #include "NonCopyable.hpp"
 #include "Structures/Array2D.hpp"
+#include "MappedFile.hpp"
+#include "RawSink.hpp"
 #include "TiffDir.hpp"
 
 struct TiffHeader;
 struct RawHeader;
-class HuffTree;
+class HuffTable;
+class BitReader;
+class DecodeIndex;
 
 namespace RawDevTest { class CR2ReaderTest; };
 
@@ -39,31 +43,44 @@ class CR2Reader : NonCopyable
 {
     static constexpr const char* kModuleName = "CR2Reader";
     static constexpr int kReadBufferLen = 65536; // 64kB read buffer
-    static const uint8_t kBitMasks[];
+    static constexpr uint64_t kSpecPartLen = 262144; // Min. speculative part
+    static constexpr size_t kSyncSymbols = 4096; // Symbols for part linking
+    static constexpr int kCheckSymbols = 1024; // Position check interval
 
     // File attributes
-    std::ifstream m_file;
+    std::ifstream m_file;  // Fallback if mapping fails
+    MappedFile m_map;
+    std::istream m_input;  // Parsing from the file or mapping
     std::string m_fileName;
     std::unique_ptr<char[]> m_readBuffer;
+    bool m_useMapping;
+    bool m_useIndex; // Parallel decode with sidecar index
 
     // Tiff directory structure
     std::vector<TiffDir> m_dirs;
     int m_actDir;
 
+    // Layout of the unsliced image
+    int m_slices[3];
+    int m_rawHeight;
+
 public:
-    CR2Reader(const std::string& fileName);
+    CR2Reader(const std::string& fileName, bool useMapping = true);
     friend class RawDevTest::CR2ReaderTest;
 
 public: // Public interface
     void open();
     void read(Array2D<uint16_t>& img);
+    void read(RawSink& sink);
     void close();
     bool getModel(std::string &model) const;
+    void setDecodeIndex(bool useIndex);
 
 private: // RAW format reading
     struct DHTHeader;
     struct SOF3Header;
     struct SOSHeader;
+    struct SpecPart;
 
     void readTiffHeader(TiffHeader& th);
     void readRawHeader(RawHeader& cr2h);
@@ -79,28 +96,41 @@ private: // RAW format reading
     void readMarker(const char* name, unsigned char code);
 
 private: // Raw image data reading
-    int m_bitbuff, m_availBits;
-
-    void readRawImage(Array2D<uint16_t>& img, const int(&slices)[3],
+    void readRawImage(RawSink& sink,
+        const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos);
+    void readIndexed(RawSink& sink,
+        const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos);
+    void decodeImage(BitReader& bits, RawSink& sink,
+        const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos,
+        DecodeIndex* index);
+    bool decodeParallel(const DecodeIndex& index, RawSink& sink,
         const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos);
-    void decode(Array2D<uint16_t> &dimg,
-        const DHTHeader &dht, const SOF3Header &sof3, const SOSHeader &sos);
-    void decode4(Array2D<uint16_t>& dimg,
+    bool decodeSpeculative(RawSink& sink,
         const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos);
-    void unslice(Array2D<uint16_t> &img,
-        const Array2D<uint16_t> &ximg, const int(&slices)[3]);
-    int decodeDiffValue(const HuffTree& htree);
-    int getbit();
-    int getbits(int bits);
-    void loadNextByte();
+    void decodeSpecPart(SpecPart& part,
+        const DHTHeader& dht, const SOSHeader& sos, int comps);
+    bool linkSpecParts(const SpecPart& part, const SpecPart& next,
+        const SOSHeader& sos, int comps, size_t& last, size_t& first) const;
+    void storeSpecParts(RawSink& sink,
+        const std::vector<SpecPart>& parts, int used, const SOF3Header& sof3);
+    void decode(BitReader& bits, RawSink& sink,
+        const DHTHeader &dht, const SOF3Header &sof3, const SOSHeader &sos,
+        int firstLine, int endLine, int (&prev)[4], DecodeIndex* index);
+    void decode4(BitReader& bits, RawSink& sink,
+        const DHTHeader& dht, const SOF3Header& sof3, const SOSHeader& sos,
+        int firstLine, int endLine, int (&prev)[4], DecodeIndex* index);
+    void storeLine(RawSink& sink,
+        int line, const uint16_t* data, int len) const;
+    int decodeDiffValue(BitReader& bits, const HuffTable& table);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
-inline CR2Reader::CR2Reader(const std::string& fileName)
-    : m_file(), m_fileName(fileName)   // File
+inline CR2Reader::CR2Reader(const std::string& fileName, bool useMapping)
+    : m_file(), m_map(), m_input(nullptr) // File
+    , m_fileName(fileName), m_useMapping(useMapping), m_useIndex(false)
     , m_dirs(), m_actDir(-1)           // Tiff structures
-    , m_bitbuff(0), m_availBits(0)     // Bit reader
+    , m_slices{0, 0, 0}, m_rawHeight(0)
 {
     m_readBuffer = std::make_unique<char[]>(CR2Reader::kReadBufferLen);
     return;
@@ -108,10 +138,16 @@ inline CR2Reader::CR2Reader(const std::string& fileName)
 
 inline void CR2Reader::close()
 {
+    m_input.rdbuf(nullptr);
     m_file.close();
+    m_map.close();
     m_dirs.clear(); m_actDir = -1;
-    m_bitbuff = 0;
-    m_availBits = 0;
+    return;
+}
+
+inline void CR2Reader::setDecodeIndex(bool useIndex)
+{
+    m_useIndex = useIndex;
     return;
 }
 
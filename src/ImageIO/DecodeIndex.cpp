@@ -0,0 +1,118 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DecodeIndex.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+using namespace std;
+
+namespace
+{
+/// <summary>
+/// Sidecar file header
+/// </summary>
+struct IndexHeader {
+    char magic[4];   // "RDXI"
+    uint32_t version;
+    DecodeIndex::Key key;
+    uint64_t count;  // Number of entries
+};
+
+constexpr char kMagic[4] = {'R', 'D', 'X', 'I'};
+constexpr uint32_t kVersion = 1;
+}
+
+/// <summary>
+/// Load index from the sidecar file
+/// </summary>
+/// <param name="fileName">Sidecar file name</param>
+/// <returns>False if missing, damaged or for other file</returns>
+bool DecodeIndex::load(const std::string& fileName)
+{
+    clear();
+    ifstream file(fileName, ifstream::binary);
+    if (file.is_open() == false)
+        return false;
+
+    IndexHeader hdr;
+    file.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+    const bool headerOK = file.good()
+        && equal(hdr.magic, hdr.magic + 4, kMagic)
+        && hdr.version == kVersion && hdr.key == m_key
+        && hdr.count == getFullCount();
+    if (headerOK == false)
+        return false;
+
+    m_entries.resize(static_cast<size_t>(hdr.count));
+    file.read(reinterpret_cast<char*>(m_entries.data()),
+        static_cast<streamsize>(m_entries.size() * sizeof(Entry)));
+    if (file.good() == false)
+    {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+/// <summary>
+/// Save index into the sidecar file
+/// </summary>
+/// <param name="fileName">Sidecar file name</param>
+/// <returns>False if the file could not be written</returns>
+/// <remarks>
+/// The index is written into a unique temporary file in the same
+/// directory and renamed over the sidecar, so a concurrent load or
+/// a crash never sees a partly written file.
+/// </remarks>
+bool DecodeIndex::save(const std::string& fileName) const
+{
+    const string tempName =
+        fileName + "." + to_string(random_device{}()) + ".tmp";
+    {
+        ofstream file(tempName, ofstream::binary | ofstream::trunc);
+        if (file.is_open() == false)
+            return false;
+
+        IndexHeader hdr{{}, kVersion, m_key, m_entries.size()};
+        copy(kMagic, kMagic + 4, hdr.magic);
+        file.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+        file.write(reinterpret_cast<const char*>(m_entries.data()),
+            static_cast<streamsize>(m_entries.size() * sizeof(Entry)));
+        file.close();
+        if (file.fail())
+        {
+            error_code ec;
+            filesystem::remove(tempName, ec);
+            return false;
+        }
+    }
+
+    error_code ec; // Replaces the target also on Windows
+    filesystem::rename(tempName, fileName, ec);
+    if (ec)
+    {
+        filesystem::remove(tempName, ec);
+        return false;
+    }
+    return true;
+}
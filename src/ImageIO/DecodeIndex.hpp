@@ -0,0 +1,132 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Restart points of the CR2 entropy coded data
+/// </summary>
+/// <remarks>
+/// The scan is one serial stream. Every kLineStep lines the index
+/// records the bit position and the predictor values at the line
+/// start, so later decodes can split the scan between threads.
+/// The index is kept in a sidecar file next to the raw file.
+/// </remarks>
+class DecodeIndex
+{
+public:
+    static constexpr int kLineStep = 64; // Lines between restart points
+    static constexpr const char* kExtension = ".rdx";
+
+    /// <summary>
+    /// Identification of the indexed file and scan
+    /// </summary>
+    struct Key {
+        uint64_t fileSize, fileTime; // Raw file state
+        uint64_t scanStart;          // Entropy coded data offset
+        uint64_t lines, samples, components;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    /// <summary>
+    /// Restart point at a line start
+    /// </summary>
+    struct Entry {
+        uint64_t bitPos;  // Bit position in the file
+        uint16_t prev[4]; // Predictor values
+    };
+
+private:
+    Key m_key;
+    std::vector<Entry> m_entries;
+
+public:
+    explicit DecodeIndex(const Key& key);
+
+    bool load(const std::string& fileName);
+    bool save(const std::string& fileName) const;
+    void clear();
+
+    static bool isRestartLine(int line);
+    void add(uint64_t bitPos, const int (&prev)[4]);
+    bool isComplete() const;
+    int getCount() const;
+    const Entry& operator[](int index) const;
+
+private:
+    uint64_t getFullCount() const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline DecodeIndex::DecodeIndex(const Key& key)
+    : m_key(key), m_entries()
+{}
+
+inline void DecodeIndex::clear()
+{
+    m_entries.clear();
+    return;
+}
+
+/// <summary>
+/// Check if the line (numbered from zero) starts a restart point
+/// </summary>
+inline bool DecodeIndex::isRestartLine(int line)
+{
+    return line % kLineStep == 0;
+}
+
+inline void DecodeIndex::add(uint64_t bitPos, const int (&prev)[4])
+{
+    Entry entry{bitPos, {}};
+    for (int c = 0; c < 4; c++)
+        entry.prev[c] = static_cast<uint16_t>(prev[c]);
+    m_entries.push_back(entry);
+    return;
+}
+
+/// <summary>
+/// Check if there is a restart point for every line step
+/// </summary>
+inline bool DecodeIndex::isComplete() const
+{
+    return m_entries.size() == getFullCount();
+}
+
+inline uint64_t DecodeIndex::getFullCount() const
+{
+    return (m_key.lines + kLineStep - 1) / kLineStep;
+}
+
+inline int DecodeIndex::getCount() const
+{
+    return static_cast<int>(m_entries.size());
+}
+
+inline const DecodeIndex::Entry& DecodeIndex::operator[](int index) const
+{
+    return m_entries[index];
+}
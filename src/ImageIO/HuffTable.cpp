@@ -0,0 +1,131 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "HuffTable.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+/// <summary>
+/// Construct empty table, where every code is invalid
+/// </summary>
+HuffTable::HuffTable()
+{
+    std::fill_n(m_lookup, 1 << kLookupBits, Entry{0, 0, 0});
+    std::fill_n(m_maxCode, kMaxCodeLen + 1, -1);
+    std::fill_n(m_valOffset, kMaxCodeLen + 1, 0);
+    std::fill_n(m_values, 256, static_cast<uint8_t>(0));
+    return;
+}
+
+/// <summary>
+/// Build new huffman table
+/// </summary>
+/// <param name="codeCounts">
+/// Gives codeword count of len 'i', where 'i' is
+/// the count of bits of that codeword numbered
+/// from 1 to 16. So index0 means codeword count
+/// with 1bit and not 0bit.
+/// </param>
+/// <param name="values">Values associated with codes</param>
+/// <returns>Reference to the created huffman table</returns>
+/// <remarks>
+/// Counts which are not a prefix code leave the table empty,
+/// so they can never index past the lookup table.
+/// </remarks>
+HuffTable& HuffTable::operator() (
+    const uint8_t* codeCounts, const uint8_t* values)
+{
+    *this = HuffTable(); // Forget the previous table
+    if (isPrefixCode(codeCounts) == false)
+        return *this;
+    uint32_t code = 0;   // Canonical code generator
+    int k = 0;           // Index of the next value
+
+    for (int len = 1; len <= kMaxCodeLen; len++)
+    {
+        const int count = codeCounts[len - 1];
+        if (count > 0)
+        {
+            assert(k + count <= 256);
+            m_valOffset[len] = k - static_cast<int32_t>(code);
+            for (int c = 0; c < count; c++, k++, code++)
+            {
+                m_values[k] = values[k];
+                if (len <= kLookupBits)
+                    fillLookup(code, len, values[k]);
+            }
+            m_maxCode[len] = static_cast<int32_t>(code) - 1;
+        }
+        code <<= 1; // Consecutive codes are one bit longer
+    }
+    return *this;
+}
+
+/// <summary>
+/// Check the code counts describe a valid prefix code
+/// </summary>
+/// <param name="codeCounts">Codeword counts as for the table build</param>
+/// <returns>False if the canonical codes run out of their length</returns>
+bool HuffTable::isPrefixCode(const uint8_t* codeCounts)
+{
+    uint32_t code = 0; // Canonical code generator
+    for (int len = 1; len <= kMaxCodeLen; len++)
+    {
+        code += codeCounts[len - 1];
+        if (code > (1u << len))
+            return false; // Oversubscribed
+        code <<= 1;
+    }
+    return true;
+}
+
+/// <summary>
+/// Fill all lookup entries starting with that code
+/// </summary>
+/// <param name="code">Huffman code</param>
+/// <param name="codeLen">Lenght of that code</param>
+/// <param name="diffLen">Difference lenght associated with the code</param>
+void HuffTable::fillLookup(uint32_t code, int codeLen, int diffLen)
+{
+    const int restLen = kLookupBits - codeLen; // Bits after code
+    const uint32_t first = code << restLen, count = 1u << restLen;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Entry& entry = m_lookup[first + i];
+        entry.codeLen = static_cast<uint8_t>(codeLen);
+
+        if (diffLen <= restLen)
+        {
+            // Difference bits are also known
+            const int diff = static_cast<int>(i >> (restLen - diffLen));
+            entry.value = static_cast<int16_t>(extend(diff, diffLen));
+            entry.totalLen = static_cast<uint8_t>(codeLen + diffLen);
+        }
+        else
+        {
+            // Only the difference lenght
+            entry.value = static_cast<int16_t>(diffLen);
+            entry.totalLen = 0;
+        }
+    }
+    return;
+}
@@ -0,0 +1,114 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+
+/// <summary>
+/// Huffman table for the lossless JPEG difference decoding
+/// </summary>
+/// <remarks>
+/// Instead of walking a tree bit by bit, the next kLookupBits
+/// of the stream index a lookup table. It resolves the code
+/// length together with the difference length, and if also the
+/// difference bits fit, it holds directly the sign-extended value.
+/// Longer codes fall back to the flat canonical code limits.
+/// </remarks>
+class HuffTable
+{
+public:
+    static constexpr int kLookupBits = 11; // Bits resolved by one probe
+    static constexpr int kMaxCodeLen = 16; // Longest JPEG Huffman code
+
+    /// <summary>
+    /// Lookup table entry
+    /// </summary>
+    struct Entry {
+        int16_t value;    // Difference if resolved, else its length
+        uint8_t codeLen;  // Code length (zero for longer codes)
+        uint8_t totalLen; // Code with difference length if resolved
+    };
+
+public:
+    HuffTable();
+    HuffTable& operator() (const uint8_t* codeCounts, const uint8_t* values);
+    static bool isPrefixCode(const uint8_t* codeCounts);
+
+    Entry lookup(uint32_t bits) const;
+    bool decodeLong(uint32_t bits, int& codeLen, int& diffLen) const;
+    static int extend(int diff, int diffLen);
+
+private:
+    void fillLookup(uint32_t code, int codeLen, int diffLen);
+
+    Entry m_lookup[1 << kLookupBits];    // First probe table
+    int32_t m_maxCode[kMaxCodeLen + 1];  // Largest code of each length
+    int32_t m_valOffset[kMaxCodeLen + 1]; // Value index minus code
+    uint8_t m_values[256];               // Values in code order
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// <summary>
+/// Probe the lookup table
+/// </summary>
+/// <param name="bits">Next kLookupBits from the stream</param>
+/// <returns>Table entry for that bit sequence</returns>
+inline HuffTable::Entry HuffTable::lookup(uint32_t bits) const
+{
+    return m_lookup[bits & ((1u << kLookupBits) - 1)];
+}
+
+/// <summary>
+/// Decode code longer than the lookup table covers
+/// </summary>
+/// <param name="bits">Next kMaxCodeLen bits from the stream</param>
+/// <param name="codeLen">Resulting code length</param>
+/// <param name="diffLen">Resulting difference length</param>
+/// <returns>False if the bits doesn't start with a valid code</returns>
+inline bool HuffTable::decodeLong(
+    uint32_t bits, int& codeLen, int& diffLen) const
+{
+    for (int len = kLookupBits + 1; len <= kMaxCodeLen; len++)
+    {
+        const int32_t code = static_cast<int32_t>(bits >> (kMaxCodeLen - len));
+        if (code <= m_maxCode[len])
+        {
+            codeLen = len;
+            diffLen = m_values[code + m_valOffset[len]];
+            return true;
+        }
+    }
+    return false;
+}
+
+/// <summary>
+/// Sign extension of the difference bits
+/// </summary>
+/// <param name="diff">Raw difference bits</param>
+/// <param name="diffLen">Count of the difference bits</param>
+/// <returns>Signed difference value</returns>
+inline int HuffTable::extend(int diff, int diffLen)
+{
+    if (diffLen > 0 && (1 << (diffLen - 1)) > diff)
+        diff -= (1 << diffLen) - 1;
+    return diff;
+}
@@ -0,0 +1,145 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// Map the whole file into memory
+/// </summary>
+/// <param name="fileName">File to be mapped</param>
+/// <returns>False if the mapping failed</returns>
+/// <remarks>
+/// The file is read sequentially, so the kernel is advised to
+/// read ahead aggressively and to start the reading immediately.
+/// </remarks>
+bool MappedFile::open(const std::string& fileName)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ,
+        FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) == FALSE || size.QuadPart <= 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(
+        file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file); // Mapping holds the file
+    if (mapping == nullptr)
+        return false;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping); // View holds the mapping
+    if (view == nullptr)
+        return false;
+    m_size = static_cast<size_t>(size.QuadPart);
+#else
+    const int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size),
+        PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // Mapping holds the file
+    if (view == MAP_FAILED)
+        return false;
+
+    m_size = static_cast<size_t>(st.st_size);
+    madvise(view, m_size, MADV_SEQUENTIAL);
+    madvise(view, m_size, MADV_WILLNEED);
+#endif
+    m_data = static_cast<const uint8_t*>(view);
+
+    // Whole mapping is the get area
+    char* begin = const_cast<char*>(reinterpret_cast<const char*>(m_data));
+    setg(begin, begin, begin + m_size);
+    return true;
+}
+
+/// <summary>
+/// Release the mapping
+/// </summary>
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+        setg(nullptr, nullptr, nullptr);
+    }
+    return;
+}
+
+/// <summary>
+/// Set the read position relative to the begin, actual position or end
+/// </summary>
+MappedFile::pos_type MappedFile::seekoff(off_type off,
+    std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    if ((which & std::ios_base::in) == 0)
+        return pos_type(off_type(-1)); // Read only buffer
+
+    off_type pos = off;
+    if (dir == std::ios_base::cur)
+        pos += gptr() - eback();
+    else if (dir == std::ios_base::end)
+        pos += static_cast<off_type>(m_size);
+    if (pos < 0 || pos > static_cast<off_type>(m_size))
+        return pos_type(off_type(-1));
+
+    setg(eback(), eback() + pos, egptr());
+    return pos_type(pos);
+}
+
+/// <summary>
+/// Set the absolute read position
+/// </summary>
+MappedFile::pos_type MappedFile::seekpos(
+    pos_type pos, std::ios_base::openmode which)
+{
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
@@ -0,0 +1,84 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <streambuf>
+#include <string>
+
+#include "NonCopyable.hpp"
+
+/// <summary>
+/// Read only memory mapping of a whole file
+/// </summary>
+/// <remarks>
+/// The mapping serves also as stream buffer, so an std::istream
+/// can parse the file straight from the mapped memory. There is
+/// no copy into an extra buffer and no system call per read.
+/// </remarks>
+class MappedFile : public std::streambuf, NonCopyable
+{
+    const uint8_t* m_data;
+    size_t m_size;
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const std::string& fileName);
+    void close();
+
+    bool isOpen() const;
+    const uint8_t* data() const;
+    size_t size() const;
+
+protected: // Stream buffer positioning
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+        std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline MappedFile::MappedFile()
+    : m_data(nullptr), m_size(0)
+{}
+
+inline MappedFile::~MappedFile()
+{
+    close();
+    return;
+}
+
+inline bool MappedFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+inline const uint8_t* MappedFile::data() const
+{
+    return m_data;
+}
+
+inline size_t MappedFile::size() const
+{
+    return m_size;
+}
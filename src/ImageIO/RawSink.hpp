@@ -0,0 +1,40 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+
+/// <summary>
+/// Receiver of the decoded raw image data
+/// </summary>
+/// <remarks>
+/// The reader passes runs of samples, which are already at their
+/// final unsliced position. Runs are stored from more threads at
+/// once, but never overlap.
+/// </remarks>
+class RawSink
+{
+public:
+    virtual ~RawSink() = default;
+
+    virtual void allocate(int width, int height) = 0;
+    virtual void store(int row, int col, const uint16_t* data, int len) = 0;
+};
@@ -28,7 +28,7 @@ using namespace std;
 #include "ShortTag.hpp"
 #include "LongTag.hpp"
 
-TiffTag* TagFactory::create(std::ifstream& file, const TiffTag::RawTag& rtag)
+TiffTag* TagFactory::create(std::istream& file, const TiffTag::RawTag& rtag)
 {
     TiffTag* res = nullptr;
 
@@ -55,19 +55,19 @@ TiffTag* TagFactory::create(std::ifstream& file, const TiffTag::RawTag& rtag)
     return res;
 }
 
-TiffTag* TagFactory::createByteTag(std::ifstream&, const TiffTag::RawTag&)
+TiffTag* TagFactory::createByteTag(std::istream&, const TiffTag::RawTag&)
 {
     // Not implemented as it is unused...
     return nullptr;
 }
 
-TiffTag* TagFactory::createStringTag(std::ifstream& file, const TiffTag::RawTag& rtag)
+TiffTag* TagFactory::createStringTag(std::istream& file, const TiffTag::RawTag& rtag)
 {
     TiffTag* res = nullptr;
 
     if (isValidStringTag(rtag)) {
         if (rtag.count >= 4) {
-            file.seekg(rtag.offset, ifstream::beg);
+            file.seekg(rtag.offset, istream::beg);
             unique_ptr<char[]> strPtr(new char[rtag.count]);
             file.read(strPtr.get(), rtag.count);
             if (strPtr[rtag.count - 1] != '\0')
@@ -99,14 +99,14 @@ bool TagFactory::isValidStringTag(const TiffTag::RawTag& rtag)
     return validID;
 }
 
-TiffTag* TagFactory::createShortTag(std::ifstream& file, const TiffTag::RawTag& rtag)
+TiffTag* TagFactory::createShortTag(std::istream& file, const TiffTag::RawTag& rtag)
 {
     ShortTag* res = nullptr;
 
     if (isValidShortTag(rtag)) {
         assert(rtag.count > 0);
         if (rtag.count > 2) {
-            file.seekg(rtag.offset, ifstream::beg);
+            file.seekg(rtag.offset, istream::beg);
             unique_ptr<uint16_t[]> strPtr(new uint16_t[rtag.count]);
             file.read(reinterpret_cast<char*>(strPtr.get()), rtag.count * sizeof(uint16_t));
             vector<uint16_t> data;
@@ -158,14 +158,14 @@ bool TagFactory::isValidShortTag(const TiffTag::RawTag& rtag)
     return valid;
 }
 
-TiffTag* TagFactory::createLongTag(std::ifstream&, const TiffTag::RawTag& rtag)
+TiffTag* TagFactory::createLongTag(std::istream&, const TiffTag::RawTag& rtag)
 {
     LongTag* res = nullptr;
 
     if (isValidShortTag(rtag)) {
         assert(rtag.count > 0);
         if (rtag.count > 1) {
-            /*file.seekg(rtag.offset, ifstream::beg);
+            /*file.seekg(rtag.offset, istream::beg);
             unique_ptr<uint16_t[]> strPtr(new uint16_t[rtag.count]);
             file.read(reinterpret_cast<char*>(strPtr.get()), rtag.count * sizeof(uint16_t));
             vector<uint16_t> data;
@@ -204,7 +204,7 @@ bool TagFactory::isValidLongTag(const TiffTag::RawTag& rtag)
     return valid;
 }
 
-TiffTag* TagFactory::createRationaTag(std::ifstream&, const TiffTag::RawTag&)
+TiffTag* TagFactory::createRationaTag(std::istream&, const TiffTag::RawTag&)
 {
     // Not implemented as it is unused...
     return nullptr;
@@ -20,27 +20,27 @@
 
 #pragma once
 
-#include <fstream>
+#include <istream>
 #include "TiffTag.hpp"
 
 class TagFactory
 {
 public:
-    TiffTag* create(std::ifstream& file, const TiffTag::RawTag& rtag);
+    TiffTag* create(std::istream& file, const TiffTag::RawTag& rtag);
 
 private:
-    TiffTag* createStringTag(std::ifstream& file, const TiffTag::RawTag& rtag);
+    TiffTag* createStringTag(std::istream& file, const TiffTag::RawTag& rtag);
     bool isValidStringTag(const TiffTag::RawTag& rtag);
 
-    TiffTag* createByteTag(std::ifstream& file, const TiffTag::RawTag& rtag);
+    TiffTag* createByteTag(std::istream& file, const TiffTag::RawTag& rtag);
 
-    TiffTag* createShortTag(std::ifstream& file, const TiffTag::RawTag& rtag);
+    TiffTag* createShortTag(std::istream& file, const TiffTag::RawTag& rtag);
     bool isValidShortTag(const TiffTag::RawTag& rtag);
 
-    TiffTag* createLongTag(std::ifstream& file, const TiffTag::RawTag& rtag);
+    TiffTag* createLongTag(std::istream& file, const TiffTag::RawTag& rtag);
     bool isValidLongTag(const TiffTag::RawTag& rtag);
 
-    TiffTag* createRationaTag(std::ifstream& file, const TiffTag::RawTag& rtag);
+    TiffTag* createRationaTag(std::istream& file, const TiffTag::RawTag& rtag);
 
 
 };
@@ -30,7 +30,7 @@ using namespace std;
 /*
 Read directory from file
 */
-uint32_t TiffDir::read(ifstream& file)
+uint32_t TiffDir::read(istream& file)
 {
     // Read tag count
     uint16_t tagCount;
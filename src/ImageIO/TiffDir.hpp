@@ -54,7 +54,7 @@ public:
     bool getTag(TiffTag::ID id, std::vector<uint16_t> &data);
 
 public: // Writable and Redable interface
-    uint32_t read(std::ifstream& file);
+    uint32_t read(std::istream& file);
     void write(std::ofstream& file, bool last) const;
 
 private: // IO helpers
@@ -40,8 +40,10 @@
 #include "ColorProfiles/AdobeRGB1998-icc.hpp"
 #include "ColorProfiles/srgb-icc.hpp"
 
+#include <algorithm>
 #include <format>
 #include <memory>
+#include <type_traits>
 using namespace std;
 
 /// <summary>
@@ -79,7 +81,36 @@ TiffWriter::~TiffWriter()
 /// </exception>
 void TiffWriter::write(const Image& img)
 {
-    setupMandatoryTags(img); // Mandatory flags from spec.
+    const Rect area = img.getOutputArea(m_noCrop);
+    writeFile(area.getWidth(), area.getHeight(), [&]() { writeData(img); });
+    return;
+}
+
+/// <summary>
+/// Write already converted 8-bit data into a tiff file
+/// </summary>
+/// <param name="data">Image data to be written</param>
+/// <exception cref="IOException">
+/// If IO operation fails it throws IOException with error description.
+/// </exception>
+void TiffWriter::write(Array2DView<const Color::RGB8> data)
+{
+    assert(m_bits == 8);
+    writeFile(data.getWidth(), data.getHeight(),
+        [&]() { writeRows<Color::RGB8>(data); });
+    return;
+}
+
+/// <summary>
+/// Write the tiff file structure with the given data
+/// </summary>
+/// <param name="width">Image width</param>
+/// <param name="height">Image height</param>
+/// <param name="writeData">Writes the image data block</param>
+void TiffWriter::writeFile(int width, int height,
+    const std::function<void()>& writeData)
+{
+    setupMandatoryTags(width, height); // Mandatory flags from spec.
     setupOptionalTags(); // Optional tags set
     setDataOffset(); // Calc and set data offset (stripe)
 
@@ -89,11 +120,18 @@ void TiffWriter::write(const Image& img)
     {
         writeHeader();
         writeIFDs();
-        writeData(img);
+        writeData();
         m_file.close();
     }
     else throw IOException(TiffWriter::kModuleName, m_fileName,
         "Could not open the output file for writing");
+
+    // Check the results
+    if (m_file.good() == false)
+    {
+        throw IOException(TiffWriter::kModuleName, m_fileName,
+            "Failed to write tiff data into that file.");
+    }
     clearTags(); // Restore begin tag state
     return;
 }
@@ -129,22 +167,13 @@ void TiffWriter::setDateTimeTag()
 /// <summary>
 /// Adds mandatory tags base on the image data
 /// </summary>
-/// <param name="img">Source image</param>
-void TiffWriter::setupMandatoryTags(const Image& img)
+/// <param name="imgWidth">Written image width</param>
+/// <param name="imgHeight">Written image height</param>
+void TiffWriter::setupMandatoryTags(int imgWidth, int imgHeight)
 {
-    uint16_t width, height, bits;
-
-    if (m_noCrop == false)
-    {
-        const Rect crop = img.getCamProfile()->getCrop();
-        width = static_cast<uint16_t>(crop.getWidth());
-        height = static_cast<uint16_t>(crop.getHeight());
-    }
-    else
-    {
-        width = static_cast<uint16_t>(img.getWidth());
-        height = static_cast<uint16_t>(img.getHeight());
-    }
+    const uint16_t width = static_cast<uint16_t>(imgWidth);
+    const uint16_t height = static_cast<uint16_t>(imgHeight);
+    uint16_t bits;
 
     // Channel info
     bits = static_cast<uint16_t>(m_bits);
@@ -232,29 +261,68 @@ void TiffWriter::writeHeader()
 /// Write image data block to file
 /// </summary>
 /// <param name="img">Image data to write</param>
+/// <remarks>
+/// The image is converted and written in bands of rows, so the whole
+/// converted image is never held in memory. The next band is advised
+/// to be read in, while the current one is written.
+/// </remarks>
 void TiffWriter::writeData(const Image& img)
 {
+    const Rect area = img.getOutputArea(m_noCrop);
+
     if (m_bits == 16)
-    {
-        Array2D<Color::RGB16> img16;
-        img.convert16(img16, m_noCrop); // Convert image double to 16bit and crop
-        const int bytes = img16.getWidth() * img16.getHeight() * sizeof(Color::RGB16);
-        m_file.write(reinterpret_cast<char*>(img16[0]), bytes);
-    }
+        writeBands<Color::RGB16>(img, area);
     else // m_bits == 8
     {
         assert(m_bits == 8);
-        Array2D<Color::RGB8> img8;
-        img.convert8(img8, m_noCrop); // Convert image double to 8bit and crop
-        const int bytes = img8.getWidth() * img8.getHeight() * sizeof(Color::RGB8);
-        m_file.write(reinterpret_cast<char*>(img8[0]), bytes);
+        writeBands<Color::RGB8>(img, area);
     }
+    return;
+}
 
-    // Check the results
-    if (m_file.good() == false)
+/// <summary>
+/// Convert the image area band by band and write it
+/// </summary>
+/// <param name="img">Source image</param>
+/// <param name="area">Image area to write</param>
+template<typename T>
+void TiffWriter::writeBands(const Image& img, const Rect& area)
+{
+    const int height = area.getHeight();
+    const int bandRows = std::min(kBandRows, height);
+    Array2D<T> band(area.getWidth(), bandRows);
+
+    img.advise(BufferPool::Advice::WillNeed,
+        area.top, area.top + bandRows);
+    for (int top = 0; top < height; top += bandRows)
     {
-        throw IOException(TiffWriter::kModuleName, m_fileName,
-            "Failed to write tiff data into that file.");
+        const int rows = std::min(bandRows, height - top);
+        const int next = area.top + top + bandRows; // Read ahead
+        img.advise(BufferPool::Advice::WillNeed, next, next + bandRows);
+        const Array2DView<T> part = band.view(
+            Rect::Create(Point(0, 0), area.getWidth(), rows));
+
+        if constexpr (std::is_same_v<T, Color::RGB16>)
+            img.convert16(part, Point(area.left, area.top + top));
+        else
+            img.convert8(part, Point(area.left, area.top + top));
+        writeRows<T>(part);
+    }
+    return;
+}
+
+/// <summary>
+/// Write image rows without the row padding
+/// </summary>
+/// <param name="img">Converted image data</param>
+template<typename T>
+void TiffWriter::writeRows(Array2DView<const T> img)
+{
+    const std::streamsize bytes = img.getWidth() * sizeof(T);
+
+    for (int row = 0; row < img.getHeight(); row++)
+    {
+        m_file.write(reinterpret_cast<const char*>(img[row]), bytes);
     }
     return;
 }
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <fstream>
+#include <functional>
 #include <string>
 
 #include "TiffDir.hpp"
@@ -33,6 +34,7 @@ enum ColorProfile : int;
 class TiffWriter : NonCopyable
 {
     static constexpr const char* kModuleName = "TiffWriter";
+    static constexpr int kBandRows = 64; // Rows converted at once
 
     std::string m_fileName;
     std::ofstream m_file;
@@ -47,6 +49,7 @@ public:
 
 public: // Writer interface
     void write(const Image& img);
+    void write(Array2DView<const Color::RGB8> data);
 
 public: // Additional tag set
     void setDocumentName(const std::string& docname);
@@ -61,15 +64,19 @@ private: // Tag manipulation
     void unsetTag(TiffTag::ID id);
     void setStringTag(TiffTag::ID id, const std::string& val);
     void setDateTimeTag();
-    void setupMandatoryTags(const Image& img);
+    void setupMandatoryTags(int width, int height);
     void setupOptionalTags();
     void setDataOffset();
     void clearTags(); // Clears tag list
 
 private: // Image write helpers
+    void writeFile(int width, int height,
+        const std::function<void()>& writeData);
     void writeHeader();
     void writeIFDs();
     void writeData(const Image& img);
+    template<typename T> void writeBands(const Image& img, const Rect& area);
+    template<typename T> void writeRows(Array2DView<const T> img);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -22,6 +22,7 @@
 #include "ArtistNameValidator.hpp"
 #include "CmdLineParser.hpp"
 
+#include <filesystem>
 #include <sstream>
 using namespace std;
 
@@ -38,6 +39,7 @@ int Options::process(const CmdLine::Parser& parser)
     m_NoCrop = parser.foundSwitch("u");
     m_NoProcess = parser.foundSwitch("x");
     m_Verbose = parser.foundSwitch("v");
+    m_DecodeIndex = parser.foundSwitch("r");
 
     // Rest of the parameters
     return processInputFile(parser) +
@@ -49,6 +51,10 @@ int Options::process(const CmdLine::Parser& parser)
            processExposure(parser) +
            processDemosaicAlg(parser) +
            processBitDepth(parser) +
+           processFast8(parser) +
+           processHalfSize(parser) +
+           processPrecision(parser) +
+           processScratchDir(parser) +
            processColorProfile(parser) +
            processArtistName(parser);
 }
@@ -229,6 +235,10 @@ int Options::processDemosaicAlg(const CmdLine::Parser& parser)
             m_DemosaicAlg = Demosaic::AlgorithmType::HQLinear;
         else if (da.compare("ahd") == 0)
             m_DemosaicAlg = Demosaic::AlgorithmType::AHD;
+        else if (da.compare("rcd") == 0)
+            m_DemosaicAlg = Demosaic::AlgorithmType::RCD;
+        else if (da.compare("hybrid") == 0)
+            m_DemosaicAlg = Demosaic::AlgorithmType::Hybrid;
         else {
             stringstream sstream;
             sstream << "Demosaicing algorithm '"
@@ -261,6 +271,108 @@ int Options::processBitDepth(const CmdLine::Parser& parser)
     return 0;
 }
 
+/// <summary>
+/// Process fast 8-bit integer pipeline selection
+/// </summary>
+/// <param name="parser">Cmd line parser</param>
+/// <returns>Error count</returns>
+/// <remarks>
+/// Must be called after the demosaic and bit depth processing.
+/// Without a selected algorithm, HQLinear is used.
+/// </remarks>
+int Options::processFast8(const CmdLine::Parser& parser)
+{
+    m_Fast8 = parser.foundSwitch("F");
+    if (m_Fast8 == false)
+        return 0;
+
+    int errorCount = 0;
+    if (m_bitDepth != 8) {
+        CmdLine::Parser::error("Fast mode writes only 8-bit output.");
+        errorCount++;
+    }
+
+    string da;
+    if (parser.found("d", da) == 0)
+        m_DemosaicAlg = Demosaic::AlgorithmType::HQLinear;
+    else if (m_DemosaicAlg != Demosaic::AlgorithmType::Bilinear
+        && m_DemosaicAlg != Demosaic::AlgorithmType::HQLinear) {
+        CmdLine::Parser::error(
+            "Fast mode supports only bilinear and hqlinear demosaicing.");
+        errorCount++;
+    }
+    return errorCount;
+}
+
+/// <summary>
+/// Process half-size superpixel development selection
+/// </summary>
+/// <param name="parser">Cmd line parser</param>
+/// <returns>Error count</returns>
+/// <remarks>
+/// Must be called after the fast 8-bit processing.
+/// </remarks>
+int Options::processHalfSize(const CmdLine::Parser& parser)
+{
+    m_HalfSize = parser.foundSwitch("H");
+    if (m_HalfSize && m_Fast8) {
+        CmdLine::Parser::error(
+            "Half size is not available in the fast 8-bit mode.");
+        return 1;
+    }
+    return 0;
+}
+
+/// <summary>
+/// Process image plane precision selection
+/// </summary>
+/// <param name="parser">Cmd line parser</param>
+/// <returns>Error count</returns>
+int Options::processPrecision(const CmdLine::Parser& parser)
+{
+    string precision;
+    int found = parser.found("P", precision);
+
+    if (found) {
+        if (precision.compare("double") == 0) {
+            m_Precision = Precision::Double;
+        }
+        else if (precision.compare("float") == 0) {
+            m_Precision = Precision::Float;
+        }
+        else if (precision.compare("half") == 0) {
+            m_Precision = Precision::Half;
+        }
+        else {
+            CmdLine::Parser::error(found, -1, "Unknown precision.");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/// <summary>
+/// Process directory for the scratch files
+/// </summary>
+/// <param name="parser">Cmd line parser</param>
+/// <returns>Error count</returns>
+int Options::processScratchDir(const CmdLine::Parser& parser)
+{
+    string scratchDir;
+    int found = parser.found("s", scratchDir);
+
+    if (found) {
+        std::error_code ec;
+        if (std::filesystem::is_directory(scratchDir, ec) == false) {
+            CmdLine::Parser::error(found, -1,
+                "Scratch directory doesn't exist.");
+            return 1;
+        }
+        m_ScratchDir = scratchDir;
+    }
+    return 0;
+}
+
 /// <summary>
 /// Process color profile selection
 /// </summary>
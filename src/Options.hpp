@@ -24,6 +24,7 @@
 
 #include "ColorProfiles/ColorProfile.hpp"
 #include "Demosaic/AlgorithmType.hpp"
+#include "Structures/Precision.hpp"
 #include "Structures/Path.hpp"
 namespace CmdLine {
 class Parser;
@@ -37,9 +38,12 @@ class Options {
     // Processing options
     int m_Tint, m_Contrast, m_DemosaicIter;
     double m_Temperature, m_Exposure;
-    bool m_NoCrop, m_NoProcess, m_Verbose;
+    bool m_NoCrop, m_NoProcess, m_Verbose, m_DecodeIndex, m_Fast8;
+    bool m_HalfSize;
     Demosaic::AlgorithmType m_DemosaicAlg;
     int m_bitDepth;
+    Precision m_Precision;
+    std::string m_ScratchDir;
     ColorProfile m_colorProfile;
 
     // Metadata
@@ -56,6 +60,9 @@ public: // Geters of options
     bool getNoCrop() const;
     bool getNoProcess() const;
     bool getVerbose() const;
+    bool getDecodeIndex() const;
+    bool getFast8() const;
+    bool getHalfSize() const;
     int getTint() const;
     int getContrast() const;
     int getDemosaicIter() const;
@@ -63,6 +70,8 @@ public: // Geters of options
     double getExposure() const;
     Demosaic::AlgorithmType getDemosaicAlg() const;
     int getBitDepth() const;
+    Precision getPrecision() const;
+    std::string getScratchDir() const;
     ColorProfile getColorProfile() const;
     std::string getArtistName() const;
 
@@ -77,6 +86,10 @@ private: // Helpers
     int processExposure(const CmdLine::Parser& parser);
     int processDemosaicAlg(const CmdLine::Parser& parser);
     int processBitDepth(const CmdLine::Parser& parser);
+    int processFast8(const CmdLine::Parser& parser);
+    int processHalfSize(const CmdLine::Parser& parser);
+    int processPrecision(const CmdLine::Parser& parser);
+    int processScratchDir(const CmdLine::Parser& parser);
     int processColorProfile(const CmdLine::Parser& parser);
     int processArtistName(const CmdLine::Parser& parser);
 };
@@ -93,8 +106,13 @@ inline Options::Options()
       m_NoCrop(false),
       m_NoProcess(false),
       m_Verbose(false),
+      m_DecodeIndex(false),
+      m_Fast8(false),
+      m_HalfSize(false),
       m_DemosaicAlg(Demosaic::AlgorithmType::AHD),
       m_bitDepth(8),
+      m_Precision(k_defaultPrecision),
+      m_ScratchDir(),
       m_colorProfile(ColorProfile::sRGB),
       m_Artist()
 {
@@ -125,6 +143,21 @@ inline bool Options::getVerbose() const
     return m_Verbose;
 }
 
+inline bool Options::getDecodeIndex() const
+{
+    return m_DecodeIndex;
+}
+
+inline bool Options::getFast8() const
+{
+    return m_Fast8;
+}
+
+inline bool Options::getHalfSize() const
+{
+    return m_HalfSize;
+}
+
 inline int Options::getTint() const
 {
     return m_Tint;
@@ -160,6 +193,16 @@ inline int Options::getBitDepth() const
     return m_bitDepth;
 }
 
+inline Precision Options::getPrecision() const
+{
+    return m_Precision;
+}
+
+inline std::string Options::getScratchDir() const
+{
+    return m_ScratchDir;
+}
+
 inline ColorProfile Options::getColorProfile() const
 {
     return m_colorProfile;
@@ -78,39 +78,80 @@ void OutputModule::conversionMessage(const char* profileName, const char* curveN
     return;
 }
 
+/// <summary>
+/// Write already converted 8-bit output data
+/// </summary>
+/// <param name="img">Image the data come from</param>
+/// <param name="data">Output area in the output color space</param>
+/// <param name="opt">Processing options</param>
+void OutputModule::run(const Image& img,
+    Array2DView<const Color::RGB8> data, const Options& opt)
+{
+    OutputModule output(opt);
+    TiffWriter tw(output.m_OutputFile, 8, opt.getNoCrop());
+
+    output.setupWriter(tw, img, opt);
+    tw.write(data);
+    return;
+}
+
 /// <summary>
 /// Process image with output module
 /// </summary>
 /// <param name="img">Image to be processed</param>
 void OutputModule::process(Image& img, const Options& opt)
 {
-    const int bits = opt.getBitDepth();
-    const ColorProfile colorProfile = opt.getColorProfile();
+    convert(img, opt.getColorProfile()); // ProPhoto to target profile
+
+    // Write the image as TIFF
+    TiffWriter tw(m_OutputFile, opt.getBitDepth(), opt.getNoCrop());
+    setupWriter(tw, img, opt);
+    tw.write(img);
+}
 
-    // Convert ProPhoto to target profile
+/// <summary>
+/// Convert the working ProPhoto image to the output profile
+/// </summary>
+/// <param name="img">Image to be converted</param>
+/// <param name="colorProfile">Output color profile</param>
+void OutputModule::convert(Image& img, ColorProfile colorProfile)
+{
     if (colorProfile == ColorProfile::aRGB) {
         conversionMessage("AdobeRGB(1998)", "2.2");
-        convert2argb(img);
+        dispatchPrecision(img.getPrecision(), [&]<typename T>() {
+            convert2argb<T>(img);
+        });
     }
     else if (colorProfile == ColorProfile::sRGB) {
         conversionMessage("sRGB", "curve");
-        convert2srgb(img);
+        dispatchPrecision(img.getPrecision(), [&]<typename T>() {
+            convert2srgb<T>(img);
+        });
     }
+    return;
+}
 
+/// <summary>
+/// Setup the writer tags and print the writing message
+/// </summary>
+/// <param name="tw">TIFF writer</param>
+/// <param name="img">Written image</param>
+/// <param name="opt">Processing options</param>
+void OutputModule::setupWriter(
+    TiffWriter& tw, const Image& img, const Options& opt) const
+{
     // Writing the resulting output
     RawDev::verbout
         << "Writing output to '" << m_OutputFile << "' ("
         << opt.getBitDepth() << "bits)" << endl;
 
-    // Write the image as TIFF
-    TiffWriter tw(m_OutputFile, bits, opt.getNoCrop());
     tw.setDocumentName(m_InputFile.getFileName());
     tw.setICC(opt.getColorProfile());
     tw.setMake("Canon");
     tw.setModel(std::string(img.getCamProfile()->getCameraName()));
     tw.setArtist(m_Artist);
     tw.setCopyright(formatCopyright());
-    tw.write(img);
+    return;
 }
 
 /// <summary>
@@ -130,67 +171,111 @@ std::string OutputModule::formatCopyright() const
 /// <summary>
 /// Convert working ProPhoto to aRGB (precise)
 /// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
 /// <param name="img">Image to be processed</param>
+template<typename T>
 void OutputModule::convert2argb(Image& img)
 {
-    const Mat3x3 ProPhoto2ARGB =
-        Color::k_matXYZtoARGB * Color::k_matXYZtoProPhotoRGB.inverse();
-    constexpr double invgamma = 1 / 2.2;
+    const Mat3x3 ProPhoto2ARGB = outputMatrix(ColorProfile::aRGB);
+    constexpr T invgamma = static_cast<T>(1 / 2.2);
     const int width = img.getWidth(), height = img.getHeight();
 
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < height; ++i) {
-        for (int j = 0; j < width; ++j) {
-            auto value = // Convert to ProPhoto -> XYZ -> AdobeRGB
-                Color::rgbTo<Color::RGB64>(ProPhoto2ARGB, img.getValue(i, j));
-
-            // Gamma 2.2 for Adobe RGB
-            value.r = pow(value.r, invgamma);
-            value.g = pow(value.g, invgamma);
-            value.b = pow(value.b, invgamma);
-            img.setValue(i, j, value);
+    #pragma omp parallel
+    {
+        Array2D<T> rgb(width, 3);
+        T *red = rgb[0], *green = rgb[1], *blue = rgb[2];
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < height; ++i) {
+            img.getRow(i, 0, width, red, green, blue);
+            for (int j = 0; j < width; ++j) {
+                auto value = // Convert to ProPhoto -> XYZ -> AdobeRGB
+                    Color::rgbTo<Color::BasicRGB<T>>(ProPhoto2ARGB,
+                        Color::BasicRGB<T>{red[j], green[j], blue[j]});
+
+                // Gamma 2.2 for Adobe RGB
+                red[j] = pow(value.r, invgamma);
+                green[j] = pow(value.g, invgamma);
+                blue[j] = pow(value.b, invgamma);
+            }
+            img.setRow(i, 0, width, red, green, blue);
         }
     }
     return;
 }
 
+/// <summary>
+/// Working ProPhoto to output profile matrix
+/// </summary>
+/// <param name="colorProfile">Output color profile</param>
+/// <returns>Conversion matrix</returns>
+Mat3x3 OutputModule::outputMatrix(ColorProfile colorProfile)
+{
+    const Mat3x3& toOutput = (colorProfile == ColorProfile::aRGB)
+        ? Color::k_matXYZtoARGB : Color::k_matXYZtoSRGB;
+    return toOutput * Color::k_matXYZtoProPhotoRGB.inverse();
+}
+
+/// <summary>
+/// Gamma curve of the output profile
+/// </summary>
+/// <param name="colorProfile">Output color profile</param>
+/// <param name="value">Linear value</param>
+/// <returns>Nonlinear value</returns>
+double OutputModule::gammaCurve(ColorProfile colorProfile, double value)
+{
+    if (colorProfile == ColorProfile::aRGB)
+        return pow(value, 1 / 2.2);
+    return srgbGammaCurve(value);
+}
+
 /// <summary>
 /// Special characteristic sRGB gamma curve
 /// </summary>
 /// <param name="value">Linear value to be converted</param>
 /// <returns>Converted nonlinear value</returns>
-double OutputModule::srgbGammaCurve(double value)
+template<typename T>
+T OutputModule::srgbGammaCurve(T value)
 {
-    double result;
+    T result;
 
-    if (value <= 0.0031308)
-        result = 12.92 * value;
+    if (value <= T(0.0031308))
+        result = T(12.92) * value;
     else
-        result = 1.055 * pow(value, 1 / 2.4) - 0.055;
+        result = T(1.055) * pow(value, T(1 / 2.4)) - T(0.055);
     return result;
 }
 
 /// <summary>
 /// Convert working ProPhoto to sRGB (precise)
 /// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
 /// <param name="img">Image to be processed</param>
+template<typename T>
 void OutputModule::convert2srgb(Image& img)
 {
-    const Mat3x3 ProPhoto2SRGB =
-        Color::k_matXYZtoSRGB * Color::k_matXYZtoProPhotoRGB.inverse();
+    const Mat3x3 ProPhoto2SRGB = outputMatrix(ColorProfile::sRGB);
     const int width = img.getWidth(), height = img.getHeight();
 
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < height; ++i) {
-        for (int j = 0; j < width; ++j) {
-            auto value = // Convert to ProPhoto -> XYZ -> sRGB
-                Color::rgbTo<Color::RGB64>(ProPhoto2SRGB, img.getValue(i, j));
-
-            // Gamma curve for sRGB
-            value.r = srgbGammaCurve(value.r);
-            value.g = srgbGammaCurve(value.g);
-            value.b = srgbGammaCurve(value.b);
-            img.setValue(i, j, value);
+    #pragma omp parallel
+    {
+        Array2D<T> rgb(width, 3);
+        T *red = rgb[0], *green = rgb[1], *blue = rgb[2];
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < height; ++i) {
+            img.getRow(i, 0, width, red, green, blue);
+            for (int j = 0; j < width; ++j) {
+                auto value = // Convert to ProPhoto -> XYZ -> sRGB
+                    Color::rgbTo<Color::BasicRGB<T>>(ProPhoto2SRGB,
+                        Color::BasicRGB<T>{red[j], green[j], blue[j]});
+
+                // Gamma curve for sRGB
+                red[j] = srgbGammaCurve(value.r);
+                green[j] = srgbGammaCurve(value.g);
+                blue[j] = srgbGammaCurve(value.b);
+            }
+            img.setRow(i, 0, width, red, green, blue);
         }
     }
     return;
@@ -20,11 +20,16 @@
 
 #pragma once
 
+#include "ColorProfiles/ColorProfile.hpp"
+#include "Color.hpp"
+#include "Structures/Array2DView.hpp"
+#include "Structures/Mat3x3.hpp"
 #include "Structures/Path.hpp"
 #include <string>
 
 class Image;
 class Options;
+class TiffWriter;
 
 class OutputModule {
     Path m_InputFile, m_OutputFile;
@@ -32,17 +37,27 @@ class OutputModule {
 
 public:
     static void run(Image& img, const Options& opt);
+    static void run(const Image& img,
+        Array2DView<const Color::RGB8> data, const Options& opt);
+    static void convert(Image& img, ColorProfile colorProfile);
+    static Mat3x3 outputMatrix(ColorProfile colorProfile);
+    static double gammaCurve(ColorProfile colorProfile, double value);
 
 private:
     OutputModule(const Options& opt);
     void process(Image& img, const Options& opt);
 
 private: // Helpers
+    void setupWriter(
+        TiffWriter& tw, const Image& img, const Options& opt) const;
     std::string formatCopyright() const;
     static void conversionMessage(const char* profileName, const char* curveName);
 
 private: // Gamma correction
+    template<typename T>
     static void convert2argb(Image& img);
+    template<typename T>
     static void convert2srgb(Image& img);
-    static double srgbGammaCurve(double value);
+    template<typename T>
+    static T srgbGammaCurve(T value);
 };
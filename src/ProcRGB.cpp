@@ -26,6 +26,7 @@
 #include "Utils.hpp"
 #include "RawDev.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <cmath>
@@ -74,83 +75,145 @@ void ProcRGBModule::process(Image &img, bool process)
         RawDev::verbout << "Apply processing curves" << endl;
 
     // Main process image
-    processImage(img, process);
+    dispatchPrecision(img.getPrecision(), [&]<typename T>() {
+        processImage<T>(img, process);
+    });
     return;
 }
 
 /// <summary>
 /// Process RGB image
 /// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
 /// <param name="img">Image to be processed</param>
+template<typename T>
 void ProcRGBModule::processImage(Image &img, bool process)
 {
     const shared_ptr<CamProfile> profile = img.getCamProfile();
-    const Mat3x3 cam2work = Color::k_matXYZtoProPhotoRGB
-        * profile->getForwardMatrix()
-        * profile->getAnalogBalanceMatrix().inverse();
+    const Mat3x3 cam2work = workMatrix(*profile);
     const int width = img.getWidth(), height = img.getHeight();
-    const double middleGray = pow(0.5, 2.2), // Gamma 2.2
-        expcomp = Utils::EV2Val(1 + m_Exposure), // +1 to match ACR
-        recovery = 1.0 - 1.0 / expcomp; // Hightlights recovery
-    Color::RGB64 v; // Pixel values
-    Color::HSV64 hsv;
-
-    #pragma omp parallel for schedule(static) private(v, hsv)
-    for (int row = 0; row < height; row++) {
-        for (int col = 0; col < width; col++) {
-            // Convert from camera to working color space
-            v = Color::rgbTo<Color::RGB64>(cam2work, img.getValue(row, col));
-            v.r = std::clamp(v.r, 0.0, 1.0);
-            v.g = std::clamp(v.g, 0.0, 1.0);
-            v.b = std::clamp(v.b, 0.0, 1.0);
-
-            // HSV profile processing
-            if (profile->hasHSVMaps() == true)
-            {
-                hsv = Color::rgb2hsv(v);
-                profile->applyHSVMap(hsv);
-                profile->applyProfileLook(hsv);
-                v = Color::hsv2rgb(hsv); // Convert back to RGB
-            }
-
-            // Process edits
-            if (process)
-            {
-                // Curves maping (the main mapping)
-                v.r = basecurve(v.r, expcomp, 0.0, 1.0, recovery, 0.0);
-                v.g = basecurve(v.g, expcomp, 0.0, 1.0, recovery, 0.0);
-                v.b = basecurve(v.b, expcomp, 0.0, 1.0, recovery, 0.0);
+    const T middleGray = static_cast<T>(pow(0.5, 2.2)), // Gamma 2.2
+        expcomp = static_cast<T>(Utils::EV2Val(1 + m_Exposure)), // +1 to match ACR
+        recovery = 1 - 1 / expcomp; // Hightlights recovery
+
+    img.advise(BufferPool::Advice::Sequential); // Streamed by rows
+    #pragma omp parallel
+    {
+        Array2D<T> rgb(width, 3);
+        T *red = rgb[0], *green = rgb[1], *blue = rgb[2];
+
+        #pragma omp for schedule(static)
+        for (int row = 0; row < height; row++) {
+            img.getRow(row, 0, width, red, green, blue);
+            for (int col = 0; col < width; col++) {
+                // Convert from camera to working color space
+                Color::BasicRGB<T> v = Color::rgbTo<Color::BasicRGB<T>>(
+                    cam2work, Color::BasicRGB<T>{red[col], green[col], blue[col]});
+                v.r = std::clamp<T>(v.r, 0, 1);
+                v.g = std::clamp<T>(v.g, 0, 1);
+                v.b = std::clamp<T>(v.b, 0, 1);
+
+                // HSV profile processing
+                if (profile->hasHSVMaps() == true)
+                {
+                    Color::BasicHSV<T> hsv = Color::rgb2hsv(v);
+                    profile->applyHSVMap(hsv);
+                    profile->applyProfileLook(hsv);
+                    v = Color::hsv2rgb(hsv); // Convert back to RGB
+                }
 
-                // Contrast S-Curve
-                if (m_Contrast != 0)
+                // Process edits
+                if (process)
                 {
-                    v.r = contrast(v.r, middleGray);
-                    v.g = contrast(v.g, middleGray);
-                    v.b = contrast(v.b, middleGray);
+                    v.r = tone(v.r, expcomp, recovery, middleGray);
+                    v.g = tone(v.g, expcomp, recovery, middleGray);
+                    v.b = tone(v.b, expcomp, recovery, middleGray);
+                    /* Other edits : TODO */
                 }
-                /* Other edits : TODO */
+                red[col] = v.r;
+                green[col] = v.g;
+                blue[col] = v.b;
             }
-            img.setValue(row, col, v); // Save the result
+            img.setRow(row, 0, width, red, green, blue); // Save the result
         }
     }
     return;
 }
 
+/// <summary>
+/// Camera native to working color space matrix
+/// </summary>
+/// <param name="profile">Camera profile</param>
+/// <returns>Conversion matrix</returns>
+Mat3x3 ProcRGBModule::workMatrix(const CamProfile &profile)
+{
+    return Color::k_matXYZtoProPhotoRGB
+        * profile.getForwardMatrix()
+        * profile.getAnalogBalanceMatrix().inverse();
+}
+
+/// <summary>
+/// Tone curves as a table for 16-bit values
+/// </summary>
+/// <param name="opt">Processing options</param>
+/// <returns>Mapped value for every 16-bit input value</returns>
+/// <remarks>
+/// Unprocessed images get the identity.
+/// </remarks>
+std::vector<uint16_t> ProcRGBModule::toneTable(const Options &opt)
+{
+    ProcRGBModule procrgb(opt);
+    const double middleGray = pow(0.5, 2.2), // Gamma 2.2
+        expcomp = Utils::EV2Val(1 + procrgb.m_Exposure),
+        recovery = 1.0 - 1.0 / expcomp;
+    std::vector<uint16_t> table(65536);
+
+    for (size_t i = 0; i < table.size(); i++) {
+        double value = i / 65535.0;
+        if (opt.getNoProcess() == false)
+            value = procrgb.tone(value, expcomp, recovery, middleGray);
+        value = std::clamp(value, 0.0, 1.0);
+        table[i] = static_cast<uint16_t>(lround(value * 65535.0));
+    }
+    return table;
+}
+
+/// <summary>
+/// Apply the tone curves to a value
+/// </summary>
+/// <param name="value">Linear value</param>
+/// <param name="expcomp">Exposure compensation scale</param>
+/// <param name="recovery">Highlights recovery</param>
+/// <param name="middleGray">Data neutral gray</param>
+/// <returns>Mapped value</returns>
+template<typename T>
+T ProcRGBModule::tone(T value, T expcomp, T recovery, T middleGray)
+{
+    // Curves maping (the main mapping)
+    value = basecurve<T>(value, expcomp, 0, 1, recovery, 0);
+
+    // Contrast S-Curve
+    if (m_Contrast != 0)
+        value = contrast(value, middleGray);
+    return value;
+}
+
 /// <summary>
 /// Apply S-Curve to a value
 /// </summary>
 /// <param name="value">Value to be mapped</param>
 /// <param name="midpoint">Data neutral gray</param>
 /// <returns>Mapped value</returns>
-double ProcRGBModule::contrast(double value, double midpoint)
+template<typename T>
+T ProcRGBModule::contrast(T value, T midpoint)
 {
     assert(m_Contrast >= -100 && m_Contrast <= 100);
-    const double g = 1 / (1 - m_Contrast * 0.009);
+    const T g = 1 / (1 - m_Contrast * T(0.009));
 
-    if (value <= 0.0)
-        return 0.0;
-    else if (value > 1.0)
-        return 1.0;
+    if (value <= 0)
+        return 0;
+    else if (value > 1)
+        return 1;
     else if (value < midpoint)
         value = midpoint * pow(value / midpoint, g);
     else
@@ -188,36 +251,37 @@ TODO: Create my own cruve generator that is better
 /*
 Base curve for processing
 */
-double ProcRGBModule::basecurve(
-    double val, double exposure, double black, double white, double hr, double sr)
+template<typename T>
+T ProcRGBModule::basecurve(
+    T val, T exposure, T black, T white, T hr, T sr)
 {
     if (black < 0) {
-        double m = 0.5; // Midpoint
-        double slope = 1.0 + black; // Slope of straight line between (0,-black) and (1,1)
-        double y = -black + m * slope; // Value at midpoint
+        T m = T(0.5); // Midpoint
+        T slope = 1 + black; // Slope of straight line between (0,-black) and (1,1)
+        T y = -black + m * slope; // Value at midpoint
 
         if (val > m) {
             // Value on straight line between (m,y) and (1,1)
             return y + (val - m) * slope;
         }
         else {
-            return y * clower2(val / m, slope * m / y, 2.0 - sr);
+            return y * clower2(val / m, slope * m / y, 2 - sr);
         }
     }
     else {
-        double slope = exposure / (1.0 - black);
-        double m = exposure * white > 1.0
-            ? black / exposure + (0.25) / slope : black + (1 - black) / 4;
-        double y = exposure * white > 1.0
-            ? 0.25 : (m - black / exposure) * slope;
+        T slope = exposure / (1 - black);
+        T m = exposure * white > 1
+            ? black / exposure + T(0.25) / slope : black + (1 - black) / 4;
+        T y = exposure * white > 1
+            ? T(0.25) : (m - black / exposure) * slope;
 
         if (val <= m) {
             return black == 0
                 ? val * slope : clower(val / m, slope * m / y, sr) * y;
         }
-        else if (exposure * white > 1.0) {
-            return y + (1.0 - y) * cupper2(
-                (val - m) / (white - m), slope * (white - m) / (1.0 - y), hr);
+        else if (exposure * white > 1) {
+            return y + (1 - y) * cupper2(
+                (val - m) / (white - m), slope * (white - m) / (1 - y), hr);
         }
         else {
             return y + (val - m) * slope;
@@ -229,16 +293,17 @@ double ProcRGBModule::basecurve(
 Basic convex function between (0,0) and (1,1).
 m1 and m2 controls the slope at the start and end point
 */
-inline double ProcRGBModule::basel(double x, double m1, double m2)
+template<typename T>
+inline T ProcRGBModule::basel(T x, T m1, T m2)
 {
-    if (x == 0.0) {
-        return 0.0;
+    if (x == 0) {
+        return 0;
     }
 
-    double k = sqrt((m1 - 1.0) * (m1 - m2) * 0.5) / (1.0 - m2);
-    double l = (m1 - m2) / (1.0 - m2) + k;
-    double lx = log(x);
-    return m2 * x + (1.0 - m2) * (2.0 - exp(k * lx)) * exp(l * lx);
+    T k = sqrt((m1 - 1) * (m1 - m2) * T(0.5)) / (1 - m2);
+    T l = (m1 - m2) / (1 - m2) + k;
+    T lx = log(x);
+    return m2 * x + (1 - m2) * (2 - exp(k * lx)) * exp(l * lx);
 }
 
 
@@ -246,78 +311,83 @@ inline double ProcRGBModule::basel(double x, double m1, double m2)
 Basic concave function between (0,0) and (1,1).
 m1 and m2 controls the slope at the start and end point
 */
-inline double ProcRGBModule::baseu(double x, double m1, double m2)
+template<typename T>
+inline T ProcRGBModule::baseu(T x, T m1, T m2)
 {
-    return 1.0 - basel(1.0 - x, m1, m2);
+    return 1 - basel(1 - x, m1, m2);
 }
 
 /*
 Convex curve between (0,0) and (1,1) with slope m at (0,0).
 hr controls the highlight recovery
 */
-inline double ProcRGBModule::cupper(double x, double m, double hr)
+template<typename T>
+inline T ProcRGBModule::cupper(T x, T m, T hr)
 {
-    if (hr > 1.0) {
-        return baseu(x, m, 2.0 * (hr - 1.0) / m);
+    if (hr > 1) {
+        return baseu(x, m, 2 * (hr - 1) / m);
     }
 
-    double x1 = (1.0 - hr) / m;
-    double x2 = x1 + hr;
+    T x1 = (1 - hr) / m;
+    T x2 = x1 + hr;
 
     if (x >= x2) {
-        return 1.0;
+        return 1;
     }
 
     if (x < x1) {
         return x * m;
     }
 
-    return 1.0 - hr + hr * baseu((x - x1) / hr, m, 0);
+    return 1 - hr + hr * baseu<T>((x - x1) / hr, m, 0);
 }
 
 /*
 Concave curve between (0,0) and (1,1) with slope m at (1,1).
 sr controls the shadow recovery
 */
-inline double ProcRGBModule::clower(double x, double m, double sr)
+template<typename T>
+inline T ProcRGBModule::clower(T x, T m, T sr)
 {
-    return 1.0 - cupper(1.0 - x, m, sr);
+    return 1 - cupper(1 - x, m, sr);
 }
 
 /*
 Convex curve between (0,0) and (1,1) with slope m at (0,0).
 hr controls the highlight recovery
 */
-inline double ProcRGBModule::cupper2(double x, double m, double hr)
+template<typename T>
+inline T ProcRGBModule::cupper2(T x, T m, T hr)
 {
-    double x1 = (1.0 - hr) / m;
-    double x2 = x1 + hr;
+    T x1 = (1 - hr) / m;
+    T x2 = x1 + hr;
 
     if (x >= x2) {
-        return 1.0;
+        return 1;
     }
 
     if (x < x1) {
         return x * m;
     }
 
-    return 1.0 - hr + hr * baseu((x - x1) / hr, m, 0.3 * hr);
+    return 1 - hr + hr * baseu((x - x1) / hr, m, T(0.3) * hr);
 }
 
 /*
 Concave curve between (0,0) and (1,1) with slope m at (0,0).
 sr controls the shadow recovery
 */
-inline double ProcRGBModule::clower2(double x, double m, double sr)
+template<typename T>
+inline T ProcRGBModule::clower2(T x, T m, T sr)
 {
     //curve for b<0; starts with positive slope and then rolls over toward straight line to x=y=1
-    double x1 = sr / 1.5 + 0.00001;
+    T x1 = sr / T(1.5) + T(0.00001);
 
-    if (x > x1 || sr < 0.001) {
+    if (x > x1 || sr < T(0.001)) {
         return 1 - (1 - x) * m;
     }
     else {
-        double y1 = 1 - (1 - x1) * m;
+        T y1 = 1 - (1 - x1) * m;
         return y1 + m * (x - x1) - (1 - m) * Utils::sqr(Utils::sqr(1 - x / x1));
     }
 }
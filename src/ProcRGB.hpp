@@ -20,9 +20,14 @@
 
 #pragma once
 
+#include <cinttypes>
+#include <vector>
+
+#include "Structures/Mat3x3.hpp"
+
+class CamProfile;
 class Image;
 class Options;
-namespace Color { struct HSV64; };
 class HSVMap;
 
 class ProcRGBModule
@@ -32,23 +37,36 @@ class ProcRGBModule
 
 public:
     static void run(Image &img, const Options &opt);
+    static Mat3x3 workMatrix(const CamProfile &profile);
+    static std::vector<uint16_t> toneTable(const Options &opt);
 
 private:
     ProcRGBModule(const Options &opt);
     void process(Image &img, bool process);
 
 private: // Edits
+    template<typename T>
     void processImage(Image &img, bool process);
-    double contrast(double value, double midpoint);
+    template<typename T>
+    T tone(T value, T expcomp, T recovery, T middleGray);
+    template<typename T>
+    T contrast(T value, T midpoint);
     static double levels(double value, double black,
         double gamma, double white, double outBlack, double outWhite);
 
 private: // Curve construction
-    static double basecurve(double, double, double, double, double, double);
-    static double basel(double, double, double);
-    static double baseu(double, double, double);
-    static double cupper(double, double, double);
-    static double clower(double, double, double);
-    static double cupper2(double, double, double);
-    static double clower2(double, double, double);
+    template<typename T>
+    static T basecurve(T, T, T, T, T, T);
+    template<typename T>
+    static T basel(T, T, T);
+    template<typename T>
+    static T baseu(T, T, T);
+    template<typename T>
+    static T cupper(T, T, T);
+    template<typename T>
+    static T clower(T, T, T);
+    template<typename T>
+    static T cupper2(T, T, T);
+    template<typename T>
+    static T clower2(T, T, T);
 };
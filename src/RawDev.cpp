@@ -29,10 +29,13 @@
 #include "Exception.hpp"
 #include "Options.hpp"
 #include "StopWatch.hpp"
+#include "Structures/BufferPool.hpp"
 #include "Structures/Image.hpp"
 #include "Version.hpp"
 
 #include "Demosaic.hpp"
+#include "Fast8.hpp"
+#include "HalfSize.hpp"
 #include "Output.hpp"
 #include "ProcRGB.hpp"
 #include "Scale.hpp"
@@ -57,6 +60,10 @@ int RawDev::run(int argc, const char* argv[])
     processCmdLine(argc, argv); // Process cmd line options
     verbout.setEnabled(m_options.getVerbose());
 
+    if (m_options.getScratchDir().empty() == false) {
+        BufferPool::global().setScratchDir(m_options.getScratchDir());
+    }
+
     Image img; // Raw image for processing
     if (!loadRawImage(img)) {
         cerr << "Failed to read input RAW file. EXIT." << endl;
@@ -67,25 +74,41 @@ int RawDev::run(int argc, const char* argv[])
     verbout.indent(); // Go to itemize mode
     verbout << endl;
 
-    verbout << "Scaling colors in camera native space" << endl;
-    verbout.indent();
-    ScaleModule::run(img, m_options);
-    verbout.unindent();
+    if (m_options.getFast8()) {
+        verbout << "Developing in fast 8-bit integer path" << endl;
+        verbout.indent();
+        Fast8Module::run(img, m_options);
+        verbout.unindent();
+    }
+    else {
+        verbout << "Scaling colors in camera native space" << endl;
+        verbout.indent();
+        ScaleModule::run(img, m_options);
+        verbout.unindent();
 
-    verbout << "Demosaicing pixels on the bayer mask" << endl;
-    verbout.indent();
-    DemosaicModule::run(img, m_options);
-    verbout.unindent();
+        if (m_options.getHalfSize()) {
+            verbout << "Collapsing bayer cells to half size" << endl;
+            verbout.indent();
+            HalfSizeModule::run(img);
+            verbout.unindent();
+        }
+        else {
+            verbout << "Demosaicing pixels on the bayer mask" << endl;
+            verbout.indent();
+            DemosaicModule::run(img, m_options);
+            verbout.unindent();
+        }
 
-    verbout << "Processing RGB image" << endl;
-    verbout.indent();
-    ProcRGBModule::run(img, m_options);
-    verbout.unindent();
+        verbout << "Processing RGB image" << endl;
+        verbout.indent();
+        ProcRGBModule::run(img, m_options);
+        verbout.unindent();
 
-    verbout << "Finishing and output" << endl;
-    verbout.indent();
-    OutputModule::run(img, m_options);
-    verbout.unindent();
+        verbout << "Finishing and output" << endl;
+        verbout.indent();
+        OutputModule::run(img, m_options);
+        verbout.unindent();
+    }
 
     watch.stop(); // Stop measurement
     verbout << endl;
@@ -108,7 +131,7 @@ bool RawDev::loadRawImage(Image& img)
     StopWatch watch(true);
 
     try {
-        img.loadCR2(input, temp);
+        img.loadCR2(input, temp, m_options.getDecodeIndex());
     }
     catch (const Exception& ex) {
         cerr << ex.what() << endl;
@@ -138,6 +161,21 @@ void RawDev::printProcessingSummary(const Image& img)
     if (m_options.getNoCrop()) {
         cout << ", no crop";
     }
+    if (m_options.getPrecision() == Precision::Float) {
+        cout << ", single precision";
+    }
+    else if (m_options.getPrecision() == Precision::Half) {
+        cout << ", half precision";
+    }
+    if (m_options.getScratchDir().empty() == false) {
+        cout << ", out of core";
+    }
+    if (m_options.getFast8()) {
+        cout << ", fast 8-bit";
+    }
+    if (m_options.getHalfSize()) {
+        cout << ", half size";
+    }
     cout << endl;
 }
 
@@ -181,7 +219,7 @@ void RawDev::SetupOptions(CmdLine::Parser& parser)
         "Contrast adjustment option from. {-100 to 100}",
         CmdLine::OptionType::INT);
     parser.addOption("d", "Demosaic",
-        "Demosaicing algortithm selection. {bilinear, hqlinear, freeman, ahd}",
+        "Demosaicing algortithm selection. {bilinear, hqlinear, freeman, ahd, rcd, hybrid}",
         CmdLine::OptionType::STRING);
     parser.addOption("e", "Exposure",
         "Exposure compensation of the raw data. {-5.0 to 5.0 in EV}",
@@ -205,9 +243,21 @@ void RawDev::SetupOptions(CmdLine::Parser& parser)
     parser.addOption("o", "OutputFile",
         "Where to save output. {default: input file name + .tif}",
         CmdLine::OptionType::STRING);
+    parser.addOption("P", "Precision",
+        "Image plane precision. {half, float or double}",
+        CmdLine::OptionType::STRING);
     parser.addOption("p", "profile",
         "Output file color profile. {srgb or argb, default: srgb}",
         CmdLine::OptionType::STRING);
+    parser.addOption("s", "ScratchDir",
+        "Keep large image planes in scratch files there. {default: memory}",
+        CmdLine::OptionType::STRING);
+    parser.addSwitch("F",
+        "Fast 8-bit integer processing. {bilinear or hqlinear}", true);
+    parser.addSwitch("H",
+        "Half-size image of 2x2 superpixels without demosaicing.", true);
+    parser.addSwitch("r",
+        "Parallel raw decode with index file (input file name + .rdx).", true);
     parser.addSwitch("u", "Don't crop the result. Uncroped.", true);
     parser.addSwitch("x", "Don't RGB process the image. Unprocessed.", true);
 
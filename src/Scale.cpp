@@ -29,6 +29,7 @@
 #include "RawDev.hpp"
 
 #include <sstream>
+#include <vector>
 using namespace std;
 
 /// <summary>
@@ -43,6 +44,19 @@ void ScaleModule::run(Image &img, const Options &opt)
     return;
 }
 
+/// <summary>
+/// Compute black point and channel scales without scaling
+/// </summary>
+/// <param name="img">Raw image</param>
+/// <param name="opt">Processing options</param>
+/// <returns>Levels for scaling the raw values</returns>
+ScaleModule::Levels ScaleModule::calcLevels(
+    const Image &img, const Options &opt)
+{
+    ScaleModule scale(img.getCamProfile(), opt);
+    return scale.calcLevels(img);
+}
+
 /// <summary>
 /// Construct and load needed options
 /// </summary>
@@ -53,6 +67,7 @@ ScaleModule::ScaleModule(
     m_CamProfile = profile;
     m_ColorTemp = opt.getTemperature();
     m_Tint = opt.getTint();
+    m_Precision = opt.getPrecision();
     return;
 }
 
@@ -64,24 +79,78 @@ ScaleModule::ScaleModule(
 /// <param name="scaleR">Red channel scale</param>
 /// <param name="scaleG">Green channel scale</param>
 /// <param name="scaleB">Blue channel scale</param>
+/// <remarks>
+/// Works on the single CFA plane, where the scale of a pixel
+/// is selected by its filter color.
+/// </remarks>
 void ScaleModule::scale(Image &img,
     double black, double scaleR, double scaleG, double scaleB)
 {
     RawDev::verbout << "Subtracting black and scaling colors" << endl;
-    const int width = img.getWidth(), height = img.getHeight();
+    Mosaic& mosaic = img.getMosaic();
+    const CFAPattern cfa = mosaic.getCFAPattern();
+    const int width = mosaic.getWidth(), height = mosaic.getHeight();
+    Plane values(width, height, m_Precision);
+
+    mosaic.advise(BufferPool::Advice::Sequential); // Streamed by rows
+
+    dispatchPrecision(m_Precision, [&]<typename T>() {
+        cfa.dispatch([&]<CFAPattern::Filter F>() {
+            const T scales[3] = {static_cast<T>(scaleR),
+                static_cast<T>(scaleG), static_cast<T>(scaleB)};
+            const T offset = static_cast<T>(black);
 
-    #pragma omp parallel for schedule(static)
-    for (int row = 0; row < height; row++)
+            #pragma omp parallel
+            {
+                vector<T> buffer(width);
+
+                #pragma omp for schedule(static)
+                for (int row = 0; row < height; row++)
+                {
+                    const uint16_t* raw = mosaic.getRawRow(row);
+                    if (Utils::odd(row))
+                        scaleRow<T, CFAPattern::RowColors<F, 1>>(
+                            raw, buffer.data(), width, offset, scales);
+                    else
+                        scaleRow<T, CFAPattern::RowColors<F, 0>>(
+                            raw, buffer.data(), width, offset, scales);
+                    values.setRow(row, 0, width, buffer.data());
+                }
+            }
+        });
+    });
+    mosaic.setScaled(std::move(values));
+    return;
+}
+
+/// <summary>
+/// Subtract black and scale one row
+/// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <typeparam name="Row">Colors of the row</typeparam>
+/// <param name="raw">Raw row values</param>
+/// <param name="dst">Scaled row values</param>
+/// <param name="width">Row width</param>
+/// <param name="black">Black point</param>
+/// <param name="scales">Scales of the RGB channels</param>
+template<typename T, typename Row>
+void ScaleModule::scaleRow(const uint16_t* raw, T* dst, int width,
+    T black, const T (&scales)[3])
+{
+    const T even = scales[CFAPattern::channel(Row::even)];
+    const T odd = scales[CFAPattern::channel(Row::odd)];
+    const auto scale = [black](T value, T scale) {
+        return Image::clip((value - black) * scale);
+    };
+
+    #pragma omp simd
+    for (int col = 0; col < width - 1; col += 2)
     {
-        for (int col = 0; col < width; col++)
-        {
-            Color::RGB64 value = img.getValue(row, col);
-            value.r = (value.r - black) * scaleR;
-            value.g = (value.g - black) * scaleG;
-            value.b = (value.b - black) * scaleB;
-            img.setValue(row, col, value); // Clips to [0-1]
-        }
+        dst[col] = scale(raw[col], even);
+        dst[col + 1] = scale(raw[col + 1], odd);
     }
+    if (Utils::odd(width))
+        dst[width - 1] = scale(raw[width - 1], even);
     return;
 }
 
@@ -90,6 +159,20 @@ void ScaleModule::scale(Image &img,
 /// </summary>
 /// <param name="img">Image to be processed</param>
 void ScaleModule::process(Image &img)
+{
+    const Levels levels = calcLevels(img);
+
+    // Main scaling
+    scale(img, levels.black, levels.scaleR, levels.scaleG, levels.scaleB);
+    return;
+}
+
+/// <summary>
+/// Compute black point, white balance and the resulting scales
+/// </summary>
+/// <param name="img">Raw image</param>
+/// <returns>Levels for scaling</returns>
+ScaleModule::Levels ScaleModule::calcLevels(const Image &img)
 {
     const double black = calcBlackPoint(img);
 
@@ -108,15 +191,13 @@ void ScaleModule::process(Image &img)
     printScale("B =", wbScales.bs, true);
 
     // Compute scales
-    double scaleR, scaleG, scaleB;
+    Levels levels;
     const Color::RGB64 white = m_CamProfile->getWhiteLevel();
-    scaleR = wbScales.rs * baseExposure / (white.r - black);
-    scaleG = wbScales.gs * baseExposure / (white.g - black);
-    scaleB = wbScales.bs * baseExposure / (white.b - black);
-
-    // Main scaling
-    scale(img, black, scaleR, scaleG, scaleB);
-    return;
+    levels.black = black;
+    levels.scaleR = wbScales.rs * baseExposure / (white.r - black);
+    levels.scaleG = wbScales.gs * baseExposure / (white.g - black);
+    levels.scaleB = wbScales.bs * baseExposure / (white.b - black);
+    return levels;
 }
 
 /// <summary>
@@ -177,38 +258,59 @@ Color::RGB64 ScaleModule::estimateBlackPoint(const Image &img)
 void ScaleModule::averageBlacks(
     const Image &img, Rect(&masked)[2], Color::RGB64 &black)
 {
-    const CFAPattern cfa = m_CamProfile->getCFAPattern();
-    int rcount = 1, gcount = 1, bcount = 1;
-
-    for (int m = 0; m < 2; m++)
-    {
-        const int right = masked[m].right,
-            bottom = masked[m].bottom, left = masked[m].left;
+    const CFAPattern cfa = img.getMosaic().getCFAPattern();
+    double average[3] = {black.r, black.g, black.b};
+    int count[3] = {1, 1, 1};
 
-        for (int row = masked[m].top; row < bottom; row++)
+    cfa.dispatch([&]<CFAPattern::Filter F>() {
+        for (int m = 0; m < 2; m++)
         {
-            for (int col = left; col < right; col++)
+            const int right = masked[m].right,
+                bottom = masked[m].bottom, left = masked[m].left;
+
+            for (int row = masked[m].top; row < bottom; row++)
             {
-                double value; // Var for loading channel values
+                if (Utils::odd(row))
+                    averageRow<CFAPattern::RowColors<F, 1>>(
+                        img, row, left, right, average, count);
+                else
+                    averageRow<CFAPattern::RowColors<F, 0>>(
+                        img, row, left, right, average, count);
+            }
+        }
+    });
+    black = {average[0], average[1], average[2]};
+    return;
+}
 
-                switch (cfa(row, col))
-                {
-                case CFAPattern::Color::RED:
-                    value = img.getValueR(row, col);
-                    black.r = Utils::incAverage(black.r, value, rcount++);
-                    break;
-                case CFAPattern::Color::BLUE:
-                    value = img.getValueB(row, col);
-                    black.b = Utils::incAverage(black.b, value, bcount++);
-                    break;
-                default: // GREEN_R || GREEN_B
-                    value = img.getValueG(row, col);
-                    black.g = Utils::incAverage(black.g, value, gcount++);
-                    break;
-                }
-            } // col loop
-        } // row loop
-    }
+/// <summary>
+/// Add the masked pixels of one row to the black averages
+/// </summary>
+/// <typeparam name="Row">Colors of the row</typeparam>
+/// <param name="img">Raw image</param>
+/// <param name="row">Image row</param>
+/// <param name="left">First column</param>
+/// <param name="right">End column</param>
+/// <param name="black">Averages of the RGB channels</param>
+/// <param name="count">Next value numbers of the RGB channels</param>
+/// <remarks>
+/// Each color is on one column parity, so the values of a channel
+/// are still averaged from left to right.
+/// </remarks>
+template<typename Row>
+void ScaleModule::averageRow(const Image &img, int row, int left, int right,
+    double (&black)[3], int (&count)[3])
+{
+    const Mosaic& mosaic = img.getMosaic();
+    const auto average = [&](int first, int channel) {
+        for (int col = first; col < right; col += 2) {
+            const double value = mosaic.getRaw(row, col);
+            black[channel] = Utils::incAverage(
+                black[channel], value, count[channel]++);
+        }
+    };
+    average(left + (left & 1), CFAPattern::channel(Row::even));
+    average(left + (~left & 1), CFAPattern::channel(Row::odd));
     return;
 }
 
@@ -20,8 +20,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include "Color.hpp"
+#include "Structures/Precision.hpp"
 
 class Image;
 class Options;
@@ -33,21 +35,38 @@ class ScaleModule
     std::shared_ptr<CamProfile> m_CamProfile;
     double m_ColorTemp;
     int m_Tint;
+    Precision m_Precision;
 
 public:
+    /// <summary>
+    /// Black point and the scales of the channels
+    /// </summary>
+    struct Levels {
+        double black;
+        double scaleR, scaleG, scaleB;
+    };
+
     static void run(Image& img, const Options &opt);
+    static Levels calcLevels(const Image& img, const Options &opt);
 
 private:
     ScaleModule(// Constructor
         const std::shared_ptr<CamProfile> &profile, const Options &opt);
     void scale(Image &img, double black,
         double scaleR, double scaleG, double scaleB);
+    template<typename T, typename Row>
+    static void scaleRow(const uint16_t *raw, T *dst, int width,
+        T black, const T (&scales)[3]);
     void process(Image &img);
+    Levels calcLevels(const Image &img);
 
 private: // Black point helpers
     double calcBlackPoint(const Image &img);
     void averageBlacks(const Image &img,
         Rect(&masked)[2], Color::RGB64 &black);
+    template<typename Row>
+    static void averageRow(const Image &img, int row, int left, int right,
+        double (&black)[3], int (&count)[3]);
     Color::RGB64 estimateBlackPoint(const Image &img);
 
 private: // Other
@@ -22,19 +22,66 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <memory>
+#include <numeric>
 #include <stdexcept>
 #include <type_traits>
 
+#include "Array2DView.hpp"
+#include "BufferPool.hpp"
+
+/*
+Alignment of the array rows in bytes. It must be a power of two.
+Can be changed at build time, e.g. for wider SIMD registers.
+*/
+#ifndef RAWDEV_ARRAY2D_ALIGNMENT
+#define RAWDEV_ARRAY2D_ALIGNMENT 64
+#endif
+
+/// <summary>
+/// Placement of the array memory on construction
+/// </summary>
+/// <remarks>
+/// With first touch, the rows are written by the OpenMP threads in the
+/// same static partitioning as the processing loops use. The memory
+/// pages then lie on the NUMA node of the thread working with them.
+/// Blocks reused from the buffer pool keep their previous placement.
+/// </remarks>
+enum class Array2DPolicy {
+    Lazy,       // Pages placed by the first use
+    FirstTouch, // Rows touched in parallel
+    HugePages   // First touch with transparent huge pages
+};
+
+/*
+Policy for the full size image planes. Huge pages can be enabled
+at build time, they save the TLB misses on very large planes.
+*/
+#ifdef RAWDEV_HUGE_PAGES
+constexpr Array2DPolicy k_planePolicy = Array2DPolicy::HugePages;
+#else
+constexpr Array2DPolicy k_planePolicy = Array2DPolicy::FirstTouch;
+#endif
+
 template<typename T>
 class Array2D {
     static_assert(
         std::is_object_v<T>, "Array2D content must be a object type.");
 
 public:
+    static constexpr size_t k_alignment = std::max(
+        size_t{RAWDEV_ARRAY2D_ALIGNMENT}, alignof(T));
+    static_assert((k_alignment & (k_alignment - 1)) == 0,
+        "Array2D alignment must be a power of two.");
+    static_assert(k_alignment <= BufferPool::k_alignment,
+        "Array2D alignment is over the buffer pool alignment.");
+
     Array2D() noexcept;
     Array2D(int width, int height);
-    Array2D(int width, int height, const T& init);
+    Array2D(int width, int height, Array2DPolicy policy);
+    Array2D(int width, int height, const T& init,
+        Array2DPolicy policy = Array2DPolicy::Lazy);
     Array2D(const Array2D& src);
     Array2D(Array2D&& src) noexcept;
     Array2D& operator=(const Array2D& src);
@@ -43,27 +90,50 @@ public:
     // Getters and setters
     int getWidth() const noexcept;
     int getHeight() const noexcept;
+    int getStride() const noexcept;
     size_t getItemCount() const noexcept;
     T* operator[](int row);
     const T* operator[](int row) const;
     bool inside(int row, int col) const noexcept;
     bool empty() const noexcept;
+    void advise(BufferPool::Advice advice) const noexcept;
+    void advise(BufferPool::Advice advice, int top, int bottom) const noexcept;
+
+    // Views without copying
+    Array2DView<T> view();
+    Array2DView<const T> view() const;
+    Array2DView<T> view(const Rect& area);
+    Array2DView<const T> view(const Rect& area) const;
+
+    static int calcStride(int width) noexcept;
 
 private:
+    /// <summary>
+    /// Destroys the items and returns the memory to the pool
+    /// </summary>
+    struct Deleter {
+        size_t count = 0;
+        size_t bytes = 0;
+        void operator()(T* ptr) const noexcept;
+    };
+
     void construct(int width, int height);
     void setDimensions(int width, int height) noexcept;
+    size_t getAllocCount() const noexcept;
     void allocate();
+    void constructed() noexcept;
+    void fill(const T& init, Array2DPolicy policy);
     void clone(const Array2D<T>& src);
 
-    std::unique_ptr<T[]> m_colBasePtr;
-    int m_width, m_height;
+    std::unique_ptr<T[], Deleter> m_colBasePtr;
+    int m_width, m_height, m_stride;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
 template<typename T>
 inline Array2D<T>::Array2D() noexcept
-    : m_width{0}, m_height{0}
+    : m_width{0}, m_height{0}, m_stride{0}
 {
 }
 
@@ -79,13 +149,28 @@ inline Array2D<T>::Array2D(int width, int height)
         "Uninitialized construction is allowed for trivial types only.");
 
     construct(width, height);
+    constructed(); // Trivial items need no construction
+}
+
+template<typename T>
+inline Array2D<T>::Array2D(int width, int height, Array2DPolicy policy)
+{
+    static_assert(std::is_trivial_v<T>,
+        "Placement without a value is allowed for trivial types only.");
+
+    construct(width, height);
+    if (policy != Array2DPolicy::Lazy)
+        fill(T{}, policy); // Zeroed by the touching threads
+    constructed();
 }
 
 template<typename T>
-inline Array2D<T>::Array2D(int width, int height, const T& init)
+inline Array2D<T>::Array2D(
+    int width, int height, const T& init, Array2DPolicy policy)
 {
     construct(width, height);
-    std::uninitialized_fill_n(m_colBasePtr.get(), getItemCount(), init);
+    fill(init, policy);
+    constructed();
 }
 
 template<typename T>
@@ -98,7 +183,8 @@ template<typename T>
 inline Array2D<T>::Array2D(Array2D&& src) noexcept
     : m_colBasePtr(std::move(src.m_colBasePtr)),
       m_width{src.m_width},
-      m_height{src.m_height}
+      m_height{src.m_height},
+      m_stride{src.m_stride}
 {
     src.setDimensions(0, 0); // Make source empty
 }
@@ -120,6 +206,7 @@ inline Array2D<T>& Array2D<T>::operator=(Array2D&& src) noexcept
         m_colBasePtr.swap(src.m_colBasePtr);
         std::swap(m_width, src.m_width);
         std::swap(m_height, src.m_height);
+        std::swap(m_stride, src.m_stride);
     }
     return *this;
 }
@@ -136,6 +223,15 @@ inline int Array2D<T>::getHeight() const noexcept
     return m_height;
 }
 
+/// <summary>
+/// Distance between the starts of two rows in items
+/// </summary>
+template<typename T>
+inline int Array2D<T>::getStride() const noexcept
+{
+    return m_stride;
+}
+
 template<typename T>
 inline size_t Array2D<T>::getItemCount() const noexcept
 {
@@ -147,7 +243,7 @@ template<typename T>
 inline T* Array2D<T>::operator[](int row)
 {
     assert(row >= 0 && row < m_height);
-    const size_t offset = static_cast<size_t>(row) * m_width;
+    const size_t offset = static_cast<size_t>(row) * m_stride;
     return m_colBasePtr.get() + offset;
 }
 
@@ -171,6 +267,85 @@ inline bool Array2D<T>::empty() const noexcept
     return m_width < 1;
 }
 
+/// <summary>
+/// Advise the system about use of the rows
+/// </summary>
+/// <param name="advice">Expected use</param>
+/// <param name="top">First row</param>
+/// <param name="bottom">Row after the last one</param>
+template<typename T>
+inline void Array2D<T>::advise(
+    BufferPool::Advice advice, int top, int bottom) const noexcept
+{
+    top = std::max(top, 0);
+    bottom = std::min(bottom, m_height);
+    if (top < bottom) {
+        const size_t begin = static_cast<size_t>(top) * m_stride;
+        const size_t end = static_cast<size_t>(bottom) * m_stride;
+        BufferPool::advise(const_cast<T*>(m_colBasePtr.get() + begin),
+            (end - begin) * sizeof(T), advice);
+    }
+}
+
+template<typename T>
+inline void Array2D<T>::advise(BufferPool::Advice advice) const noexcept
+{
+    advise(advice, 0, m_height);
+}
+
+template<typename T>
+inline Array2DView<T> Array2D<T>::view()
+{
+    return Array2DView<T>(m_colBasePtr.get(), m_width, m_height, m_stride);
+}
+
+template<typename T>
+inline Array2DView<const T> Array2D<T>::view() const
+{
+    return Array2DView<const T>(
+        m_colBasePtr.get(), m_width, m_height, m_stride);
+}
+
+template<typename T>
+inline Array2DView<T> Array2D<T>::view(const Rect& area)
+{
+    return view().sub(area);
+}
+
+template<typename T>
+inline Array2DView<const T> Array2D<T>::view(const Rect& area) const
+{
+    return view().sub(area);
+}
+
+/// <summary>
+/// Row stride for the given width
+/// </summary>
+/// <param name="width">Row width in items</param>
+/// <returns>Stride in items</returns>
+/// <remarks>
+/// Every row starts on the alignment. Strides of a multiple of 4 KiB
+/// get one more alignment step, otherwise the vertical neighbours fall
+/// into the same cache sets.
+/// </remarks>
+template<typename T>
+inline int Array2D<T>::calcStride(int width) noexcept
+{
+    constexpr size_t step = k_alignment / std::gcd(k_alignment, sizeof(T));
+    size_t stride = (static_cast<size_t>(width) + step - 1) / step * step;
+
+    if ((stride * sizeof(T)) % 4096 == 0)
+        stride += step;
+    return static_cast<int>(stride);
+}
+
+template<typename T>
+inline void Array2D<T>::Deleter::operator()(T* ptr) const noexcept
+{
+    std::destroy_n(ptr, count);
+    BufferPool::global().release({ptr, bytes});
+}
+
 template<typename T>
 inline void Array2D<T>::construct(int width, int height)
 {
@@ -187,16 +362,67 @@ inline void Array2D<T>::setDimensions(int width, int height) noexcept
 {
     m_width  = width;
     m_height = height;
+    m_stride = (width > 0) ? calcStride(width) : 0;
 }
 
+template<typename T>
+inline size_t Array2D<T>::getAllocCount() const noexcept
+{
+    return static_cast<size_t>(m_stride) * m_height;
+}
+
+/// <summary>
+/// Allocate aligned memory for all rows from the buffer pool
+/// </summary>
+/// <remarks>
+/// The items are not constructed yet. After constructing them,
+/// constructed() must be called, so they are destroyed later.
+/// </remarks>
 template<typename T>
 inline void Array2D<T>::allocate()
 {
     assert(m_width > 0 && m_height > 0);
-    m_colBasePtr = std::make_unique<T[]>(getItemCount());
+    m_colBasePtr.reset(); // Release previously allocated memory
+    const BufferPool::Block block =
+        BufferPool::global().acquire(getAllocCount() * sizeof(T));
+    m_colBasePtr.get_deleter().count = 0;
+    m_colBasePtr.get_deleter().bytes = block.bytes;
+    m_colBasePtr.reset(static_cast<T*>(block.ptr));
+}
 
-    // The assigment operator releases previously alocated memory,
-    // if any valid is present.
+template<typename T>
+inline void Array2D<T>::constructed() noexcept
+{
+    m_colBasePtr.get_deleter().count = getAllocCount();
+}
+
+/// <summary>
+/// Construct all items with the given value
+/// </summary>
+/// <param name="init">Item value</param>
+/// <param name="policy">Memory placement policy</param>
+template<typename T>
+inline void Array2D<T>::fill(const T& init, Array2DPolicy policy)
+{
+    T* const base = m_colBasePtr.get();
+
+    if (policy == Array2DPolicy::HugePages)
+        BufferPool::advise(base, getAllocCount() * sizeof(T),
+            BufferPool::Advice::HugePages);
+
+    // Throwing constructors can't leave a parallel region
+    if constexpr (std::is_nothrow_copy_constructible_v<T>) {
+        if (policy != Array2DPolicy::Lazy) {
+            #pragma omp parallel for schedule(static)
+            for (int row = 0; row < m_height; row++) {
+                std::uninitialized_fill_n(
+                    base + static_cast<size_t>(row) * m_stride,
+                    m_stride, init);
+            }
+            return;
+        }
+    }
+    std::uninitialized_fill_n(base, getAllocCount(), init);
 }
 
 template<typename T>
@@ -208,6 +434,7 @@ inline void Array2D<T>::clone(const Array2D<T>& src)
     if (!src.empty()) {
         allocate();
         std::uninitialized_copy_n(src.m_colBasePtr.get(),
-            src.getItemCount(), m_colBasePtr.get());
+            getAllocCount(), m_colBasePtr.get());
+        constructed();
     }
 }
@@ -0,0 +1,136 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <type_traits>
+
+#include "Rect.hpp"
+
+/// <summary>
+/// Non-owning view of a rectangle in a 2D array
+/// </summary>
+/// <remarks>
+/// The view refers to the rows of the array by their stride, so crops,
+/// tiles and bands are passed without copying. It is valid only while
+/// the viewed memory exists. Use a const item type for read only views.
+/// </remarks>
+template<typename T>
+class Array2DView {
+public:
+    Array2DView() noexcept;
+    Array2DView(T* data, int width, int height, int stride) noexcept;
+    template<typename U, typename = std::enable_if_t<
+        std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    Array2DView(const Array2DView<U>& src) noexcept;
+
+    int getWidth() const noexcept;
+    int getHeight() const noexcept;
+    int getStride() const noexcept;
+    T* operator[](int row) const;
+    bool inside(int row, int col) const noexcept;
+    bool empty() const noexcept;
+
+    Array2DView sub(const Rect& area) const;
+
+private:
+    T* m_data;
+    int m_width, m_height, m_stride;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+inline Array2DView<T>::Array2DView() noexcept
+    : m_data{nullptr}, m_width{0}, m_height{0}, m_stride{0}
+{
+}
+
+template<typename T>
+inline Array2DView<T>::Array2DView(
+    T* data, int width, int height, int stride) noexcept
+    : m_data{data}, m_width{width}, m_height{height}, m_stride{stride}
+{
+    assert(width <= stride || height <= 1);
+}
+
+template<typename T>
+template<typename U, typename>
+inline Array2DView<T>::Array2DView(const Array2DView<U>& src) noexcept
+    : Array2DView(src.getHeight() > 0 ? src[0] : nullptr,
+        src.getWidth(), src.getHeight(), src.getStride())
+{
+}
+
+template<typename T>
+inline int Array2DView<T>::getWidth() const noexcept
+{
+    return m_width;
+}
+
+template<typename T>
+inline int Array2DView<T>::getHeight() const noexcept
+{
+    return m_height;
+}
+
+template<typename T>
+inline int Array2DView<T>::getStride() const noexcept
+{
+    return m_stride;
+}
+
+template<typename T>
+inline T* Array2DView<T>::operator[](int row) const
+{
+    assert(row >= 0 && row < m_height);
+    return m_data + static_cast<size_t>(row) * m_stride;
+}
+
+template<typename T>
+inline bool Array2DView<T>::inside(int row, int col) const noexcept
+{
+    return row >= 0 && row < m_height && (col >= 0 && col < m_width);
+}
+
+template<typename T>
+inline bool Array2DView<T>::empty() const noexcept
+{
+    return m_width < 1 || m_height < 1;
+}
+
+/// <summary>
+/// View of a rectangle inside this view
+/// </summary>
+/// <param name="area">Rectangle in the view coordinates</param>
+/// <returns>View with the same stride</returns>
+template<typename T>
+inline Array2DView<T> Array2DView<T>::sub(const Rect& area) const
+{
+    assert(area.left >= 0 && area.right <= m_width);
+    assert(area.top >= 0 && area.bottom <= m_height);
+    assert(area.left <= area.right && area.top <= area.bottom);
+
+    if (area.getWidth() < 1 || area.getHeight() < 1)
+        return Array2DView();
+    return Array2DView((*this)[area.top] + area.left,
+        area.getWidth(), area.getHeight(), m_stride);
+}
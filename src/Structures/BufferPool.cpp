@@ -0,0 +1,359 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "BufferPool.hpp"
+
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cstdlib>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// Create empty pool
+/// </summary>
+/// <param name="capacity">Maximum of cached bytes</param>
+BufferPool::BufferPool(size_t capacity)
+    : m_capacity(capacity), m_cached(0)
+{
+}
+
+BufferPool::~BufferPool()
+{
+    trim();
+}
+
+/// <summary>
+/// Get memory block
+/// </summary>
+/// <param name="bytes">Requested size in bytes</param>
+/// <returns>Page aligned memory block, not initialized</returns>
+/// <exception cref="std::bad_alloc">If out of memory</exception>
+/// <exception cref="IOException">If a scratch file can't be mapped</exception>
+BufferPool::Block BufferPool::acquire(size_t bytes)
+{
+    if (bytes < k_minBytes) {
+        return {::operator new(bytes, std::align_val_t{k_alignment}), bytes};
+    }
+
+    const size_t size = sizeClass(bytes);
+    std::string scratchDir;
+    {
+        // Smallest cached block, which is big enough
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        if (size >= k_scratchBytes)
+            scratchDir = m_scratchDir;
+        const auto it = m_free.lower_bound(size);
+        if (scratchDir.empty() && it != m_free.end()
+            && it->first <= size + size / 2) {
+            const Block block{it->second, it->first};
+            m_free.erase(it);
+            m_cached -= block.bytes;
+            return block;
+        }
+    }
+    if (scratchDir.empty())
+        return {::operator new(size, std::align_val_t{k_alignment}), size};
+
+    // File creation and mapping without the lock
+    void* ptr = mapScratch(scratchDir, size);
+    try {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_mapped.insert(ptr);
+    }
+    catch (...) {
+        unmapScratch(ptr, size);
+        throw;
+    }
+    return {ptr, size};
+}
+
+/// <summary>
+/// Return memory block
+/// </summary>
+/// <param name="block">Block from acquire</param>
+void BufferPool::release(Block block) noexcept
+{
+    if (block.ptr == nullptr) {
+        return;
+    }
+    if (block.bytes >= k_minBytes) {
+        bool mapped = false;
+        {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            mapped = m_mapped.erase(block.ptr) > 0;
+            if (!mapped && m_scratchDir.empty()
+                && m_cached + block.bytes <= m_capacity) {
+                m_free.emplace(block.bytes, block.ptr);
+                m_cached += block.bytes;
+                return;
+            }
+        }
+        if (mapped) {
+            unmapScratch(block.ptr, block.bytes);
+            return;
+        }
+    }
+    ::operator delete(block.ptr, std::align_val_t{k_alignment});
+}
+
+/// <summary>
+/// Give all cached blocks back to the system
+/// </summary>
+void BufferPool::trim() noexcept
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (const auto& [size, ptr] : m_free) {
+        ::operator delete(ptr, std::align_val_t{k_alignment});
+    }
+    m_free.clear();
+    m_cached = 0;
+}
+
+/// <summary>
+/// Set maximum of cached bytes
+/// </summary>
+/// <param name="capacity">Capacity in bytes</param>
+/// <remarks>
+/// Already cached blocks over the capacity are released.
+/// </remarks>
+void BufferPool::setCapacity(size_t capacity) noexcept
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+
+    // Largest blocks first
+    while (m_cached > m_capacity) {
+        const auto it = std::prev(m_free.end());
+        ::operator delete(it->second, std::align_val_t{k_alignment});
+        m_cached -= it->first;
+        m_free.erase(it);
+    }
+}
+
+size_t BufferPool::getCachedBytes() const noexcept
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cached;
+}
+
+/// <summary>
+/// Pool shared by the whole processing pipeline
+/// </summary>
+/// <returns>Global pool</returns>
+/// <remarks>
+/// The cache takes at most a quarter of the memory available
+/// at the start, so it doesn't push the peak into the swap.
+/// It is one pool of the process behind one mutex, not a pool per
+/// thread or pipeline. Only blocks of 256 KiB and more take the lock.
+/// </remarks>
+BufferPool& BufferPool::global()
+{
+    constexpr size_t maxCapacity = size_t{2} << 30; // 2 GiB
+    static BufferPool pool(std::min(maxCapacity, availableMemory() / 4));
+    return pool;
+}
+
+/// <summary>
+/// Physical memory available to new allocations at the moment
+/// </summary>
+/// <returns>Available bytes, zero if not known</returns>
+/// <remarks>
+/// On Linux it is MemAvailable, which counts the page cache the
+/// system gives up on demand. The free pages alone are much less
+/// on a system running for a while.
+/// </remarks>
+size_t BufferPool::availableMemory() noexcept
+{
+#ifdef __linux__
+    try {
+        std::ifstream meminfo("/proc/meminfo");
+        std::string key;
+        size_t kib = 0;
+        while (meminfo >> key >> kib) {
+            if (key == "MemAvailable:")
+                return kib * 1024;
+            meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+    }
+    catch (const std::exception&) {
+    }
+#endif
+#ifdef _WIN32
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status) == 0)
+        return 0;
+    return static_cast<size_t>(status.ullAvailPhys);
+#else
+    const long pages = sysconf(_SC_AVPHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages <= 0 || pageSize <= 0)
+        return 0;
+    return static_cast<size_t>(pages) * static_cast<size_t>(pageSize);
+#endif
+}
+
+
+std::string BufferPool::getScratchDir() const
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return m_scratchDir;
+}
+
+/// <summary>
+/// Set directory for the scratch files
+/// </summary>
+/// <param name="dir">Directory path, empty keeps blocks in memory</param>
+/// <remarks>
+/// Only later allocations are affected. The cached blocks are
+/// released and no more are cached while the directory is set,
+/// so the planes don't come from memory any more.
+/// </remarks>
+void BufferPool::setScratchDir(const std::string& dir)
+{
+    trim();
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    m_scratchDir = dir;
+}
+
+/// <summary>
+/// Advise the system about use of a memory range
+/// </summary>
+/// <param name="ptr">Range begin, rounded down to the page</param>
+/// <param name="bytes">Range size</param>
+/// <param name="advice">Expected use</param>
+/// <remarks>
+/// Only a hint, failures are ignored. Huge pages are advised for
+/// ranges of a huge page and more, before the memory is touched.
+/// </remarks>
+void BufferPool::advise(void* ptr, size_t bytes, Advice advice) noexcept
+{
+#ifndef _WIN32
+    const auto address = reinterpret_cast<uintptr_t>(ptr);
+    const uintptr_t begin = address / k_alignment * k_alignment;
+    bytes += address - begin;
+
+    switch (advice) {
+    case Advice::Sequential:
+        posix_madvise(reinterpret_cast<void*>(begin), bytes,
+            POSIX_MADV_SEQUENTIAL);
+        break;
+    case Advice::WillNeed:
+        posix_madvise(reinterpret_cast<void*>(begin), bytes,
+            POSIX_MADV_WILLNEED);
+        break;
+    case Advice::DontNeed:
+#ifdef MADV_COLD // Keeps the data, unlike MADV_DONTNEED
+        madvise(reinterpret_cast<void*>(begin), bytes, MADV_COLD);
+#endif
+        break;
+    case Advice::HugePages:
+#ifdef MADV_HUGEPAGE
+        if (bytes >= k_hugeBytes)
+            madvise(reinterpret_cast<void*>(begin), bytes, MADV_HUGEPAGE);
+#endif
+        break;
+    }
+#else
+    (void)ptr;
+    (void)bytes;
+    (void)advice;
+#endif
+}
+
+/// <summary>
+/// Map a new temporary file into memory
+/// </summary>
+/// <param name="dir">Directory for the file</param>
+/// <param name="bytes">File size</param>
+/// <returns>Page aligned writable mapping</returns>
+/// <remarks>
+/// The file is deleted right away, or on close on Windows,
+/// so it never outlives the process.
+/// </remarks>
+void* BufferPool::mapScratch(const std::string& dir, size_t bytes)
+{
+    constexpr const char* kModuleName = "BufferPool";
+#ifdef _WIN32
+    char fileName[MAX_PATH];
+    if (GetTempFileNameA(dir.c_str(), "rdv", 0, fileName) == 0)
+        throw IOException(kModuleName, dir, "Could not create scratch file");
+
+    HANDLE file = CreateFileA(fileName, GENERIC_READ | GENERIC_WRITE, 0,
+        nullptr, CREATE_ALWAYS,
+        FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw IOException(kModuleName, fileName, "Could not open scratch file");
+
+    const uint64_t size = bytes;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+    CloseHandle(file); // Mapping holds the file
+    if (mapping == nullptr)
+        throw IOException(kModuleName, fileName, "Could not map scratch file");
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, bytes);
+    CloseHandle(mapping); // View holds the mapping
+    if (view == nullptr)
+        throw IOException(kModuleName, fileName, "Could not map scratch file");
+    return view;
+#else
+    std::string fileName = dir + "/RawDev-XXXXXX";
+    const int fd = mkstemp(fileName.data());
+    if (fd < 0)
+        throw IOException(kModuleName, dir, "Could not create scratch file");
+    unlink(fileName.c_str()); // Mapping holds the file
+
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+    {
+        ::close(fd);
+        throw IOException(kModuleName, dir, "Could not size scratch file");
+    }
+    void* view = mmap(nullptr, bytes,
+        PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+        throw IOException(kModuleName, dir, "Could not map scratch file");
+    return view;
+#endif
+}
+
+void BufferPool::unmapScratch(void* ptr, size_t bytes) noexcept
+{
+#ifdef _WIN32
+    (void)bytes;
+    UnmapViewOfFile(ptr);
+#else
+    munmap(ptr, bytes);
+#endif
+}
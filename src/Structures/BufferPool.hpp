@@ -0,0 +1,115 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "NonCopyable.hpp"
+
+/// <summary>
+/// Cache of large aligned memory blocks
+/// </summary>
+/// <remarks>
+/// Freed blocks are kept by their size and given out again to the
+/// allocations, which fit into them with at most half of the request
+/// unused. Processing images of the same size one after another then
+/// needs no new memory from the system. Small blocks are not cached.
+///
+/// With a scratch directory set, the large blocks are mapped from
+/// temporary files in it instead. The system then writes the pages
+/// out under memory pressure, so the resident memory stays bounded.
+/// No blocks are cached then, as they would stay resident.
+/// </remarks>
+class BufferPool : NonCopyable {
+public:
+    static constexpr size_t k_alignment = 4096;      // Page aligned
+    static constexpr size_t k_minBytes = 256 * 1024; // Smaller not pooled
+    static constexpr size_t k_classBytes = 64 * 1024;
+    static constexpr size_t k_hugeBytes = 2 * 1024 * 1024; // Huge page
+    static constexpr size_t k_scratchBytes = 16 * 1024 * 1024;
+
+    /// <summary>
+    /// Expected use of a memory range
+    /// </summary>
+    enum class Advice {
+        Sequential, // Read ahead and drop behind
+        WillNeed,   // Read in soon
+        DontNeed,   // Not used soon, paged out first
+        HugePages   // Back with transparent huge pages
+    };
+
+    /// <summary>
+    /// Memory block with its real size
+    /// </summary>
+    struct Block {
+        void* ptr;
+        size_t bytes;
+    };
+
+    explicit BufferPool(size_t capacity);
+    ~BufferPool();
+
+    Block acquire(size_t bytes);
+    void release(Block block) noexcept;
+    void trim() noexcept;
+
+    size_t getCapacity() const noexcept;
+    void setCapacity(size_t capacity) noexcept;
+    size_t getCachedBytes() const noexcept;
+    std::string getScratchDir() const;
+    void setScratchDir(const std::string& dir);
+
+    static BufferPool& global();
+    static size_t availableMemory() noexcept;
+    static size_t sizeClass(size_t bytes) noexcept;
+    static void advise(void* ptr, size_t bytes, Advice advice) noexcept;
+
+private:
+    static void* mapScratch(const std::string& dir, size_t bytes);
+    static void unmapScratch(void* ptr, size_t bytes) noexcept;
+
+    mutable std::mutex m_mutex;
+    std::multimap<size_t, void*> m_free; // Free blocks by size
+    std::set<void*> m_mapped; // Blocks mapped from scratch files
+    std::string m_scratchDir;
+    size_t m_capacity, m_cached;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline size_t BufferPool::getCapacity() const noexcept
+{
+    return m_capacity;
+}
+
+/// <summary>
+/// Size of the block used for the allocation
+/// </summary>
+/// <param name="bytes">Requested bytes</param>
+/// <returns>Bytes rounded up to the size class</returns>
+inline size_t BufferPool::sizeClass(size_t bytes) noexcept
+{
+    return (bytes + k_classBytes - 1) / k_classBytes * k_classBytes;
+}
@@ -31,6 +31,7 @@ HSVMap::HSVMap(int hueDim, int satDim, int valDim, const HSV64Scale* data)
     m_mapData = std::make_unique<HSV64Scale[]>(mapSize);
     mapSize *= sizeof(HSV64Scale); // Compute map size in bytes
     Utils::memoryCopy(m_mapData.get(), data, mapSize);
+    makeSingle();
 }
 
 /*
@@ -71,6 +72,21 @@ HSVMap::HSVMap(
             m_mapData[c] = val;
         }
     }
+    makeSingle();
+}
+
+/*
+Single precision copy of the map
+*/
+void HSVMap::makeSingle()
+{
+    const int mapSize = m_hueDim * m_satDim * m_valDim;
+    m_mapData32 = std::make_unique<HSV32Scale[]>(mapSize);
+    for (int c = 0; c < mapSize; c++) {
+        m_mapData32[c] = {static_cast<float>(m_mapData[c].hueShift),
+            static_cast<float>(m_mapData[c].satScale),
+            static_cast<float>(m_mapData[c].valScale)};
+    }
 }
 
 /*
@@ -90,28 +106,29 @@ inline void HSVMap::MakeOrderedIllu(
 /*
 Transformation with a camera profile
 */
-void HSVMap::transform(Color::HSV64& hsv) const
+template<typename T>
+void HSVMap::transform(Color::BasicHSV<T>& hsv) const
 {
     // Hue coordinates
     const auto lasthue = m_hueDim - 1;
     const int h = static_cast<int>(hsv.hue * lasthue);
-    const double h0 = static_cast<double>(h) / lasthue;
-    const double hd = (hsv.hue - h0) * m_hueDim;
+    const T h0 = static_cast<T>(h) / lasthue;
+    const T hd = (hsv.hue - h0) * m_hueDim;
 
     // Sat coordinates
     const auto lastsat = m_satDim - 1;
     const int s = static_cast<int>(hsv.sat * lastsat);
-    const double s0 = static_cast<double>(s) / lastsat;
-    const double sd = (hsv.sat - s0) * m_satDim;
+    const T s0 = static_cast<T>(s) / lastsat;
+    const T sd = (hsv.sat - s0) * m_satDim;
 
     // Value coordinates
     const auto lastval = m_valDim - 1;
     const int v = static_cast<int>(hsv.val * lastval);
-    const double v0 = static_cast<double>(v) / lastval;
-    const double vd = (hsv.val - v0) * m_valDim;
+    const T v0 = static_cast<T>(v) / lastval;
+    const T vd = (hsv.val - v0) * m_valDim;
 
     // Interpolate between slices of the HSV cube
-    HSV64Scale trans = interSlice(h, s, v, hd, sd);
+    BasicScale<T> trans = interSlice(h, s, v, hd, sd);
     if (v + 1 < m_valDim) {
         InterScales(trans, interSlice(h, s, v + 1, hd, sd), vd);
     }
@@ -121,35 +138,37 @@ void HSVMap::transform(Color::HSV64& hsv) const
 /*
 Apply scaling to the value
 */
-void HSVMap::Scale(const HSV64Scale& scale, Color::HSV64& val)
+template<typename T>
+void HSVMap::Scale(const BasicScale<T>& scale, Color::BasicHSV<T>& val)
 {
     val.hue += scale.hueShift / 360;
-    if (val.hue > 1.0) {
-        val.hue -= 1.0;
+    if (val.hue > 1) {
+        val.hue -= 1;
     }
-    else if (val.hue < 0.0) {
-        val.hue += 1.0;
+    else if (val.hue < 0) {
+        val.hue += 1;
     }
-    val.sat = std::clamp(val.sat * scale.satScale, 0.0, 1.0);
-    val.val = std::clamp(val.val * scale.valScale, 0.0, 1.0);
+    val.sat = std::clamp<T>(val.sat * scale.satScale, 0, 1);
+    val.val = std::clamp<T>(val.val * scale.valScale, 0, 1);
 }
 
 /*
 Bilinear interpolation on a HSV cube slice
 */
-HSVMap::HSV64Scale
-HSVMap::interSlice(int h, int s, int v, double hd, double sd) const
+template<typename T>
+HSVMap::BasicScale<T>
+HSVMap::interSlice(int h, int s, int v, T hd, T sd) const
 {
-    HSV64Scale c00 = map(h, s, v);
+    BasicScale<T> c00 = map<T>(h, s, v);
     if (s + 1 < m_satDim) { // Interpolate (x direction)
-        InterScales(c00, map(h, s + 1, v), sd);
+        InterScales(c00, map<T>(h, s + 1, v), sd);
     }
     h++; // Next hue (y shift)
 
     if (h < m_hueDim) {
-        HSV64Scale c10 = map(h, s, v);
+        BasicScale<T> c10 = map<T>(h, s, v);
         if (s + 1 < m_satDim) { // Interpolate (x direction)
-            InterScales(c10, map(h, s + 1, v), sd);
+            InterScales(c10, map<T>(h, s + 1, v), sd);
         }
         // Interpolate c00 and c10 (y direction)
         InterScales(c00, c10, hd);
@@ -160,10 +179,15 @@ HSVMap::interSlice(int h, int s, int v, double hd, double sd) const
 /*
 Interpolate between two HSV scaling values
 */
+template<typename T>
 inline void HSVMap::InterScales(
-    HSV64Scale& sc0, const HSV64Scale& sc1, const double slope)
+    BasicScale<T>& sc0, const BasicScale<T>& sc1, const T slope)
 {
     sc0.hueShift = (sc0.hueShift + (sc1.hueShift - sc0.hueShift) * slope);
     sc0.satScale = (sc0.satScale + (sc1.satScale - sc0.satScale) * slope);
     sc0.valScale = (sc0.valScale + (sc1.valScale - sc0.valScale) * slope);
 }
+
+// Double and single precision computation
+template void HSVMap::transform(Color::HSV64&) const;
+template void HSVMap::transform(Color::HSV32&) const;
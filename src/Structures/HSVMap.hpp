@@ -22,43 +22,59 @@
 
 #include <cassert>
 #include <memory>
+#include <type_traits>
 
 #include "Color.hpp"
 
 class HSVMap {
 public:
-    // Scale HSV in double precission
-    struct HSV64Scale {
-        double hueShift, satScale, valScale;
+    template<typename T>
+    struct BasicScale {
+        T hueShift, satScale, valScale;
     };
 
+    // Scale HSV in double and single precission
+    using HSV64Scale = BasicScale<double>;
+    using HSV32Scale = BasicScale<float>;
+
     HSVMap(int hueDim, int satDim, int valDim, const HSV64Scale* data);
     HSVMap(int hueDim, int satDim, int valDim,
         const HSV64Scale* data1, double illu1,
         const HSV64Scale* data2, double illu2,
         double temperature);
-    void transform(Color::HSV64& hsv) const;
+    template<typename T>
+    void transform(Color::BasicHSV<T>& hsv) const;
 
 private:
-    [[nodiscard]] HSV64Scale map(int h, int s, int v) const;
-    [[nodiscard]] HSV64Scale interSlice(int, int, int, double, double) const;
-    static void InterScales(HSV64Scale&, const HSV64Scale&, double);
+    template<typename T>
+    [[nodiscard]] BasicScale<T> map(int h, int s, int v) const;
+    template<typename T>
+    [[nodiscard]] BasicScale<T> interSlice(int, int, int, T, T) const;
+    template<typename T>
+    static void InterScales(BasicScale<T>&, const BasicScale<T>&, T);
     static void MakeOrderedIllu(const HSV64Scale*& data1, double& illu1,
         const HSV64Scale*& data2, double& illu2);
-    static void Scale(const HSV64Scale& scale, Color::HSV64& val);
+    template<typename T>
+    static void Scale(const BasicScale<T>& scale, Color::BasicHSV<T>& val);
+    void makeSingle();
 
     int m_hueDim, m_satDim, m_valDim;
     std::unique_ptr<HSV64Scale[]> m_mapData;
+    std::unique_ptr<HSV32Scale[]> m_mapData32; // Copy for float computation
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
-inline HSVMap::HSV64Scale HSVMap::map(int h, int s, int v) const
+template<typename T>
+inline HSVMap::BasicScale<T> HSVMap::map(int h, int s, int v) const
 {
     assert(h >= 0 && h < m_hueDim);
     assert(s >= 0 && s < m_satDim);
     assert(v >= 0 && v < m_valDim);
 
     const int offset = m_satDim * (v * m_hueDim + h) + s;
-    return m_mapData[offset];
+    if constexpr (std::is_same_v<T, float>)
+        return m_mapData32[offset];
+    else
+        return m_mapData[offset];
 }
@@ -0,0 +1,111 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cinttypes>
+
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#define RAWDEV_HAS_F16C
+#endif
+
+/// <summary>
+/// IEEE 754 half precision number for storage only
+/// </summary>
+/// <remarks>
+/// There is no arithmetic, the values are converted to float and back.
+/// With F16C the conversion uses the hardware instructions, otherwise
+/// it rounds to nearest even in software with the same results.
+/// </remarks>
+struct Half {
+    uint16_t bits;
+
+    static Half fromFloat(float value) noexcept;
+    float toFloat() const noexcept;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// <summary>
+/// Round float to the nearest half
+/// </summary>
+/// <param name="value">Float value</param>
+/// <returns>Half value, infinity when out of range</returns>
+inline Half Half::fromFloat(float value) noexcept
+{
+#ifdef RAWDEV_HAS_F16C
+    return {static_cast<uint16_t>(
+        _cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT))};
+#else
+    constexpr uint32_t f32infty = 255u << 23;
+    constexpr uint32_t f16max = (127u + 16u) << 23;
+    constexpr uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    const uint32_t sign = bits & 0x8000'0000u;
+    uint16_t result;
+
+    bits ^= sign;
+    if (bits >= f16max) { // Infinity or NaN
+        result = (bits > f32infty) ? 0x7E00 : 0x7C00;
+    }
+    else if (bits < (113u << 23)) { // Subnormal or zero
+        // Float addition rounds the mantissa bits into place
+        const float sum = std::bit_cast<float>(bits)
+            + std::bit_cast<float>(denormMagic);
+        result = static_cast<uint16_t>(
+            std::bit_cast<uint32_t>(sum) - denormMagic);
+    }
+    else {
+        const uint32_t mantOdd = (bits >> 13) & 1u;
+        bits += ((15u - 127u) << 23) + 0xFFFu; // Rebias and round
+        bits += mantOdd; // Ties to even
+        result = static_cast<uint16_t>(bits >> 13);
+    }
+    return {static_cast<uint16_t>(result | (sign >> 16))};
+#endif
+}
+
+/// <summary>
+/// Exact conversion to float
+/// </summary>
+inline float Half::toFloat() const noexcept
+{
+#ifdef RAWDEV_HAS_F16C
+    return _cvtsh_ss(bits);
+#else
+    constexpr uint32_t shiftedExp = 0x7C00u << 13;
+    uint32_t result = (bits & 0x7FFFu) << 13; // Exponent and mantissa
+    const uint32_t exp = result & shiftedExp;
+
+    result += (127u - 15u) << 23; // Rebias the exponent
+    if (exp == shiftedExp) { // Infinity or NaN
+        result += (128u - 16u) << 23;
+    }
+    else if (exp == 0) { // Zero or subnormal, renormalize
+        result += 1u << 23;
+        result = std::bit_cast<uint32_t>(std::bit_cast<float>(result)
+            - std::bit_cast<float>(113u << 23));
+    }
+    return std::bit_cast<float>(result | ((bits & 0x8000u) << 16));
+#endif
+}
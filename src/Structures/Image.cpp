@@ -22,28 +22,45 @@
 #include "Exception.hpp"
 #include "Image.hpp"
 #include "ImageIO/CR2Reader.hpp"
+#include "ImageIO/RawSink.hpp"
 #include "Path.hpp"
 #include "Rect.hpp"
 
 #include <sstream>
 #include <omp.h>
 
+/// <summary>
+/// Store raw data from the reader straight into image channels
+/// </summary>
+class Image::RawStore : public RawSink
+{
+    Image& m_img;
+    const CFAPattern m_cfa;
+
+public:
+    explicit RawStore(Image& img);
+    void allocate(int width, int height) override;
+    void store(int row, int col, const uint16_t* data, int len) override;
+};
+
 /// <summary>
 /// Load image from Canon CR2 raw file
 /// </summary>
 /// <param name="inputFile">Path to the input file</param>
+/// <param name="temp">Color temperature for the camera profile</param>
+/// <param name="decodeIndex">Use decode index sidecar file</param>
 /// <exception cref="IOException, FormatException">
 /// In case of errors IOException or Format exception is thrown.
 /// </exception>
-void Image::loadCR2(const Path& inputFile, double temp)
+void Image::loadCR2(const Path& inputFile, double temp, bool decodeIndex)
 {
     CR2Reader file(inputFile);
+    file.setDecodeIndex(decodeIndex);
     file.open(); // Open and store metadata
     setupMetadata(file, temp);
 
-    Array2D<uint16_t> raw;
-    file.read(raw);    // Load the main image data
-    storeRawData(raw); // Store raw data into image
+    RawStore store(*this); // Store raw data into image
+    file.read(store);      // Load the main image data
     file.close();
 }
 
@@ -69,41 +86,105 @@ void Image::setupMetadata(const CR2Reader& file, double temp)
     }
 }
 
+inline Image::RawStore::RawStore(Image& img)
+    : m_img(img), m_cfa(img.m_CamProfile->getCFAPattern())
+{
+}
+
 /// <summary>
-/// Store read raw data into image
+/// Allocate the mosaic for the raw data
 /// </summary>
-/// <param name="img">Source raw image data</param>
-void Image::storeRawData(Array2D<uint16_t>& img)
-{
-    const CFAPattern cfa = m_CamProfile->getCFAPattern();
-    const int width = img.getWidth(), height = img.getHeight();
-
-    // Allocate image channel data
-    m_red = Array2D<double>(width, height, 0);
-    m_green = Array2D<double>(width, height, 0);
-    m_blue = Array2D<double>(width, height, 0);
-
-    #pragma omp parallel for
-    for (int row = 0; row < height; row++) {
-        for (int col = 0; col < width; col++) {
-            const double value = static_cast<double>(img[row][col]);
-
-            switch (cfa(row, col)) {
-            case CFAPattern::Color::RED:
-                m_red[row][col] = value;
-                break;
-            case CFAPattern::Color::BLUE:
-                m_blue[row][col] = value;
-                break;
-            default: // GREEN_R || GREEN_B
-                m_green[row][col] = value;
-                break;
-            }
-            // Do not call setValue method as this would
-            // normalize to range 0.0-1.0 and discart RAW
-            // values resulting in black image.
-        }
-    }
+/// <param name="width">Raw image width</param>
+/// <param name="height">Raw image height</param>
+void Image::RawStore::allocate(int width, int height)
+{
+    m_img.m_red = Plane();
+    m_img.m_green = Plane();
+    m_img.m_blue = Plane();
+    m_img.m_mosaic = Mosaic(m_cfa);
+    m_img.m_mosaic.allocateRaw(width, height);
+}
+
+/// <summary>
+/// Store a run of raw values into the mosaic
+/// </summary>
+/// <param name="row">Image row</param>
+/// <param name="col">First image column</param>
+/// <param name="data">Raw values</param>
+/// <param name="len">Number of values</param>
+void Image::RawStore::store(int row, int col, const uint16_t* data, int len)
+{
+    std::copy(data, data + len, m_img.m_mosaic.getRawRow(row) + col);
+}
+
+/// <summary>
+/// Allocate RGB channels for the demosaicing of the mosaic
+/// </summary>
+/// <param name="mosaic">Source CFA data</param>
+/// <remarks>
+/// The channels have the size and precision of the mosaic and are
+/// not initialised, the algorithm writes every pixel.
+/// </remarks>
+void Image::allocateRGB(const Mosaic& mosaic)
+{
+    assert(mosaic.isScaled());
+    allocateRGB(mosaic.getWidth(), mosaic.getHeight(), mosaic.getPrecision());
+}
+
+/// <summary>
+/// Allocate RGB channels without initialisation
+/// </summary>
+/// <param name="width">Image width</param>
+/// <param name="height">Image height</param>
+/// <param name="precision">Channel precision</param>
+/// <remarks>
+/// Pages are placed by the first write, so the caller must fill
+/// all pixels.
+/// </remarks>
+void Image::allocateRGB(int width, int height, Precision precision)
+{
+    constexpr Array2DPolicy policy = Array2DPolicy::Lazy;
+    m_red = Plane(width, height, precision, policy);
+    m_green = Plane(width, height, precision, policy);
+    m_blue = Plane(width, height, precision, policy);
+}
+
+/// <summary>
+/// Advise the system about use of the RGB planes
+/// </summary>
+/// <param name="advice">Expected use</param>
+void Image::advise(BufferPool::Advice advice) const
+{
+    advise(advice, 0, getHeight());
+    return;
+}
+
+/// <summary>
+/// Advise the system about use of the RGB plane rows
+/// </summary>
+/// <param name="advice">Expected use</param>
+/// <param name="top">First row</param>
+/// <param name="bottom">Row after the last one</param>
+/// <remarks>
+/// Helps, when the planes are mapped from scratch files.
+/// </remarks>
+void Image::advise(BufferPool::Advice advice, int top, int bottom) const
+{
+    m_red.advise(advice, top, bottom);
+    m_green.advise(advice, top, bottom);
+    m_blue.advise(advice, top, bottom);
+    return;
+}
+
+/// <summary>
+/// Area of the image that goes to the output
+/// </summary>
+/// <param name="noCrop">Whole image instead of the camera crop</param>
+Rect Image::getOutputArea(bool noCrop) const
+{
+    if (noCrop == true)
+        return Rect::Create(Point(0, 0), getWidth(), getHeight());
+    return m_CamProfile->getCrop();
 }
 
 /// <summary>
@@ -115,46 +196,99 @@ void Image::storeRawData(Array2D<uint16_t>& img)
 /// </remarks>
 void Image::convert16(Array2D<Color::RGB16>& img16, bool noCrop) const
 {
-    Rect crop; // Current used crop
-    if (noCrop == true)
-        crop = Rect::Create(Point(0, 0), getWidth(), getHeight());
-    else
-        crop = m_CamProfile->getCrop();
+    const Rect crop = getOutputArea(noCrop); // Current used crop
 
     // Alloc new croped image
     img16 = Array2D<Color::RGB16>(crop.getWidth(), crop.getHeight());
+    convert16(img16.view(), Point(crop.left, crop.top));
+    return;
+}
 
-    #pragma omp parallel for
-    for (int row = crop.top; row < crop.bottom; row++) {
-        for (int col = crop.left; col < crop.right; col++) {
-            int xrow = row - crop.top, xcol = col - crop.left;
-
-            img16[xrow][xcol].r = Image::doubleTo16(m_red[row][col]);
-            img16[xrow][xcol].g = Image::doubleTo16(m_green[row][col]);
-            img16[xrow][xcol].b = Image::doubleTo16(m_blue[row][col]);
-        }
-    }
+/// <summary>
+/// Convert a rectangle of the image into a 16bit RGB view
+/// </summary>
+/// <param name="dst">Output view, its size gives the rectangle size</param>
+/// <param name="origin">Left top corner of the rectangle in the image</param>
+void Image::convert16(Array2DView<Color::RGB16> dst, Point origin) const
+{
+    dispatchPrecision(getPrecision(), [&]<typename T>() {
+        convertRows<T>(dst, origin);
+    });
+    return;
 }
 
 void Image::convert8(Array2D<Color::RGB8>& img8, bool noCrop) const
 {
-    Rect crop; // Current used crop
-    if (noCrop == true)
-        crop = Rect::Create(Point(0, 0), getWidth(), getHeight());
-    else
-        crop = m_CamProfile->getCrop();
+    const Rect crop = getOutputArea(noCrop); // Current used crop
 
     // Alloc new croped image
     img8 = Array2D<Color::RGB8>(crop.getWidth(), crop.getHeight());
+    convert8(img8.view(), Point(crop.left, crop.top));
+    return;
+}
+
+void Image::convert8(Array2DView<Color::RGB8> dst, Point origin) const
+{
+    dispatchPrecision(getPrecision(), [&]<typename T>() {
+        convertRows<T>(dst, origin);
+    });
+    return;
+}
+
+/// <summary>
+/// Convert rows of the planes into a 16bit RGB view
+/// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="dst">Output view, its size gives the rectangle size</param>
+/// <param name="origin">Left top corner of the rectangle in the image</param>
+template<typename T>
+void Image::convertRows(Array2DView<Color::RGB16> dst, Point origin) const
+{
+    #pragma omp parallel
+    {
+        const int width = dst.getWidth();
+        Array2D<T> rgb(width, 3);
 
-    #pragma omp parallel for
-    for (int row = crop.top; row < crop.bottom; row++) {
-        for (int col = crop.left; col < crop.right; col++) {
-            int xrow = row - crop.top, xcol = col - crop.left;
+        #pragma omp for
+        for (int xrow = 0; xrow < dst.getHeight(); xrow++) {
+            Color::RGB16* out = dst[xrow];
+            getRow(origin.y + xrow, origin.x, width, rgb[0], rgb[1], rgb[2]);
 
-            img8[xrow][xcol].r = Image::doubleTo8(m_red[row][col]);
-            img8[xrow][xcol].g = Image::doubleTo8(m_green[row][col]);
-            img8[xrow][xcol].b = Image::doubleTo8(m_blue[row][col]);
+            for (int xcol = 0; xcol < width; xcol++) {
+                out[xcol].r = Image::valueTo16(rgb[0][xcol]);
+                out[xcol].g = Image::valueTo16(rgb[1][xcol]);
+                out[xcol].b = Image::valueTo16(rgb[2][xcol]);
+            }
+        }
+    }
+    return;
+}
+
+/// <summary>
+/// Convert rows of the planes into a 8bit RGB view
+/// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="dst">Output view, its size gives the rectangle size</param>
+/// <param name="origin">Left top corner of the rectangle in the image</param>
+template<typename T>
+void Image::convertRows(Array2DView<Color::RGB8> dst, Point origin) const
+{
+    #pragma omp parallel
+    {
+        const int width = dst.getWidth();
+        Array2D<T> rgb(width, 3);
+
+        #pragma omp for
+        for (int xrow = 0; xrow < dst.getHeight(); xrow++) {
+            Color::RGB8* out = dst[xrow];
+            getRow(origin.y + xrow, origin.x, width, rgb[0], rgb[1], rgb[2]);
+
+            for (int xcol = 0; xcol < width; xcol++) {
+                out[xcol].r = Image::valueTo8(rgb[0][xcol]);
+                out[xcol].g = Image::valueTo8(rgb[1][xcol]);
+                out[xcol].b = Image::valueTo8(rgb[2][xcol]);
+            }
         }
     }
+    return;
 }
@@ -27,6 +27,7 @@
 #include "NonCopyable.hpp"
 #include "Color.hpp"
 #include "Array2D.hpp"
+#include "Mosaic.hpp"
 
 class CamProfile;
 class CR2Reader;
@@ -42,88 +43,133 @@ public:
     };
 
     Image() = default;
+    explicit Image(std::shared_ptr<CamProfile> profile);
     Image(const Image&);
-    void loadCR2(const Path& inputFile, double temp);
+    void loadCR2(const Path& inputFile, double temp, bool decodeIndex = false);
 
-    Color::RGB64 getValue(int, int) const;
+    template<typename T = double>
+    Color::BasicRGB<T> getValue(int, int) const;
+    template<typename T>
+    void setValue(int, int, Color::BasicRGB<T>);
     void setValue(int, int, Color::RGB64);
-    double getValueR(int, int) const;
-    double getValueG(int, int) const;
-    double getValueB(int, int) const;
-    double getValueX(int, int, Channel) const;
+    template<typename T>
+    void getRow(int row, int col, int count, T* r, T* g, T* b) const;
+    template<typename T>
+    void setRow(int row, int col, int count, T* r, T* g, T* b);
+    template<typename T = double>
+    T getValueR(int, int) const;
+    template<typename T = double>
+    T getValueG(int, int) const;
+    template<typename T = double>
+    T getValueB(int, int) const;
+    template<typename T = double>
+    T getValueX(int, int, Channel) const;
     std::shared_ptr<CamProfile> getCamProfile() const;
+    void setCamProfile(std::shared_ptr<CamProfile> profile);
+    const Mosaic& getMosaic() const;
+    Mosaic& getMosaic();
+    Mosaic takeMosaic();
+    void allocateRGB(const Mosaic& mosaic);
+    void allocateRGB(int width, int height, Precision precision);
 
     int getWidth(void) const;
     int getHeight(void) const;
+    Precision getPrecision() const;
+    void advise(BufferPool::Advice advice) const;
+    void advise(BufferPool::Advice advice, int top, int bottom) const;
 
+    Rect getOutputArea(bool noCrop) const;
     void convert16(Array2D<Color::RGB16>& img16, bool noCrop) const;
+    void convert16(Array2DView<Color::RGB16> dst, Point origin) const;
     void convert8(Array2D<Color::RGB8>& img8, bool noCrop) const;
-    static double clipDouble(double);
+    void convert8(Array2DView<Color::RGB8> dst, Point origin) const;
+    template<typename T>
+    static T clip(T);
 
 private:
+    class RawStore;
+
     void setupMetadata(const CR2Reader& file, double temp);
-    void storeRawData(Array2D<uint16_t>& img);
-    static uint16_t doubleTo16(const double val);
-    static uint8_t doubleTo8(const double val);
+    template<typename T>
+    void convertRows(Array2DView<Color::RGB16> dst, Point origin) const;
+    template<typename T>
+    void convertRows(Array2DView<Color::RGB8> dst, Point origin) const;
+    template<typename T>
+    static uint16_t valueTo16(const T val);
+    template<typename T>
+    static uint8_t valueTo8(const T val);
 
-    Array2D<double> m_red, m_green, m_blue;
+    Mosaic m_mosaic; // CFA data before demosaicing
+    Plane m_red, m_green, m_blue; // Demosaiced channels
     std::shared_ptr<CamProfile> m_CamProfile;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 inline Image::Image(const Image& src)
-    : m_red(src.m_red), m_green(src.m_green), m_blue(src.m_blue),
+    : m_mosaic(src.m_mosaic),
+      m_red(src.m_red), m_green(src.m_green), m_blue(src.m_blue),
       m_CamProfile(src.m_CamProfile)
 {
 }
 
-inline Color::RGB64 Image::getValue(int row, int col) const
+inline Image::Image(std::shared_ptr<CamProfile> profile)
+    : m_CamProfile(std::move(profile))
+{
+}
+
+template<typename T>
+inline Color::BasicRGB<T> Image::getValue(int row, int col) const
 {
     assert(row >= 0 && row < getHeight());
     assert(col >= 0 && col < getWidth());
 
-    Color::RGB64 value{m_red[row][col], m_green[row][col], m_blue[row][col]};
+    Color::BasicRGB<T> value{m_red.get<T>(row, col),
+        m_green.get<T>(row, col), m_blue.get<T>(row, col)};
     return value;
 }
 
-inline double Image::getValueR(int row, int col) const
+template<typename T>
+inline T Image::getValueR(int row, int col) const
 {
     assert(row >= 0 && row < getHeight());
     assert(col >= 0 && col < getWidth());
-    return m_red[row][col];
+    return m_red.get<T>(row, col);
 }
 
-inline double Image::getValueG(int row, int col) const
+template<typename T>
+inline T Image::getValueG(int row, int col) const
 {
     assert(row >= 0 && row < getHeight());
     assert(col >= 0 && col < getWidth());
-    return m_green[row][col];
+    return m_green.get<T>(row, col);
 }
 
-inline double Image::getValueB(int row, int col) const
+template<typename T>
+inline T Image::getValueB(int row, int col) const
 {
     assert(row >= 0 && row < getHeight());
     assert(col >= 0 && col < getWidth());
-    return m_blue[row][col];
+    return m_blue.get<T>(row, col);
 }
 
 /*
 Return sensor value from bayer pattern
 */
-inline double Image::getValueX(int row, int col, Channel ch) const
+template<typename T>
+inline T Image::getValueX(int row, int col, Channel ch) const
 {
     assert(row >= 0 && row < getHeight());
     assert(col >= 0 && col < getWidth());
     switch (ch) {
     case Channel::RED:
-        return m_red[row][col];
+        return m_red.get<T>(row, col);
     case Channel::BLUE:
-        return m_blue[row][col];
+        return m_blue.get<T>(row, col);
     default:
         break;
     }
-    return m_green[row][col];
+    return m_green.get<T>(row, col);
 }
 
 inline std::shared_ptr<CamProfile> Image::getCamProfile() const
@@ -131,14 +177,98 @@ inline std::shared_ptr<CamProfile> Image::getCamProfile() const
     return m_CamProfile;
 }
 
-inline void Image::setValue(int row, int col, Color::RGB64 value)
+inline void Image::setCamProfile(std::shared_ptr<CamProfile> profile)
+{
+    m_CamProfile = std::move(profile);
+}
+
+inline const Mosaic& Image::getMosaic() const
+{
+    return m_mosaic;
+}
+
+inline Mosaic& Image::getMosaic()
+{
+    return m_mosaic;
+}
+
+inline Mosaic Image::takeMosaic()
+{
+    Mosaic mosaic = std::move(m_mosaic);
+    m_mosaic.clear();
+    return mosaic;
+}
+
+template<typename T>
+inline void Image::setValue(int row, int col, Color::BasicRGB<T> value)
 {
     assert(row >= 0 && row < getHeight());
     assert(col >= 0 && col < getWidth());
 
-    m_red[row][col] = Image::clipDouble(value.r);
-    m_green[row][col] = Image::clipDouble(value.g);
-    m_blue[row][col] = Image::clipDouble(value.b);
+    m_red.set(row, col, Image::clip(value.r));
+    m_green.set(row, col, Image::clip(value.g));
+    m_blue.set(row, col, Image::clip(value.b));
+    return;
+}
+
+inline void Image::setValue(int row, int col, Color::RGB64 value)
+{
+    setValue<double>(row, col, value);
+    return;
+}
+
+/// <summary>
+/// Get a run of row values
+/// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="row">Image row</param>
+/// <param name="col">First column</param>
+/// <param name="count">Number of values</param>
+/// <param name="r">Red values</param>
+/// <param name="g">Green values</param>
+/// <param name="b">Blue values</param>
+template<typename T>
+inline void Image::getRow(
+    int row, int col, int count, T* r, T* g, T* b) const
+{
+    assert(row >= 0 && row < getHeight());
+    assert(col >= 0 && col + count <= getWidth());
+
+    m_red.getRow(row, col, count, r);
+    m_green.getRow(row, col, count, g);
+    m_blue.getRow(row, col, count, b);
+    return;
+}
+
+/// <summary>
+/// Set a run of row values
+/// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="row">Image row</param>
+/// <param name="col">First column</param>
+/// <param name="count">Number of values</param>
+/// <param name="r">Red values</param>
+/// <param name="g">Green values</param>
+/// <param name="b">Blue values</param>
+/// <remarks>
+/// Like setValue the values are clipped, which is done in the buffers.
+/// </remarks>
+template<typename T>
+inline void Image::setRow(
+    int row, int col, int count, T* r, T* g, T* b)
+{
+    assert(row >= 0 && row < getHeight());
+    assert(col >= 0 && col + count <= getWidth());
+
+    #pragma omp simd
+    for (int i = 0; i < count; i++) {
+        r[i] = Image::clip(r[i]);
+        g[i] = Image::clip(g[i]);
+        b[i] = Image::clip(b[i]);
+    }
+    m_red.setRow(row, col, count, r);
+    m_green.setRow(row, col, count, g);
+    m_blue.setRow(row, col, count, b);
     return;
 }
 
@@ -146,27 +276,38 @@ inline int Image::getWidth(void) const
 {
     assert(m_red.getWidth() == m_green.getWidth() &&
            m_green.getWidth() == m_blue.getWidth());
-    return m_red.getWidth();
+    return m_red.empty() ? m_mosaic.getWidth() : m_red.getWidth();
 }
 
 inline int Image::getHeight(void) const
 {
     assert(m_red.getHeight() == m_green.getHeight() &&
            m_green.getHeight() == m_blue.getHeight());
-    return m_red.getHeight();
+    return m_red.empty() ? m_mosaic.getHeight() : m_red.getHeight();
+}
+
+/// <summary>
+/// Precision of the RGB planes, or of the mosaic before demosaicing
+/// </summary>
+inline Precision Image::getPrecision() const
+{
+    return m_red.empty() ? m_mosaic.getPrecision() : m_red.getPrecision();
 }
 
-inline double Image::clipDouble(double value)
+template<typename T>
+inline T Image::clip(T value)
 {
-    return std::max(0.0, std::min(value, 1.0));
+    return std::max(T(0), std::min(value, T(1)));
 }
 
-inline uint16_t Image::doubleTo16(const double val)
+template<typename T>
+inline uint16_t Image::valueTo16(const T val)
 {
-    return static_cast<uint16_t>(floor(65535.0 * val));
+    return static_cast<uint16_t>(std::floor(T(65535) * val));
 }
 
-inline uint8_t Image::doubleTo8(const double val)
+template<typename T>
+inline uint8_t Image::valueTo8(const T val)
 {
-    return static_cast<uint8_t>(floor(255.0 * val));
+    return static_cast<uint8_t>(std::floor(T(255) * val));
 }
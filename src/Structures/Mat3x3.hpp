@@ -24,8 +24,8 @@ struct Mat3x3 {
     static const Mat3x3 k_unitMatrix;
     double mdata[3][3] = {}; // Zeroed init matrix data
 
-    template<typename T>
-    [[nodiscard]] T multiply(double a, double b, double c) const noexcept;
+    template<typename T, typename S = double>
+    [[nodiscard]] T multiply(S a, S b, S c) const noexcept;
     [[nodiscard]] Mat3x3 multiply(const Mat3x3& mat) const noexcept;
     [[nodiscard]] Mat3x3 operator*(const Mat3x3& mat) const noexcept;
 
@@ -45,18 +45,20 @@ bool operator==(const Mat3x3& matA, const Mat3x3& matB) noexcept;
 /// Multiply matrix by vector
 /// </summary>
 /// <typeparam name="T">Resulting vector type</typeparam>
+/// <typeparam name="S">Scalar of the computation</typeparam>
 /// <param name="a">First vector value</param>
 /// <param name="b">Second vector value</param>
 /// <param name="c">Third vector value</param>
 /// <returns>New multiplied vector</returns>
-template<typename T> inline T Mat3x3::multiply(
+template<typename T, typename S> inline T Mat3x3::multiply(
     // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
-    const double a, const double b, const double c) const noexcept
+    const S a, const S b, const S c) const noexcept
 {
+    const auto m = [this](int i, int j) { return static_cast<S>(mdata[i][j]); };
     return {
-        mdata[0][0] * a + mdata[0][1] * b + mdata[0][2] * c,
-        mdata[1][0] * a + mdata[1][1] * b + mdata[1][2] * c,
-        mdata[2][0] * a + mdata[2][1] * b + mdata[2][2] * c
+        m(0, 0) * a + m(0, 1) * b + m(0, 2) * c,
+        m(1, 0) * a + m(1, 1) * b + m(1, 2) * c,
+        m(2, 0) * a + m(2, 1) * b + m(2, 2) * c
     };
 }
 
@@ -0,0 +1,276 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cinttypes>
+
+#include "Array2D.hpp"
+#include "Color.hpp"
+#include "Plane.hpp"
+#include "CamProfiles/CFAPattern.hpp"
+
+/// <summary>
+/// Single plane CFA image before demosaicing
+/// </summary>
+/// <remarks>
+/// The raw values are kept as loaded until they are scaled, then
+/// they are replaced by the scaled values. Every position has only
+/// the channel of its filter. Reading other channels gives zero,
+/// like from the separate channel planes.
+/// </remarks>
+class Mosaic {
+public:
+    Mosaic();
+    explicit Mosaic(CFAPattern cfa);
+
+    // Raw values as loaded
+    void allocateRaw(int width, int height);
+    uint16_t getRaw(int row, int col) const;
+    uint16_t* getRawRow(int row);
+
+    // Scaled values
+    void setScaled(Plane&& values);
+    bool isScaled() const;
+    Precision getPrecision() const;
+    template<typename T = double>
+    T getValueR(int row, int col) const;
+    template<typename T = double>
+    T getValueG(int row, int col) const;
+    template<typename T = double>
+    T getValueB(int row, int col) const;
+    template<typename T = double>
+    T getValueX(int row, int col, CFAPattern::Color color) const;
+    template<typename T = double>
+    Color::BasicRGB<T> getValue(int row, int col) const;
+    template<typename T>
+    void getValues(int row, int col, int count, T* dst) const;
+
+    const CFAPattern& getCFAPattern() const;
+    int getWidth() const;
+    int getHeight() const;
+    bool empty() const;
+    void clear();
+    void advise(BufferPool::Advice advice) const;
+    void advise(BufferPool::Advice advice, int top, int bottom) const;
+
+private:
+    CFAPattern m_cfa;
+    Array2D<uint16_t> m_raw;
+    Plane m_values;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline Mosaic::Mosaic()
+    : m_cfa(CFAPattern::Filter::RGGB)
+{
+}
+
+inline Mosaic::Mosaic(CFAPattern cfa)
+    : m_cfa(cfa)
+{
+}
+
+/// <summary>
+/// Allocate the plane for raw values
+/// </summary>
+/// <param name="width">Raw image width</param>
+/// <param name="height">Raw image height</param>
+inline void Mosaic::allocateRaw(int width, int height)
+{
+    m_values = Plane();
+    m_raw = Array2D<uint16_t>(width, height, k_planePolicy);
+    return;
+}
+
+inline uint16_t Mosaic::getRaw(int row, int col) const
+{
+    assert(m_raw.inside(row, col));
+    return m_raw[row][col];
+}
+
+inline uint16_t* Mosaic::getRawRow(int row)
+{
+    return m_raw[row];
+}
+
+/// <summary>
+/// Replace the raw values by the scaled values
+/// </summary>
+/// <param name="values">Scaled values of the same size</param>
+inline void Mosaic::setScaled(Plane&& values)
+{
+    assert(values.getWidth() == getWidth());
+    assert(values.getHeight() == getHeight());
+    m_values = std::move(values);
+    m_raw = Array2D<uint16_t>(); // Release raw values
+    return;
+}
+
+/// <summary>
+/// Advise the system about use of the values
+/// </summary>
+/// <param name="advice">Expected use</param>
+inline void Mosaic::advise(BufferPool::Advice advice) const
+{
+    m_raw.advise(advice);
+    m_values.advise(advice);
+    return;
+}
+
+/// <summary>
+/// Advise the system about use of the rows
+/// </summary>
+/// <param name="advice">Expected use</param>
+/// <param name="top">First row</param>
+/// <param name="bottom">Row after the last one</param>
+inline void Mosaic::advise(BufferPool::Advice advice, int top, int bottom) const
+{
+    m_raw.advise(advice, top, bottom);
+    m_values.advise(advice, top, bottom);
+    return;
+}
+
+inline bool Mosaic::isScaled() const
+{
+    return m_values.empty() == false;
+}
+
+inline Precision Mosaic::getPrecision() const
+{
+    return m_values.getPrecision();
+}
+
+template<typename T>
+inline T Mosaic::getValueR(int row, int col) const
+{
+    return (m_cfa(row, col) == CFAPattern::Color::RED)
+        ? m_values.get<T>(row, col) : T(0);
+}
+
+template<typename T>
+inline T Mosaic::getValueG(int row, int col) const
+{
+    const CFAPattern::Color color = m_cfa(row, col);
+    return (color == CFAPattern::Color::GREEN_R
+        || color == CFAPattern::Color::GREEN_B)
+        ? m_values.get<T>(row, col) : T(0);
+}
+
+template<typename T>
+inline T Mosaic::getValueB(int row, int col) const
+{
+    return (m_cfa(row, col) == CFAPattern::Color::BLUE)
+        ? m_values.get<T>(row, col) : T(0);
+}
+
+/// <summary>
+/// Value of the channel by the filter color
+/// </summary>
+/// <param name="row">Image row</param>
+/// <param name="col">Image column</param>
+/// <param name="color">Filter color (both greens are the same channel)</param>
+/// <returns>Channel value</returns>
+template<typename T>
+inline T Mosaic::getValueX(
+    int row, int col, CFAPattern::Color color) const
+{
+    switch (color) {
+    case CFAPattern::Color::RED:
+        return getValueR<T>(row, col);
+    case CFAPattern::Color::BLUE:
+        return getValueB<T>(row, col);
+    default:
+        break;
+    }
+    return getValueG<T>(row, col);
+}
+
+/// <summary>
+/// Value as RGB with only the filter channel set
+/// </summary>
+/// <param name="row">Image row</param>
+/// <param name="col">Image column</param>
+/// <returns>RGB value</returns>
+template<typename T>
+inline Color::BasicRGB<T> Mosaic::getValue(int row, int col) const
+{
+    const T value = m_values.get<T>(row, col);
+    Color::BasicRGB<T> result{0, 0, 0};
+
+    switch (m_cfa(row, col)) {
+    case CFAPattern::Color::RED:
+        result.r = value;
+        break;
+    case CFAPattern::Color::BLUE:
+        result.b = value;
+        break;
+    default: // GREEN_R || GREEN_B
+        result.g = value;
+        break;
+    }
+    return result;
+}
+
+/// <summary>
+/// Scaled values of a row run regardless of the filter color
+/// </summary>
+/// <param name="row">Image row</param>
+/// <param name="col">First column</param>
+/// <param name="count">Number of values</param>
+/// <param name="dst">Destination buffer</param>
+template<typename T>
+inline void Mosaic::getValues(int row, int col, int count, T* dst) const
+{
+    m_values.getRow(row, col, count, dst);
+    return;
+}
+
+inline const CFAPattern& Mosaic::getCFAPattern() const
+{
+    return m_cfa;
+}
+
+inline int Mosaic::getWidth() const
+{
+    return isScaled() ? m_values.getWidth() : m_raw.getWidth();
+}
+
+inline int Mosaic::getHeight() const
+{
+    return isScaled() ? m_values.getHeight() : m_raw.getHeight();
+}
+
+inline bool Mosaic::empty() const
+{
+    return m_raw.empty() && m_values.empty();
+}
+
+/// <summary>
+/// Release the plane
+/// </summary>
+inline void Mosaic::clear()
+{
+    m_raw = Array2D<uint16_t>();
+    m_values = Plane();
+    return;
+}
@@ -0,0 +1,238 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+
+#include "Array2D.hpp"
+#include "Half.hpp"
+#include "Precision.hpp"
+
+/// <summary>
+/// Image plane with samples stored in double, single or half precision
+/// </summary>
+/// <remarks>
+/// The values are read and written in the scalar of the computation,
+/// double or float, and converted to the storage on the way. Half
+/// values are converted through float.
+/// </remarks>
+class Plane {
+public:
+    Plane() noexcept;
+    Plane(int width, int height, Precision precision,
+        Array2DPolicy policy = k_planePolicy);
+
+    template<typename T = double>
+    T get(int row, int col) const;
+    template<typename T>
+    void set(int row, int col, T value);
+    template<typename T>
+    void getRow(int row, int col, int count, T* dst) const;
+    template<typename T>
+    void setRow(int row, int col, int count, const T* src);
+
+    Precision getPrecision() const noexcept;
+    int getWidth() const noexcept;
+    int getHeight() const noexcept;
+    bool empty() const noexcept;
+    void advise(BufferPool::Advice advice) const noexcept;
+    void advise(BufferPool::Advice advice, int top, int bottom) const noexcept;
+
+private:
+    Precision m_precision;
+    Array2D<double> m_double;
+    Array2D<float> m_float;
+    Array2D<Half> m_half;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline Plane::Plane() noexcept
+    : m_precision(Precision::Double)
+{
+}
+
+inline Plane::Plane(
+    int width, int height, Precision precision, Array2DPolicy policy)
+    : m_precision(precision)
+{
+    switch (precision) {
+    case Precision::Float:
+        m_float = Array2D<float>(width, height, policy);
+        break;
+    case Precision::Half:
+        m_half = Array2D<Half>(width, height, policy);
+        break;
+    default:
+        m_double = Array2D<double>(width, height, policy);
+        break;
+    }
+}
+
+template<typename T>
+inline T Plane::get(int row, int col) const
+{
+    if (m_precision == Precision::Float) {
+        assert(m_float.inside(row, col));
+        return static_cast<T>(m_float[row][col]);
+    }
+    if (m_precision == Precision::Half) {
+        assert(m_half.inside(row, col));
+        return static_cast<T>(m_half[row][col].toFloat());
+    }
+    assert(m_double.inside(row, col));
+    return static_cast<T>(m_double[row][col]);
+}
+
+template<typename T>
+inline void Plane::set(int row, int col, T value)
+{
+    if (m_precision == Precision::Float) {
+        assert(m_float.inside(row, col));
+        m_float[row][col] = static_cast<float>(value);
+        return;
+    }
+    if (m_precision == Precision::Half) {
+        assert(m_half.inside(row, col));
+        m_half[row][col] = Half::fromFloat(static_cast<float>(value));
+        return;
+    }
+    assert(m_double.inside(row, col));
+    m_double[row][col] = value;
+    return;
+}
+
+/// <summary>
+/// Read a run of row values
+/// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="row">Plane row</param>
+/// <param name="col">First column</param>
+/// <param name="count">Number of values</param>
+/// <param name="dst">Destination buffer</param>
+template<typename T>
+inline void Plane::getRow(int row, int col, int count, T* dst) const
+{
+    assert(count == 0 || (getWidth() >= col + count && col >= 0));
+    switch (m_precision) {
+    case Precision::Float:
+        std::copy_n(m_float[row] + col, count, dst);
+        break;
+    case Precision::Half:
+        for (int i = 0; i < count; i++) {
+            dst[i] = m_half[row][col + i].toFloat();
+        }
+        break;
+    default:
+        std::copy_n(m_double[row] + col, count, dst);
+        break;
+    }
+}
+
+/// <summary>
+/// Write a run of row values
+/// </summary>
+/// <typeparam name="T">Scalar of the computation</typeparam>
+/// <param name="row">Plane row</param>
+/// <param name="col">First column</param>
+/// <param name="count">Number of values</param>
+/// <param name="src">Source buffer</param>
+template<typename T>
+inline void Plane::setRow(int row, int col, int count, const T* src)
+{
+    assert(count == 0 || (getWidth() >= col + count && col >= 0));
+    switch (m_precision) {
+    case Precision::Float:
+        std::transform(src, src + count, m_float[row] + col,
+            [](T value) { return static_cast<float>(value); });
+        break;
+    case Precision::Half:
+        for (int i = 0; i < count; i++) {
+            m_half[row][col + i] = Half::fromFloat(static_cast<float>(src[i]));
+        }
+        break;
+    default:
+        std::copy_n(src, count, m_double[row] + col);
+        break;
+    }
+}
+
+inline Precision Plane::getPrecision() const noexcept
+{
+    return m_precision;
+}
+
+inline int Plane::getWidth() const noexcept
+{
+    switch (m_precision) {
+    case Precision::Float:
+        return m_float.getWidth();
+    case Precision::Half:
+        return m_half.getWidth();
+    default:
+        return m_double.getWidth();
+    }
+}
+
+inline int Plane::getHeight() const noexcept
+{
+    switch (m_precision) {
+    case Precision::Float:
+        return m_float.getHeight();
+    case Precision::Half:
+        return m_half.getHeight();
+    default:
+        return m_double.getHeight();
+    }
+}
+
+inline bool Plane::empty() const noexcept
+{
+    return m_float.empty() && m_double.empty() && m_half.empty();
+}
+
+inline void Plane::advise(BufferPool::Advice advice) const noexcept
+{
+    advise(advice, 0, getHeight());
+}
+
+/// <summary>
+/// Advise the system about use of the plane rows
+/// </summary>
+/// <param name="advice">Expected use</param>
+/// <param name="top">First row</param>
+/// <param name="bottom">Row after the last one</param>
+inline void Plane::advise(
+    BufferPool::Advice advice, int top, int bottom) const noexcept
+{
+    switch (m_precision) {
+    case Precision::Float:
+        m_float.advise(advice, top, bottom);
+        break;
+    case Precision::Half:
+        m_half.advise(advice, top, bottom);
+        break;
+    default:
+        m_double.advise(advice, top, bottom);
+        break;
+    }
+}
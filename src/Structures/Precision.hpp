@@ -0,0 +1,59 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/// <summary>
+/// Floating point precision of the image planes
+/// </summary>
+/// <remarks>
+/// Half keeps about 11 bits of mantissa. That is enough for 8-bit
+/// output, 16-bit output gets a small bounded error. Float and half
+/// planes are computed in float, double planes in double.
+/// </remarks>
+enum class Precision
+{
+    Double, Float, Half
+};
+
+/// <summary>
+/// Precision used when not selected on the command line
+/// </summary>
+#ifdef RAWDEV_FLOAT_PIPELINE
+constexpr Precision k_defaultPrecision = Precision::Float;
+#else
+constexpr Precision k_defaultPrecision = Precision::Double;
+#endif
+
+/// <summary>
+/// Run a kernel with the scalar of the computation
+/// </summary>
+/// <param name="precision">Precision of the planes</param>
+/// <param name="kernel">Template lambda called with double for double
+/// planes and float otherwise, so it is selected once per stage</param>
+template<typename Kernel>
+inline void dispatchPrecision(Precision precision, Kernel&& kernel)
+{
+    if (precision == Precision::Double)
+        kernel.template operator()<double>();
+    else
+        kernel.template operator()<float>();
+    return;
+}
@@ -71,6 +71,25 @@ inline double EV2Val(const double ev)
     return pow(2, ev);
 }
 
+/// <summary>
+/// Minimum and maximum by value
+/// </summary>
+/// <remarks>
+/// Same results as std::min and std::max, but without the references
+/// the compiler turns them into selects, so loops with them vectorise.
+/// </remarks>
+template<typename T>
+inline T min2(T a, T b)
+{
+    return (b < a) ? b : a;
+}
+
+template<typename T>
+inline T max2(T a, T b)
+{
+    return (a < b) ? b : a;
+}
+
 template<typename T>
 inline T min3(T val1, T val2, T val3)
 {
@@ -96,9 +115,9 @@ compared to the other variants (runtime consistency).
 template<typename T>
 inline T median(T a, T b, T c)
 {
-    return std::max( // Bubble sort-like iterations
-        std::min(std::max(a, b), c),
-        std::min(a, b));
+    return max2( // Bubble sort-like iterations
+        min2(max2(a, b), c),
+        min2(a, b));
 }
 
 template<typename T> // XOR median algorithm
@@ -111,6 +130,31 @@ inline T medianXor(T a, T b, T c)
     return c;
 }
 
+/// <summary>
+/// Median of nine values
+/// </summary>
+/// <remarks>
+/// Sorting network of 19 compare exchanges after Devillard, the same
+/// result as sorting. It has no branches, so a loop over it vectorises.
+/// </remarks>
+template<typename T>
+inline T median9(T p0, T p1, T p2, T p3, T p4, T p5, T p6, T p7, T p8)
+{
+    const auto sort = [](T& a, T& b) {
+        const T low = min2(a, b);
+        b = max2(a, b);
+        a = low;
+    };
+    sort(p1, p2); sort(p4, p5); sort(p7, p8);
+    sort(p0, p1); sort(p3, p4); sort(p6, p7);
+    sort(p1, p2); sort(p4, p5); sort(p7, p8);
+    sort(p0, p3); sort(p5, p8); sort(p4, p7);
+    sort(p3, p6); sort(p1, p4); sort(p2, p5);
+    sort(p4, p7); sort(p4, p2); sort(p6, p4);
+    sort(p4, p2);
+    return p4;
+}
+
 int compareDouble(const void*, const void*);
 
 inline double linearInter(double x,
@@ -22,7 +22,8 @@
 
 namespace Color {
 struct CIEuv;
-struct RGB64;
+template<typename T> struct BasicRGB;
+using RGB64 = BasicRGB<double>;
 } // namespace Color
 
 class CamProfile;
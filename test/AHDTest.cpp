@@ -0,0 +1,101 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "TestImage.hpp"
+
+#include "Demosaic/AHD.hpp"
+
+/// <summary>
+/// Scene with fine detail in both directions
+/// </summary>
+static double SceneValue(int row, int col)
+{
+    const double smooth = 0.3 + 0.2 * std::sin(row * 0.05)
+        * std::cos(col * 0.03);
+    const double lines = ((row / 3 + col / 5) % 4 == 0) ? 0.25 : 0.0;
+    return smooth + lines + ((row * 7 + col * 13) % 17) * 0.004;
+}
+
+/// <summary>
+/// Vectorised kernels must give the same image as the scalar ones
+/// </summary>
+static void CompareKernels(int width, int height, int border,
+    Precision precision)
+{
+    const auto profile = std::make_shared<TestProfile>(width, height, border);
+    const Mosaic mosaic = MakeMosaic(profile->getCFAPattern(),
+        GrayScene(SceneValue), width, height, precision);
+    Demosaic::AHD scalar(Demosaic::AHD::Kernels::Scalar);
+    Demosaic::AHD vector(Demosaic::AHD::Kernels::Vector);
+    const Image imgScalar = DemosaicMosaic(scalar, profile, mosaic);
+    const Image imgVector = DemosaicMosaic(vector, profile, mosaic);
+
+    int differences = 0;
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            const Color::RGB64 s = imgScalar.getValue(row, col);
+            const Color::RGB64 v = imgVector.getValue(row, col);
+            differences += (s.r != v.r) + (s.g != v.g) + (s.b != v.b);
+        }
+    }
+    EXPECT_EQ(differences, 0);
+}
+
+TEST(AHDTest, VectorKernelsTest)
+{
+    CompareKernels(160, 120, 4, Precision::Double);
+}
+
+TEST(AHDTest, VectorKernelsPhaseTest)
+{
+    CompareKernels(161, 123, 5, Precision::Double);
+}
+
+TEST(AHDTest, PlanTilesTest)
+{
+    // Output areas of the tiles are adjacent in rows and columns
+    const auto profile = std::make_shared<TestProfile>(1100, 540, 6);
+    Image img(profile);
+    Mosaic mosaic(profile->getCFAPattern());
+    mosaic.allocateRaw(1100, 540);
+    mosaic.setScaled(Plane(1100, 540, Precision::Float));
+    img.allocateRGB(mosaic);
+    const Demosaic::AHD::TilePlan plan = Demosaic::AHD().planTiles(img);
+
+    ASSERT_EQ(plan.xCount, 3);
+    ASSERT_EQ(plan.areas.size(), 6u);
+    ASSERT_EQ(plan.selected.size(), 6u);
+    for (size_t t = 0; t < plan.areas.size(); t++) {
+        EXPECT_TRUE(plan.selected[t]);
+        if (t % plan.xCount > 0) {
+            EXPECT_EQ(plan.areas[t].left, plan.areas[t - 1].right);
+        }
+        if (t >= static_cast<size_t>(plan.xCount)) {
+            EXPECT_EQ(plan.areas[t].top, plan.areas[t - plan.xCount].bottom);
+        }
+    }
+}
+
+TEST(AHDTest, VectorKernelsTilesTest)
+{
+    // More tiles with a partial tile on the right and bottom
+    CompareKernels(1100, 540, 6, Precision::Float);
+}
@@ -174,3 +174,56 @@ TEST(Array2DTest, InsideTest)
     EXPECT_FALSE(arr.inside(0, -1));
     EXPECT_FALSE(arr.inside(-1, -1));
 }
+
+TEST(Array2DTest, StrideTest)
+{
+    // Rows start aligned and the stride holds the whole row
+    Array2D<double> arr(k_width, k_height);
+    EXPECT_GE(arr.getStride(), k_width);
+    for (int row = 0; row < k_height; ++row) {
+        const auto address = reinterpret_cast<uintptr_t>(arr[row]);
+        EXPECT_EQ(address % Array2D<double>::k_alignment, 0u);
+    }
+
+    // Items of odd size, like RGB16
+    struct Item { uint16_t r, g, b; };
+    Array2D<Item> items(k_width, k_height);
+    const auto rowBytes = reinterpret_cast<uintptr_t>(items[1])
+        - reinterpret_cast<uintptr_t>(items[0]);
+    EXPECT_EQ(rowBytes, items.getStride() * sizeof(Item));
+    EXPECT_EQ(rowBytes % Array2D<Item>::k_alignment, 0u);
+
+    // Power of two widths are padded
+    EXPECT_GT(Array2D<double>::calcStride(4096), 4096);
+    EXPECT_GT(Array2D<float>::calcStride(1024), 1024);
+
+    // Copies keep the content and the stride
+    Array2D<int> ints(k_width, k_height);
+    FillWithSeries(ints);
+    const Array2D<int> copy(ints);
+    EXPECT_EQ(copy.getStride(), ints.getStride());
+    CheckSeries(copy);
+}
+
+TEST(Array2DTest, PolicyTest)
+{
+    // Touched trivial arrays are zeroed
+    for (const auto policy : {Array2DPolicy::FirstTouch,
+        Array2DPolicy::HugePages}) {
+        const Array2D<double> arr(k_width, k_height, policy);
+        CheckDims(arr, k_width, k_height);
+        for (int row = 0; row < k_height; ++row) {
+            for (int col = 0; col < k_width; ++col) {
+                EXPECT_EQ(arr[row][col], 0.0);
+            }
+        }
+    }
+
+    // Large array with a value filled in parallel
+    const int width = 1000, height = 600;
+    const Array2D<float> big(width, height, 0.5f, Array2DPolicy::HugePages);
+    for (int row = 0; row < height; ++row) {
+        EXPECT_EQ(big[row][0], 0.5f);
+        EXPECT_EQ(big[row][width - 1], 0.5f);
+    }
+}
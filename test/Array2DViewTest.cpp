@@ -0,0 +1,100 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "Structures/Array2D.hpp"
+#include "Structures/Array2DView.hpp"
+
+constexpr int k_width = 10;
+constexpr int k_height = 20;
+
+static Array2D<int> MakeSeries()
+{
+    Array2D<int> arr(k_width, k_height);
+
+    for (int row = 0; row < k_height; ++row) {
+        for (int col = 0; col < k_width; ++col) {
+            arr[row][col] = row * k_width + col;
+        }
+    }
+    return arr;
+}
+
+TEST(Array2DViewTest, EmptyTest)
+{
+    const Array2DView<int> view;
+
+    EXPECT_TRUE(view.empty());
+    EXPECT_EQ(view.getWidth(), 0);
+    EXPECT_EQ(view.getHeight(), 0);
+    EXPECT_FALSE(view.inside(0, 0));
+}
+
+TEST(Array2DViewTest, WholeTest)
+{
+    Array2D<int> arr = MakeSeries();
+    const Array2DView<int> view = arr.view();
+
+    EXPECT_EQ(view.getWidth(), k_width);
+    EXPECT_EQ(view.getHeight(), k_height);
+    EXPECT_EQ(view.getStride(), arr.getStride());
+    for (int row = 0; row < k_height; ++row) {
+        EXPECT_EQ(view[row], arr[row]);
+    }
+}
+
+TEST(Array2DViewTest, SubTest)
+{
+    Array2D<int> arr = MakeSeries();
+    const Rect area = Rect::Create(Point(3, 5), 4, 6);
+    const Array2DView<int> view = arr.view(area);
+
+    EXPECT_EQ(view.getWidth(), 4);
+    EXPECT_EQ(view.getHeight(), 6);
+    EXPECT_TRUE(view.inside(5, 3));
+    EXPECT_FALSE(view.inside(6, 0));
+    EXPECT_FALSE(view.inside(0, 4));
+    for (int row = 0; row < view.getHeight(); ++row) {
+        for (int col = 0; col < view.getWidth(); ++col) {
+            EXPECT_EQ(view[row][col], (row + 5) * k_width + col + 3);
+        }
+    }
+
+    // Nested view and writes through it
+    const Array2DView<int> inner = view.sub(Rect::Create(Point(1, 2), 2, 2));
+    inner[1][1] = -1;
+    EXPECT_EQ(arr[8][5], -1);
+    EXPECT_TRUE(view.sub(Rect::Create(Point(1, 1), 0, 3)).empty());
+}
+
+TEST(Array2DViewTest, ConstTest)
+{
+    const Array2D<int> arr = MakeSeries();
+    const Array2DView<const int> view = arr.view(
+        Rect::Create(Point(0, 1), k_width, 2));
+
+    EXPECT_EQ(view[0][0], k_width);
+    EXPECT_EQ(view[1][k_width - 1], 3 * k_width - 1);
+
+    // Mutable views convert to read only ones
+    Array2D<int> other = MakeSeries();
+    const Array2DView<const int> ro = other.view();
+    EXPECT_EQ(ro[k_height - 1][0], (k_height - 1) * k_width);
+}
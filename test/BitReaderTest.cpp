@@ -0,0 +1,183 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "ImageIO/BitReader.hpp"
+
+#include <sstream>
+
+/// <summary>
+/// Make stream from bytes
+/// </summary>
+static std::istringstream MakeStream(const std::vector<uint8_t>& bytes)
+{
+    return std::istringstream(std::string(bytes.begin(), bytes.end()));
+}
+
+/// <summary>
+/// Random data with a lot of stuffing and the EOI marker
+/// </summary>
+static std::vector<uint8_t> MakeStuffed(std::vector<uint8_t>& data)
+{
+    std::mt19937 gen(23);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+    std::vector<uint8_t> stuffed;
+
+    for (uint8_t& b : data)
+    {
+        b = static_cast<uint8_t>(byteDist(gen) < 64 ? 0xff : byteDist(gen));
+        stuffed.push_back(b);
+        if (b == 0xff)
+            stuffed.push_back(0x00);
+    }
+    stuffed.push_back(0xff);
+    stuffed.push_back(0xd9);
+    return stuffed;
+}
+
+/// <summary>
+/// Read all data with random bit counts and compare
+/// </summary>
+static void CheckReadAll(BitReader& bits, const std::vector<uint8_t>& data)
+{
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> lenDist(0, BitReader::kMaxBits);
+    size_t bitPos = 0;
+
+    while (bitPos < 8 * data.size())
+    {
+        const int len = static_cast<int>(std::min<size_t>(
+            lenDist(gen), 8 * data.size() - bitPos));
+        uint32_t ref = 0; // Bit by bit reference
+        for (int i = 0; i < len; i++, bitPos++)
+        {
+            const int bit = (data[bitPos >> 3] >> (7 - (bitPos & 7))) & 1;
+            ref = (ref << 1) | static_cast<uint32_t>(bit);
+        }
+        ASSERT_EQ(bits.get(len), ref);
+    }
+    EXPECT_FALSE(bits.overrun());
+}
+
+TEST(BitReaderTest, TestGetBits)
+{
+    std::istringstream stream = MakeStream({0xa5, 0x3c, 0xff, 0x00, 0x12});
+    BitReader bits(stream);
+
+    EXPECT_EQ(bits.peek(4), 0xau);
+    EXPECT_EQ(bits.get(4), 0xau);
+    EXPECT_EQ(bits.get(8), 0x53u);
+    EXPECT_EQ(bits.get(0), 0x0u);
+    EXPECT_EQ(bits.get(12), 0xcffu);
+    EXPECT_EQ(bits.get(8), 0x12u);
+    EXPECT_FALSE(bits.overrun());
+    EXPECT_EQ(bits.get(1), 0x0u); // Padding
+    EXPECT_TRUE(bits.overrun());
+}
+
+TEST(BitReaderTest, TestGet32Bits)
+{
+    std::istringstream stream = MakeStream(
+        {0x80, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08});
+    BitReader bits(stream);
+
+    EXPECT_EQ(bits.get(1), 0x1u);
+    EXPECT_EQ(bits.get(32), 0x00020406u);
+    EXPECT_EQ(bits.get(32), 0x080a0c0eu);
+    EXPECT_EQ(bits.get(7), 0x08u);
+    EXPECT_FALSE(bits.overrun());
+}
+
+TEST(BitReaderTest, TestMarkerEnd)
+{
+    std::istringstream stream = MakeStream(
+        {0x0f, 0xff, 0x00, 0xf0, 0xff, 0xd9, 0x55});
+    stream.seekg(1);
+    BitReader bits(stream);
+
+    EXPECT_EQ(bits.get(16), 0xfff0u);
+    EXPECT_FALSE(bits.overrun());
+    EXPECT_EQ(bits.peek(32), 0x0u); // Marker is not data
+    EXPECT_FALSE(bits.overrun());
+
+    // Stream must continue with the marker
+    EXPECT_EQ(bits.endPosition(), 4);
+    bits.finish();
+    EXPECT_EQ(stream.tellg(), 4);
+    EXPECT_EQ(stream.get(), 0xff);
+    EXPECT_EQ(stream.get(), 0xd9);
+}
+
+TEST(BitReaderTest, TestSmallBlocks)
+{
+    std::vector<uint8_t> data(5000);
+    const std::vector<uint8_t> stuffed = MakeStuffed(data);
+
+    for (size_t bufferLen : {2, 3, 7, 64})
+    {
+        std::istringstream stream = MakeStream(stuffed);
+        BitReader bits(stream, bufferLen);
+        CheckReadAll(bits, data);
+
+        bits.finish();
+        EXPECT_EQ(stream.tellg(),
+            static_cast<std::streamoff>(stuffed.size() - 2));
+    }
+}
+
+TEST(BitReaderTest, TestInMemory)
+{
+    std::vector<uint8_t> data(5000);
+    std::vector<uint8_t> stuffed = MakeStuffed(data);
+    stuffed.insert(stuffed.begin(), {0xff, 0xd8}); // SOI
+
+    std::istringstream stream = MakeStream(stuffed);
+    stream.seekg(2);
+    BitReader bits(stream, stuffed.data(), stuffed.size());
+    CheckReadAll(bits, data);
+
+    bits.finish();
+    EXPECT_EQ(stream.tellg(),
+        static_cast<std::streamoff>(stuffed.size() - 2));
+}
+
+TEST(BitReaderTest, TestRestartPosition)
+{
+    std::vector<uint8_t> data(5000);
+    const std::vector<uint8_t> stuffed = MakeStuffed(data);
+    std::istringstream stream = MakeStream(stuffed);
+
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> lenDist(0, BitReader::kMaxBits);
+    BitReader bits(stream, stuffed.data(), stuffed.size());
+
+    for (size_t bitPos = 0; bitPos + 64 < 8 * data.size();)
+    {
+        // Restart at the actual position and compare the reading
+        BitReader restart(stream,
+            stuffed.data(), stuffed.size(), bits.bitPosition());
+        for (int i = 0; i < 3; i++)
+        {
+            const int len = lenDist(gen);
+            ASSERT_EQ(bits.get(len), restart.get(len)) << bitPos;
+            bitPos += len;
+        }
+    }
+}
@@ -0,0 +1,134 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "TestImage.hpp"
+
+#include "Demosaic/AHD.hpp"
+#include "Demosaic/Bilinear.hpp"
+#include "Demosaic/Border.hpp"
+#include "Demosaic/Freeman.hpp"
+#include "Demosaic/HQLinear.hpp"
+#include "Demosaic/Hybrid.hpp"
+#include "Demosaic/RCD.hpp"
+
+constexpr int k_width = 161;
+constexpr int k_height = 123;
+constexpr int k_border = 6;
+constexpr int k_frame = 4; // Outside of all interpolated areas
+
+static double SceneValue(int row, int col)
+{
+    return 0.1 + 0.001 * row + 0.002 * col;
+}
+
+/// <summary>
+/// Pixels outside the interpolated area must have their mosaic value
+/// in the channel of the filter color and zero in the others.
+/// </summary>
+static void CheckFrame(Demosaic::IAlgorithm& algorithm)
+{
+    const auto profile = std::make_shared<TestProfile>(
+        k_width, k_height, k_border, CFAPattern::Filter::GBRG);
+    const CFAPattern cfa = profile->getCFAPattern();
+    const Mosaic mosaic = MakeMosaic(
+        cfa, GrayScene(SceneValue), k_width, k_height);
+    const Image img = DemosaicMosaic(algorithm, profile, mosaic);
+
+    for (int row = 0; row < k_height; ++row) {
+        for (int col = 0; col < k_width; ++col) {
+            if (row >= k_frame && row < k_height - k_frame
+                && col >= k_frame && col < k_width - k_frame)
+                continue;
+
+            const double value = SceneValue(row, col);
+            const int channel = CFAPattern::channel(cfa(row, col));
+            const Color::RGB64 rgb = img.getValue(row, col);
+            ASSERT_EQ(rgb.r, channel == 0 ? value : 0.0) << row << ", " << col;
+            ASSERT_EQ(rgb.g, channel == 1 ? value : 0.0) << row << ", " << col;
+            ASSERT_EQ(rgb.b, channel == 2 ? value : 0.0) << row << ", " << col;
+        }
+    }
+}
+
+TEST(BorderTest, FillAreaTest)
+{
+    const auto profile = std::make_shared<TestProfile>(
+        k_width, k_height, k_border);
+    const Mosaic mosaic = MakeMosaic(profile->getCFAPattern(),
+        GrayScene(SceneValue), k_width, k_height);
+    Image img(profile);
+    img.allocateRGB(mosaic);
+
+    // Whole area as the border, then the frame around an inner part
+    const Rect outer(Point(10, 20), Point(40, 50));
+    Demosaic::fillBorder(mosaic, img, outer, Rect());
+    for (int row = 20; row < 50; ++row) {
+        for (int col = 10; col < 40; ++col) {
+            img.setValue(row, col, {1.0, 1.0, 1.0});
+        }
+    }
+    Demosaic::fillBorder(mosaic, img, outer, Rect(Point(12, 22), Point(38, 48)));
+
+    for (int row = 20; row < 50; ++row) {
+        for (int col = 10; col < 40; ++col) {
+            const bool inner = row >= 22 && row < 48 && col >= 12 && col < 38;
+            const Color::RGB64 rgb = img.getValue(row, col);
+            EXPECT_EQ(rgb.r + rgb.g + rgb.b,
+                inner ? 3.0 : SceneValue(row, col)) << row << ", " << col;
+        }
+    }
+}
+
+TEST(BorderTest, BilinearTest)
+{
+    Demosaic::Bilinear algorithm;
+    CheckFrame(algorithm);
+}
+
+TEST(BorderTest, HQLinearTest)
+{
+    Demosaic::HQLinear algorithm;
+    CheckFrame(algorithm);
+}
+
+TEST(BorderTest, FreemanTest)
+{
+    Demosaic::Freeman algorithm(3);
+    CheckFrame(algorithm);
+}
+
+TEST(BorderTest, AHDTest)
+{
+    Demosaic::AHD algorithm;
+    CheckFrame(algorithm);
+}
+
+TEST(BorderTest, RCDTest)
+{
+    Demosaic::RCD algorithm;
+    CheckFrame(algorithm);
+}
+
+TEST(BorderTest, HybridTest)
+{
+    Demosaic::Hybrid algorithm;
+    CheckFrame(algorithm);
+}
@@ -0,0 +1,158 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "Exception.hpp"
+#include "Structures/Array2D.hpp"
+#include "Structures/BufferPool.hpp"
+
+#include <filesystem>
+
+constexpr size_t k_capacity = 16 * 1024 * 1024;
+
+TEST(BufferPoolTest, ReuseTest)
+{
+    BufferPool pool(k_capacity);
+    const size_t bytes = BufferPool::k_minBytes + 100;
+
+    const BufferPool::Block block = pool.acquire(bytes);
+    const auto address = reinterpret_cast<uintptr_t>(block.ptr);
+    EXPECT_EQ(address % BufferPool::k_alignment, 0u);
+    EXPECT_EQ(block.bytes, BufferPool::sizeClass(bytes));
+    pool.release(block);
+    EXPECT_EQ(pool.getCachedBytes(), block.bytes);
+
+    // Same size class gives the cached block back
+    const BufferPool::Block again = pool.acquire(bytes + 10);
+    EXPECT_EQ(again.ptr, block.ptr);
+    EXPECT_EQ(pool.getCachedBytes(), 0u);
+    pool.release(again);
+}
+
+TEST(BufferPoolTest, FitTest)
+{
+    BufferPool pool(k_capacity);
+    const size_t bytes = 4 * BufferPool::k_minBytes;
+
+    const BufferPool::Block block = pool.acquire(bytes);
+    pool.release(block);
+
+    // Too small requests don't get the big block
+    const BufferPool::Block small = pool.acquire(bytes / 2);
+    EXPECT_NE(small.ptr, block.ptr);
+    pool.release(small);
+
+    // Smaller, but fitting request gets it with its real size
+    const BufferPool::Block fit = pool.acquire(bytes * 3 / 4);
+    EXPECT_EQ(fit.ptr, block.ptr);
+    EXPECT_EQ(fit.bytes, block.bytes);
+    pool.release(fit);
+}
+
+TEST(BufferPoolTest, SmallNotCached)
+{
+    BufferPool pool(k_capacity);
+    const size_t bytes = BufferPool::k_minBytes - 1;
+
+    pool.release(pool.acquire(bytes));
+    EXPECT_EQ(pool.getCachedBytes(), 0u);
+}
+
+TEST(BufferPoolTest, CapacityTest)
+{
+    BufferPool pool(k_capacity);
+    const size_t bytes = k_capacity / 2;
+
+    const BufferPool::Block first = pool.acquire(bytes);
+    const BufferPool::Block second = pool.acquire(bytes);
+    const BufferPool::Block third = pool.acquire(bytes);
+    pool.release(first);
+    pool.release(second);
+    pool.release(third); // Over the capacity
+    EXPECT_EQ(pool.getCachedBytes(), k_capacity);
+
+    pool.setCapacity(bytes);
+    EXPECT_EQ(pool.getCachedBytes(), bytes);
+    pool.trim();
+    EXPECT_EQ(pool.getCachedBytes(), 0u);
+}
+
+TEST(BufferPoolTest, GlobalCapacityTest)
+{
+    const size_t capacity = BufferPool::global().getCapacity();
+    EXPECT_GT(BufferPool::availableMemory(), 0u);
+    EXPECT_GT(capacity, 0u);
+    EXPECT_LE(capacity, size_t{2} << 30);
+}
+
+TEST(BufferPoolTest, ArrayReuseTest)
+{
+    constexpr int width = 1000, height = 500;
+    BufferPool::global().trim();
+    const double* first;
+    {
+        Array2D<double> arr(width, height);
+        first = arr[0];
+    }
+    Array2D<double> arr(width, height); // Steady state
+    EXPECT_EQ(arr[0], first);
+}
+
+TEST(BufferPoolTest, ScratchTest)
+{
+    BufferPool pool(k_capacity);
+    const std::string dir = std::filesystem::temp_directory_path().string();
+    pool.setScratchDir(dir);
+    EXPECT_EQ(pool.getScratchDir(), dir);
+
+    // Large blocks are mapped files, writable and not cached
+    const BufferPool::Block block = pool.acquire(BufferPool::k_scratchBytes);
+    ASSERT_NE(block.ptr, nullptr);
+    const auto address = reinterpret_cast<uintptr_t>(block.ptr);
+    EXPECT_EQ(address % BufferPool::k_alignment, 0u);
+    auto* bytes = static_cast<unsigned char*>(block.ptr);
+    bytes[0] = 1;
+    bytes[block.bytes - 1] = 2;
+    BufferPool::advise(block.ptr, block.bytes,
+        BufferPool::Advice::Sequential);
+    EXPECT_EQ(bytes[0] + bytes[block.bytes - 1], 3);
+    BufferPool::advise(block.ptr, block.bytes,
+        BufferPool::Advice::DontNeed); // Paged out, not dropped
+    EXPECT_EQ(bytes[0] + bytes[block.bytes - 1], 3);
+    pool.release(block);
+    EXPECT_EQ(pool.getCachedBytes(), 0u);
+
+    // Smaller blocks stay in memory, but aren't cached
+    const BufferPool::Block small = pool.acquire(BufferPool::k_minBytes);
+    pool.release(small);
+    EXPECT_EQ(pool.getCachedBytes(), 0u);
+
+    // Caching again without the scratch files
+    pool.setScratchDir("");
+    pool.release(pool.acquire(BufferPool::k_minBytes));
+    EXPECT_EQ(pool.getCachedBytes(), small.bytes);
+}
+
+TEST(BufferPoolTest, ScratchFailTest)
+{
+    BufferPool pool(k_capacity);
+    pool.setScratchDir("/nonexistent/RawDev/scratch");
+    EXPECT_THROW(pool.acquire(BufferPool::k_scratchBytes), IOException);
+}
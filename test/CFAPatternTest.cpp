@@ -71,3 +71,28 @@ TEST_F(CFAPatternTest, TestGRBG)
     EXPECT_EQ(m_pat3(1, 0), CFAPattern::Color::BLUE);
     EXPECT_EQ(m_pat3(1, 1), CFAPattern::Color::GREEN_B);
 }
+
+TEST_F(CFAPatternTest, CompileTimeColorTest)
+{
+    for (const CFAPattern& pat : {m_pat0, m_pat1, m_pat2, m_pat3}) {
+        for (int row = 0; row < 4; ++row) {
+            for (int col = 0; col < 4; ++col) {
+                EXPECT_EQ(CFAPattern::color(pat.getFilter(), row, col),
+                    pat(row, col));
+            }
+        }
+    }
+    static_assert(CFAPattern::RowColors<CFAPattern::Filter::GBRG, 1>::even
+        == CFAPattern::Color::RED);
+}
+
+TEST_F(CFAPatternTest, DispatchTest)
+{
+    for (const CFAPattern& pat : {m_pat0, m_pat1, m_pat2, m_pat3}) {
+        CFAPattern::Color first = CFAPattern::Color::GREEN_R;
+        pat.dispatch([&]<CFAPattern::Filter F>() {
+            first = CFAPattern::RowColors<F, 0>::even;
+        });
+        EXPECT_EQ(first, pat(0, 0));
+    }
+}
@@ -23,6 +23,273 @@
 #include "Exception.hpp"
 #include "ImageIO/CR2Reader.hpp"
 
+#include <filesystem>
+#include <fstream>
+#include <omp.h>
+
+namespace RawDevTest {
+
+class CR2ReaderTest : public ::testing::Test
+{
+protected:
+    static constexpr size_t kSyncSymbols = CR2Reader::kSyncSymbols;
+
+    /// <summary>
+    /// Sink recording the stored image
+    /// </summary>
+    struct TestSink : public RawSink
+    {
+        Array2D<uint16_t> img;
+
+        void allocate(int width, int height) override
+        {
+            img = Array2D<uint16_t>(width, height, 0);
+        }
+
+        void store(int row, int col, const uint16_t* data, int len) override
+        {
+            std::copy(data, data + len, img[row] + col);
+        }
+    };
+
+    static void storeLines(const int (&slices)[3], int height, int lineLen)
+    {
+        CR2Reader file("non existent");
+        std::copy(slices, slices + 3, file.m_slices);
+        file.m_rawHeight = height;
+
+        // Decoded values are the sample order
+        const int width = slices[0] * slices[1] + slices[2];
+        TestSink sink;
+        sink.allocate(width, height);
+        std::vector<uint16_t> line(lineLen);
+        for (int n = 0; n < width * height / lineLen; n++)
+        {
+            for (int k = 0; k < lineLen; k++)
+                line[k] = static_cast<uint16_t>(n * lineLen + k);
+            file.storeLine(sink, n, line.data(), lineLen);
+        }
+
+        // Slices are stored one after another
+        uint16_t expect = 0;
+        for (int slice = 0, colBase = 0; slice <= slices[0]; slice++)
+        {
+            const int sliceWidth = (slice < slices[0]) ? slices[1] : slices[2];
+            for (int row = 0; row < height; row++)
+            {
+                for (int col = colBase; col < colBase + sliceWidth; col++)
+                    ASSERT_EQ(sink.img[row][col], expect++);
+            }
+            colBase += sliceWidth;
+        }
+    }
+
+    /// <summary>
+    /// Synthetic CR2 file with one lossless JPEG scan
+    /// </summary>
+    struct SynthFile
+    {
+        std::vector<uint8_t> data;    // Whole file
+        std::vector<uint64_t> starts; // Symbol bit positions in the file
+        uint64_t scanStart, scanEnd;  // Entropy coded data
+        uint64_t badPos;              // Position of the bad code if any
+    };
+
+    /// <summary>
+    /// Bit writer with the JPEG byte stuffing
+    /// </summary>
+    struct BitWriter
+    {
+        std::vector<uint8_t>& out;
+        uint32_t acc = 0;
+        int bits = 0;
+
+        uint64_t position() const { return uint64_t(out.size()) * 8 + bits; }
+
+        void put(uint32_t value, int len)
+        {
+            for (int k = len - 1; k >= 0; k--)
+            {
+                acc = (acc << 1) | ((value >> k) & 1);
+                if (++bits == 8)
+                {
+                    out.push_back(static_cast<uint8_t>(acc));
+                    if (acc == 0xff)
+                        out.push_back(0x00); // Stuffing
+                    acc = 0; bits = 0;
+                }
+            }
+        }
+    };
+
+    /// <summary>
+    /// Build CR2 file with random difference symbols
+    /// </summary>
+    /// <param name="counts">Huffman code counts of length 1 to 16</param>
+    /// <param name="values">Difference lengths of the codes</param>
+    /// <param name="lines">Scan lines with 256 samples of 4 components</param>
+    /// <param name="badSymbol">Symbol replaced by a bad code (or -1)</param>
+    static SynthFile makeFile(const uint8_t (&counts)[16],
+        const std::vector<uint8_t>& values, int lines, int64_t badSymbol)
+    {
+        const int samples = 256;
+        SynthFile file;
+        std::vector<uint8_t>& d = file.data;
+        auto u16 = [&](uint16_t v) {
+            d.push_back(v & 0xff); d.push_back(v >> 8);
+        };
+        auto u32 = [&](uint32_t v) {
+            u16(v & 0xffff); u16(uint16_t(v >> 16));
+        };
+        auto be16 = [&](uint16_t v) {
+            d.push_back(v >> 8); d.push_back(v & 0xff);
+        };
+
+        // TIFF and CR2 headers, three empty IFDs and the raw IFD
+        d = {'I', 'I'}; u16(42); u32(16);
+        d.push_back('C'); d.push_back('R'); u16(2); u32(34);
+        for (uint32_t next : {22u, 28u, 34u})
+        {
+            u16(0); u32(next);
+        }
+        u16(3);
+        u16(273); u16(4); u32(1); u32(82); // StripOffsets
+        u16(279); u16(4); u32(1); u32(0);  // StripByteCounts (set below)
+        u16(0xc640); u16(3); u32(3); u32(76); // CR2slicing
+        u32(0);
+        u16(0); u16(2); u16(samples * 4); // No slicing
+
+        // Lossless JPEG headers
+        d.push_back(0xff); d.push_back(0xd8);
+        d.push_back(0xff); d.push_back(0xc4);
+        be16(static_cast<uint16_t>(19 + values.size())); d.push_back(0x00);
+        d.insert(d.end(), counts, counts + 16);
+        d.insert(d.end(), values.begin(), values.end());
+        d.push_back(0xff); d.push_back(0xc3); be16(20);
+        d.push_back(14); be16(static_cast<uint16_t>(lines)); be16(samples);
+        d.push_back(4);
+        for (uint8_t c = 1; c <= 4; c++)
+        {
+            d.push_back(c); d.push_back(0x11); d.push_back(0);
+        }
+        d.push_back(0xff); d.push_back(0xda); be16(14); d.push_back(4);
+        for (uint8_t c = 1; c <= 4; c++)
+        {
+            d.push_back(c); d.push_back(0x00);
+        }
+        d.push_back(1); d.push_back(0); d.push_back(0);
+        file.scanStart = d.size();
+
+        // Canonical codes
+        std::vector<uint32_t> codes;
+        std::vector<int> lens;
+        for (uint32_t len = 1, code = 0; len <= 16; len++, code <<= 1)
+        {
+            for (int c = 0; c < counts[len - 1]; c++, code++)
+            {
+                codes.push_back(code); lens.push_back(len);
+            }
+        }
+
+        // Random symbols (engine output is portable, distributions not)
+        std::mt19937 gen(5);
+        BitWriter writer{d};
+        const int64_t symbols = int64_t(lines) * samples * 4;
+        file.starts.reserve(symbols);
+        file.badPos = 0;
+        for (int64_t n = 0; n < symbols; n++)
+        {
+            file.starts.push_back(writer.position());
+            if (n == badSymbol)
+            {
+                file.badPos = writer.position();
+                writer.put(0xffff, 16); // No code has this prefix
+                continue;
+            }
+            const size_t k = gen() % codes.size();
+            writer.put(codes[k], lens[k]);
+            writer.put(gen() & ((1u << values[k]) - 1), values[k]);
+        }
+        writer.put(0x7f, (8 - writer.bits) & 7); // Pad with ones
+        d.push_back(0xff); d.push_back(0xd9);
+
+        file.scanEnd = d.size();
+        const uint32_t stripBytes = static_cast<uint32_t>(file.scanEnd - 82);
+        std::copy_n(reinterpret_cast<const uint8_t*>(&stripBytes), 4, &d[56]);
+        return file;
+    }
+
+    /// <summary>
+    /// Guessed part starts, as the speculative decode splits the scan
+    /// </summary>
+    static std::vector<uint64_t> guessedStarts(
+        const SynthFile& file, int threads)
+    {
+        const uint64_t scanLen = file.scanEnd - file.scanStart;
+        const int count = static_cast<int>(std::min<uint64_t>(
+            threads, scanLen / CR2Reader::kSpecPartLen));
+        std::vector<uint64_t> starts;
+        for (int i = 1; i < count; i++)
+        {
+            uint64_t start = file.scanStart + scanLen * i / count;
+            while (file.data[start - 1] == 0xff)
+                start++;
+            starts.push_back(start);
+        }
+        return starts;
+    }
+
+    /// <summary>
+    /// Read the file speculatively and serially and compare
+    /// </summary>
+    static void compareDecodes(const SynthFile& file, int threads)
+    {
+        const std::string fileName = (std::filesystem::temp_directory_path()
+            / "RawDevSpeculativeTest.cr2").string();
+        {
+            std::ofstream out(fileName, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(file.data.data()),
+                static_cast<std::streamsize>(file.data.size()));
+        }
+
+        const int maxThreads = omp_get_max_threads();
+        omp_set_num_threads(threads);
+        Array2D<uint16_t> serial, speculative;
+        bool serialBad = false, speculativeBad = false;
+        try {
+            CR2Reader reader(fileName, false); // Stream decode4
+            reader.open();
+            reader.read(serial);
+        }
+        catch (const FormatException&) {
+            serialBad = true;
+        }
+        try {
+            CR2Reader reader(fileName); // Mapping without index
+            reader.open();
+            reader.read(speculative);
+        }
+        catch (const FormatException&) {
+            speculativeBad = true;
+        }
+        omp_set_num_threads(maxThreads);
+        std::filesystem::remove(fileName);
+
+        ASSERT_EQ(serialBad, file.badPos != 0);
+        ASSERT_EQ(speculativeBad, serialBad);
+        if (serialBad == true)
+            return;
+        ASSERT_EQ(speculative.getWidth(), serial.getWidth());
+        ASSERT_EQ(speculative.getHeight(), serial.getHeight());
+        for (int row = 0; row < serial.getHeight(); row++)
+        {
+            ASSERT_TRUE(std::equal(serial[row],
+                serial[row] + serial.getWidth(), speculative[row]))
+                << "Row " << row;
+        }
+    }
+};
+
 /*
 These are complicated, long and useless test's
 in some way... We know, that the reader works
@@ -47,15 +314,80 @@ TEST(CR2ReaderTest, File5DsRTest)
 }
 */
 
-TEST(CR2ReaderTest, FileNotFoundTest)
+TEST_F(CR2ReaderTest, FileNotFoundTest)
 {
     CR2Reader file("non existent");
     EXPECT_THROW(file.open(), IOException);
 }
 
-TEST(CR2ReaderTest, FileNotOpenTest)
+TEST_F(CR2ReaderTest, FileNotOpenTest)
 {
     Array2D<uint16_t> img;
     CR2Reader file("non existent");
     EXPECT_THROW(file.read(img), IOException);
 }
+
+TEST_F(CR2ReaderTest, StoreLineTest)
+{
+    storeLines({2, 6, 4}, 5, 16); // Lines cross slices
+    storeLines({3, 4, 8}, 4, 4);  // Lines match slice width
+    storeLines({0, 2, 10}, 3, 6); // No slicing
+}
+
+TEST_F(CR2ReaderTest, SpeculativeResyncTest)
+{
+    // Incomplete code, so the guessed starts meet bad codes
+    const uint8_t counts[16] = {0, 3, 1};
+    const SynthFile file = makeFile(counts, {8, 10, 12, 6}, 900, -1);
+    const std::vector<uint64_t> starts = guessedStarts(file, 4);
+    ASSERT_EQ(starts.size(), 3u);
+
+    // Every part starts inside a code
+    for (uint64_t start : starts)
+    {
+        ASSERT_FALSE(std::binary_search(
+            file.starts.begin(), file.starts.end(), start << 3));
+    }
+    compareDecodes(file, 4);
+}
+
+TEST_F(CR2ReaderTest, SpeculativeFallbackTest)
+{
+    // Symbols of 3, 6, 9 and 12 bits never meet off their 3 bit grid
+    const uint8_t counts[16] = {0, 4};
+    const SynthFile file = makeFile(counts, {1, 4, 7, 10}, 1304, -1);
+    const std::vector<uint64_t> starts = guessedStarts(file, 4);
+    ASSERT_EQ(starts.size(), 3u);
+
+    // All parts start off the grid, so no part can be linked
+    for (uint64_t start : starts)
+    {
+        uint64_t bytes = 0; // Data bytes without the stuffing
+        for (uint64_t k = file.scanStart; k < start; k++)
+        {
+            if (file.data[k] != 0x00 || file.data[k - 1] != 0xff)
+                bytes++;
+        }
+        ASSERT_NE(bytes % 3, 0u);
+    }
+    compareDecodes(file, 4);
+}
+
+TEST_F(CR2ReaderTest, SpeculativeBadCodeTest)
+{
+    const uint8_t counts[16] = {0, 3, 1};
+    const int lines = 900;
+    const int64_t symbols = int64_t(lines) * 256 * 4;
+    const SynthFile file =
+        makeFile(counts, {8, 10, 12, 6}, lines, symbols * 5 / 8);
+    const std::vector<uint64_t> starts = guessedStarts(file, 4);
+    ASSERT_EQ(starts.size(), 3u);
+
+    // Bad code well behind the start of the third part
+    const uint64_t sync = uint64_t(kSyncSymbols) * 16;
+    ASSERT_GT(file.badPos, (starts[1] << 3) + sync);
+    ASSERT_LT(file.badPos, starts[2] << 3);
+    compareDecodes(file, 4);
+}
+
+} // namespace RawDevTest
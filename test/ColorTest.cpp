@@ -41,3 +41,25 @@ TEST(ColorTest, TestUVtoXYZ)
     EXPECT_NEAR(ref.y, target.y, tolerance);
     EXPECT_NEAR(ref.z, target.z, tolerance);
 }
+
+TEST(ColorTest, LabTableTest)
+{
+    const LabTable table(k_d50);
+    double maxL = 0.0, maxAB = 0.0;
+
+    // Inside and outside the table, with the linear segment
+    for (int i = -20; i <= 2'500; ++i) {
+        const double v = i * 0.001;
+        for (const CIEXYZ& xyz : {CIEXYZ{v, v, v},
+            CIEXYZ{v, 0.5 * v, 0.3}, CIEXYZ{0.2, v, 1.7 * v}}) {
+            CIELab ref;
+            xyz2Lab(xyz, ref, k_d50);
+            const CIELab fast = table(xyz);
+            maxL = std::max(maxL, std::abs(fast.L - ref.L));
+            maxAB = std::max({maxAB,
+                std::abs(fast.a - ref.a), std::abs(fast.b - ref.b)});
+        }
+    }
+    EXPECT_LT(maxL, 2e-3);
+    EXPECT_LT(maxAB, 2e-2);
+}
@@ -0,0 +1,103 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "ImageIO/DecodeIndex.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+/// <summary>
+/// Index with all restart points for 150 lines
+/// </summary>
+static DecodeIndex MakeIndex(const DecodeIndex::Key& key)
+{
+    DecodeIndex index(key);
+    for (int line = 0; line < 150; line++)
+    {
+        if (DecodeIndex::isRestartLine(line))
+        {
+            const int prev[4] = {line, line + 1, line + 2, line + 3};
+            index.add(1000 + 8 * static_cast<uint64_t>(line), prev);
+        }
+    }
+    return index;
+}
+
+TEST(DecodeIndexTest, TestSaveLoad)
+{
+    const std::string fileName = (std::filesystem::temp_directory_path()
+        / "RawDevDecodeIndexTest.rdx").string();
+    const DecodeIndex::Key key{12345, 678, 90, 150, 1392, 4};
+
+    const DecodeIndex index = MakeIndex(key);
+    ASSERT_TRUE(index.isComplete());
+    ASSERT_TRUE(index.save(fileName));
+
+    DecodeIndex loaded(key);
+    ASSERT_TRUE(loaded.load(fileName));
+    ASSERT_EQ(loaded.getCount(), 3);
+    EXPECT_EQ(loaded[2].bitPos, 1000u + 8 * 128);
+    EXPECT_EQ(loaded[2].prev[3], 131);
+
+    // Index for other file state
+    DecodeIndex::Key otherKey = key;
+    otherKey.fileTime++;
+    DecodeIndex other(otherKey);
+    EXPECT_FALSE(other.load(fileName));
+    EXPECT_EQ(other.getCount(), 0);
+
+    std::filesystem::remove(fileName);
+    EXPECT_FALSE(loaded.load(fileName));
+}
+
+TEST(DecodeIndexTest, TestSaveReplaces)
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path()
+        / "RawDevDecodeIndexReplace";
+    std::filesystem::create_directories(dir);
+    const std::string fileName = (dir / "file.rdx").string();
+    const DecodeIndex::Key key{12345, 678, 90, 150, 1392, 4};
+
+    { // Damaged sidecar from an interrupted run
+        std::ofstream file(fileName, std::ofstream::binary);
+        file << "RDX";
+    }
+    ASSERT_TRUE(MakeIndex(key).save(fileName));
+
+    DecodeIndex loaded(key);
+    EXPECT_TRUE(loaded.load(fileName));
+
+    // Only the sidecar, no temporary file is left
+    const auto count = std::distance(
+        std::filesystem::directory_iterator(dir),
+        std::filesystem::directory_iterator());
+    EXPECT_EQ(count, 1);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(DecodeIndexTest, TestRestartLines)
+{
+    EXPECT_TRUE(DecodeIndex::isRestartLine(0));
+    EXPECT_FALSE(DecodeIndex::isRestartLine(1));
+    EXPECT_TRUE(DecodeIndex::isRestartLine(DecodeIndex::kLineStep));
+    EXPECT_FALSE(DecodeIndex::isRestartLine(DecodeIndex::kLineStep + 1));
+}
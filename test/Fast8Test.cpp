@@ -0,0 +1,200 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "TestImage.hpp"
+
+#include "CamProfiles/CamProfile.hpp"
+#include "CmdLineParser.hpp"
+#include "Demosaic.hpp"
+#include "Fast8.hpp"
+#include "Options.hpp"
+#include "Output.hpp"
+#include "ProcRGB.hpp"
+#include "Scale.hpp"
+
+#include <random>
+
+constexpr int k_width = 96;
+constexpr int k_height = 64;
+constexpr int k_border = 4;
+
+/// <summary>
+/// Raw image of a smooth scene with edges and some clipped parts
+/// </summary>
+/// <param name="camera">Camera of the colors, the 6D matrices if none</param>
+/// <remarks>
+/// The hue turns over the scene, so the HSV maps apply everywhere.
+/// </remarks>
+static Image MakeRawImage(const CamProfile* camera = nullptr)
+{
+    const auto profile = camera != nullptr
+        ? std::make_shared<TestProfile>(*camera, k_width, k_height, k_border)
+        : std::make_shared<TestProfile>(k_width, k_height, k_border);
+    profile->setLevels({2048, 2048, 2048}, {15000, 15000, 15000});
+    const CFAPattern cfa = profile->getCFAPattern();
+    Image img(profile);
+    Mosaic& mosaic = img.getMosaic();
+
+    mosaic.allocateRaw(k_width, k_height);
+    for (int row = 0; row < k_height; ++row) {
+        uint16_t* data = mosaic.getRawRow(row);
+        for (int col = 0; col < k_width; ++col) {
+            const double smooth = 0.3 + 0.25 * std::sin(row * 0.11)
+                * std::cos(col * 0.07);
+            const double value = (col / 12 + row / 12) % 3 == 0
+                ? smooth + 0.5 : smooth;
+            const int channel = CFAPattern::channel(cfa(row, col));
+            const double hue = 0.6 + 0.4 * std::cos(
+                col * 0.09 + row * 0.05 + channel * 2.1);
+            data[col] = static_cast<uint16_t>(2048 + value * hue * 12000);
+        }
+    }
+    return img;
+}
+
+static Options ParseOptions(std::vector<const char*> args)
+{
+    CmdLine::Parser p;
+    p.addOption("d", "Demosaic", "", CmdLine::OptionType::STRING);
+    p.addOption("b", "BitDepth", "", CmdLine::OptionType::INT);
+    p.addSwitch("F", "Fast 8-bit", true);
+    EXPECT_EQ(p.parse(static_cast<int>(args.size()), args.data()), 0);
+
+    Options opt;
+    EXPECT_EQ(opt.process(p), 0);
+    return opt;
+}
+
+/// <summary>
+/// Compare the fast path with the double pipeline
+/// </summary>
+static void CompareFast8(const char* algorithm,
+    const CamProfile* camera = nullptr)
+{
+    const Options opt = ParseOptions({"exe", "-F", "-d", algorithm, "a.cr2"});
+    ASSERT_TRUE(opt.getFast8());
+
+    Image img = MakeRawImage(camera);
+    Image ref = MakeRawImage(camera);
+
+    ScaleModule::run(ref, opt);
+    DemosaicModule::run(ref, opt);
+    ProcRGBModule::run(ref, opt);
+    OutputModule::convert(ref, opt.getColorProfile());
+    Array2D<Color::RGB8> expected;
+    ref.convert8(expected, opt.getNoCrop());
+
+    const Array2D<Color::RGB8> result = Fast8Module::develop(img, opt);
+    ASSERT_EQ(result.getWidth(), expected.getWidth());
+    ASSERT_EQ(result.getHeight(), expected.getHeight());
+
+    // Rounding of the integer steps moves some codes by one
+    for (int row = 0; row < result.getHeight(); ++row) {
+        for (int col = 0; col < result.getWidth(); ++col) {
+            const Color::RGB8 f = result[row][col];
+            const Color::RGB8 d = expected[row][col];
+            EXPECT_LE(std::abs(f.r - d.r), 2);
+            EXPECT_LE(std::abs(f.g - d.g), 2);
+            EXPECT_LE(std::abs(f.b - d.b), 2);
+        }
+    }
+}
+
+TEST(Fast8Test, FixedMatrixTest)
+{
+    Mat3x3 mat;
+    mat.mdata[0][0] = 1.0;
+    mat.mdata[1][0] = 0.5; mat.mdata[1][1] = 0.25;
+    mat.mdata[2][0] = 2.0; mat.mdata[2][2] = -1.5;
+
+    const Fast8Module::FixedMatrix fixed(mat);
+    EXPECT_EQ(fixed.shift, 13);
+
+    Fast8Module::Pixel value = {1000, 4001, 2000};
+    fixed.apply(value);
+    EXPECT_EQ(value[0], 1000);
+    EXPECT_EQ(value[1], 1500);
+    EXPECT_EQ(value[2], 0); // Negative clamped
+
+    Fast8Module::Pixel high = {65535, 65535, 0};
+    fixed.apply(high);
+    EXPECT_EQ(high[0], 65535);
+    EXPECT_EQ(high[1], 49151);
+    EXPECT_EQ(high[2], 65535); // Overflow clamped
+}
+
+TEST(Fast8Test, BilinearTest)
+{
+    CompareFast8("bilinear");
+}
+
+TEST(Fast8Test, HQLinearTest)
+{
+    CompareFast8("hqlinear");
+}
+
+/// <summary>
+/// End to end with the HSV maps and look table of a real camera
+/// </summary>
+TEST(Fast8Test, CameraMapsTest)
+{
+    const auto camera = CamProfile::MakeCamProfile(CamID::EOS_6D, 5500);
+    ASSERT_TRUE(camera->hasHSVMaps());
+    CompareFast8("hqlinear", camera.get());
+}
+
+/// <summary>
+/// HSV maps must follow the double round trip of the camera maps
+/// </summary>
+TEST(Fast8Test, HSVMapsTest)
+{
+    const auto profile = CamProfile::MakeCamProfile(CamID::EOS_6D, 5500);
+    ASSERT_TRUE(profile->hasHSVMaps());
+    const Fast8Module::HSVMaps maps(*profile);
+
+    const auto reference = [&](const Fast8Module::Pixel& value, int c) {
+        Color::HSV64 hsv = Color::rgb2hsv(Color::RGB64{
+            value[0] / 65535.0, value[1] / 65535.0, value[2] / 65535.0});
+        profile->applyHSVMap(hsv);
+        profile->applyProfileLook(hsv);
+        const Color::RGB64 rgb = Color::hsv2rgb(hsv);
+        const double channels[3] = {rgb.r, rgb.g, rgb.b};
+        return std::clamp(channels[c], 0.0, 1.0) * 65535.0;
+    };
+
+    // Float rounding moves the samples on the hue steps of the maps
+    std::mt19937 generator(16);
+    std::uniform_int_distribution<int32_t> sample(0, 65535);
+    constexpr int count = 100000;
+    int far = 0;
+    for (int i = 0; i < count; i++) {
+        const Fast8Module::Pixel value = {
+            sample(generator), sample(generator), sample(generator)};
+        Fast8Module::Pixel mapped = {value[0], value[1], value[2]};
+        maps.apply(mapped);
+        for (int c = 0; c < 3; c++) {
+            const double error = std::abs(mapped[c] - reference(value, c));
+            EXPECT_LE(error, 16.0);
+            far += (error > 1.0);
+        }
+    }
+    EXPECT_LE(far, 3 * count / 10000);
+}
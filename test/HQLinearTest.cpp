@@ -0,0 +1,121 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "TestImage.hpp"
+
+#include "Demosaic/HQLinear.hpp"
+
+#include <cmath>
+
+/// <summary>
+/// Flat colors without the two pixels of the bilinear border
+/// </summary>
+static void CheckFlatColors(int width, int height, int border)
+{
+    Demosaic::HQLinear hqlinear;
+    CheckFlatColors(hqlinear, width, height, border, 2, 1e-12);
+}
+
+TEST(HQLinearTest, FlatColorsTest)
+{
+    CheckFlatColors(100, 80, 4);
+}
+
+TEST(HQLinearTest, FlatColorsPhaseTest)
+{
+    // Odd borders and sizes start rows with the other phase
+    CheckFlatColors(101, 83, 5);
+}
+
+/// <summary>
+/// Filters of Malvar, He and Cutler in eighths
+/// </summary>
+constexpr double k_greenAtChroma[5][5] = {
+    {0, 0, -1, 0, 0}, {0, 0, 2, 0, 0}, {-1, 2, 4, 2, -1},
+    {0, 0, 2, 0, 0}, {0, 0, -1, 0, 0}};
+constexpr double k_rowAtGreen[5][5] = { // Color of the row neighbours
+    {0, 0, 0.5, 0, 0}, {0, -1, 0, -1, 0}, {-1, 4, 5, 4, -1},
+    {0, -1, 0, -1, 0}, {0, 0, 0.5, 0, 0}};
+constexpr double k_columnAtGreen[5][5] = { // Column neighbours
+    {0, 0, -1, 0, 0}, {0, -1, 4, -1, 0}, {0.5, 0, 5, 0, 0.5},
+    {0, -1, 4, -1, 0}, {0, 0, -1, 0, 0}};
+constexpr double k_diagonal[5][5] = { // Red on blue and blue on red
+    {0, 0, -1.5, 0, 0}, {0, 2, 0, 2, 0}, {-1.5, 0, 6, 0, -1.5},
+    {0, 2, 0, 2, 0}, {0, 0, -1.5, 0, 0}};
+
+/// <summary>
+/// Smooth colored scene with some edges
+/// </summary>
+static Color::RGB64 SceneValue(int row, int col)
+{
+    const double smooth = 0.25 + 0.2 * std::sin(row * 0.3)
+        * std::cos(col * 0.2);
+    const double edge = (col / 7 + row / 5) % 3 == 0 ? 0.3 : 0.0;
+    return {0.8 * smooth + edge, smooth, 0.6 * smooth + 0.5 * edge};
+}
+
+TEST(HQLinearTest, MalvarFilterTest)
+{
+    constexpr int width = 60, height = 50, border = 4;
+    const auto profile = std::make_shared<TestProfile>(width, height, border);
+    const CFAPattern cfa = profile->getCFAPattern();
+    const Mosaic mosaic = MakeMosaic(cfa, SceneValue, width, height);
+    Demosaic::HQLinear hqlinear;
+    const Image img = DemosaicMosaic(hqlinear, profile, mosaic);
+
+    auto sample = [&](int row, int col) {
+        return mosaic.getValueX(row, col, cfa(row, col));
+    };
+    auto filter = [&](const double (&kernel)[5][5], int row, int col) {
+        double sum = 0.0;
+        for (int i = 0; i < 5; ++i) {
+            for (int j = 0; j < 5; ++j)
+                sum += kernel[i][j] * sample(row + i - 2, col + j - 2);
+        }
+        return Image::clip(sum / 8); // Like the stored values
+    };
+    for (int row = border + 2; row < height - border - 2; ++row) {
+        for (int col = border + 2; col < width - border - 2; ++col) {
+            const CFAPattern::Color color = cfa(row, col);
+            const double own = sample(row, col);
+            double r, g, b;
+            if (CFAPattern::isGreen(color)) {
+                const bool redRow = cfa(row, col + 1) == CFAPattern::Color::RED;
+                const double rowColor = filter(k_rowAtGreen, row, col);
+                const double columnColor = filter(k_columnAtGreen, row, col);
+                r = redRow ? rowColor : columnColor;
+                g = own;
+                b = redRow ? columnColor : rowColor;
+            }
+            else {
+                const bool red = color == CFAPattern::Color::RED;
+                const double other = filter(k_diagonal, row, col);
+                r = red ? own : other;
+                g = filter(k_greenAtChroma, row, col);
+                b = red ? other : own;
+            }
+            const Color::RGB64 value = img.getValue(row, col);
+            ASSERT_NEAR(value.r, r, 1e-12) << row << ", " << col;
+            ASSERT_NEAR(value.g, g, 1e-12) << row << ", " << col;
+            ASSERT_NEAR(value.b, b, 1e-12) << row << ", " << col;
+        }
+    }
+}
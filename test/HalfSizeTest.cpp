@@ -0,0 +1,88 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "TestImage.hpp"
+
+#include "HalfSize.hpp"
+
+/// <summary>
+/// Scene with a distinct level for every filter color, the row and
+/// column of the cell are added in small steps to recognize it.
+/// </summary>
+static Color::RGB64 SceneValue(int row, int col)
+{
+    const double cell = 1e-4 * (row / 2) + 1e-6 * (col / 2);
+    const double green = (row % 2 == 0) ? 0.4 : 0.6; // Both greens differ
+    return {0.2 + cell, green + cell, 0.8 + cell};
+}
+
+TEST(HalfSizeTest, CollapseTest)
+{
+    constexpr int width = 101, height = 83; // Odd size drops the last cells
+    constexpr CFAPattern::Filter filters[] = {
+        CFAPattern::Filter::RGGB, CFAPattern::Filter::GBRG,
+        CFAPattern::Filter::BGGR, CFAPattern::Filter::GRBG};
+
+    for (const CFAPattern::Filter filter : filters) {
+        const Mosaic mosaic = MakeMosaic(filter, SceneValue, width, height);
+        Image img;
+        HalfSizeModule::collapse(mosaic, img);
+        ASSERT_EQ(img.getWidth(), width / 2);
+        ASSERT_EQ(img.getHeight(), height / 2);
+
+        for (int row = 0; row < img.getHeight(); ++row) {
+            for (int col = 0; col < img.getWidth(); ++col) {
+                const double cell = 1e-4 * row + 1e-6 * col;
+                const Color::RGB64 value = img.getValue(row, col);
+                ASSERT_DOUBLE_EQ(value.r, 0.2 + cell) << row << ", " << col;
+                ASSERT_DOUBLE_EQ(value.g, 0.5 + cell) << row << ", " << col;
+                ASSERT_DOUBLE_EQ(value.b, 0.8 + cell) << row << ", " << col;
+            }
+        }
+    }
+}
+
+TEST(HalfSizeTest, ProfileTest)
+{
+    const auto profile = std::make_shared<TestProfile>(
+        Rect(Point(3, 6), Point(97, 81)), Rect(Point(10, 13), Point(90, 76)),
+        CFAPattern::Filter::GRBG);
+    const auto half = HalfSizeModule::halfProfile(profile);
+
+    // Only cells fully inside the areas
+    const Rect active = half->getActiveArea();
+    EXPECT_EQ(active.left, 2);
+    EXPECT_EQ(active.top, 3);
+    EXPECT_EQ(active.right, 48);
+    EXPECT_EQ(active.bottom, 40);
+
+    const Rect crop = half->getCrop();
+    EXPECT_EQ(crop.left, 5);
+    EXPECT_EQ(crop.top, 7);
+    EXPECT_EQ(crop.right, 45);
+    EXPECT_EQ(crop.bottom, 38);
+
+    // The rest is the sensor profile
+    EXPECT_EQ(half->getCameraName(), profile->getCameraName());
+    EXPECT_EQ(half->getCameraID(), profile->getCameraID());
+    EXPECT_EQ(half->getCFAPattern().getFilter(), CFAPattern::Filter::GRBG);
+    EXPECT_EQ(half->getWhiteLevel().g, profile->getWhiteLevel().g);
+}
@@ -0,0 +1,76 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "Structures/Half.hpp"
+
+#include <cmath>
+#include <limits>
+
+TEST(HalfTest, RoundTripTest)
+{
+    // Every finite half is exact in float
+    for (uint32_t bits = 0; bits <= 0xFFFF; ++bits) {
+        const Half half{static_cast<uint16_t>(bits)};
+        if ((bits & 0x7C00) == 0x7C00)
+            continue; // Infinity or NaN
+
+        const float value = half.toFloat();
+        EXPECT_EQ(Half::fromFloat(value).bits, half.bits) << bits;
+    }
+}
+
+TEST(HalfTest, ValuesTest)
+{
+    EXPECT_EQ(Half::fromFloat(0.0f).bits, 0x0000);
+    EXPECT_EQ(Half::fromFloat(-0.0f).bits, 0x8000);
+    EXPECT_EQ(Half::fromFloat(1.0f).bits, 0x3C00);
+    EXPECT_EQ(Half::fromFloat(-2.0f).bits, 0xC000);
+    EXPECT_EQ(Half::fromFloat(65504.0f).bits, 0x7BFF); // Largest
+    EXPECT_EQ(Half{0x0001}.toFloat(), std::ldexp(1.0f, -24)); // Smallest
+    EXPECT_EQ(Half{0x3555}.toFloat(), 0.333251953125f);
+}
+
+TEST(HalfTest, RoundingTest)
+{
+    const float ulp = std::ldexp(1.0f, -10); // At one
+
+    // Ties go to even
+    EXPECT_EQ(Half::fromFloat(1.0f + ulp / 2).bits, 0x3C00);
+    EXPECT_EQ(Half::fromFloat(1.0f + 3 * ulp / 2).bits, 0x3C02);
+    EXPECT_EQ(Half::fromFloat(1.0f + ulp * 0.51f).bits, 0x3C01);
+
+    // Subnormals and underflow
+    EXPECT_EQ(Half::fromFloat(std::ldexp(1.0f, -25)).bits, 0x0000);
+    EXPECT_EQ(Half::fromFloat(std::ldexp(1.5f, -25)).bits, 0x0001);
+    EXPECT_EQ(Half::fromFloat(std::ldexp(3.0f, -24)).bits, 0x0003);
+}
+
+TEST(HalfTest, SpecialTest)
+{
+    constexpr float inf = std::numeric_limits<float>::infinity();
+
+    EXPECT_EQ(Half::fromFloat(65520.0f).bits, 0x7C00); // Overflow
+    EXPECT_EQ(Half::fromFloat(65519.0f).bits, 0x7BFF);
+    EXPECT_EQ(Half::fromFloat(inf).bits, 0x7C00);
+    EXPECT_EQ(Half::fromFloat(-inf).bits, 0xFC00);
+    EXPECT_EQ(Half{0x7C00}.toFloat(), inf);
+    EXPECT_TRUE(std::isnan(Half::fromFloat(std::nanf("")).toFloat()));
+}
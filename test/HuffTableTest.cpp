@@ -0,0 +1,126 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "ImageIO/HuffTable.hpp"
+
+/// <summary>
+/// Table with short, long and too long difference codes
+/// </summary>
+/// <remarks>
+/// Codes: 00 -> 0, 01 -> 1, 10 -> 2, 110 -> 12,
+/// 111000000000 -> 4 and 11100000000100 -> 5
+/// </remarks>
+static HuffTable MakeTable()
+{
+    uint8_t counts[16] = {0, 3, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0};
+    const uint8_t values[6] = {0, 1, 2, 12, 4, 5};
+    HuffTable table;
+    table(counts, values);
+    return table;
+}
+
+TEST(HuffTableTest, TestResolvedLookup)
+{
+    const HuffTable table = MakeTable();
+
+    HuffTable::Entry e = table.lookup(0b00000000000);
+    EXPECT_EQ(e.totalLen, 2);
+    EXPECT_EQ(e.value, 0);
+
+    e = table.lookup(0b01100000000);
+    EXPECT_EQ(e.totalLen, 3);
+    EXPECT_EQ(e.value, 1);
+
+    e = table.lookup(0b01000000000);
+    EXPECT_EQ(e.totalLen, 3);
+    EXPECT_EQ(e.value, -1);
+
+    e = table.lookup(0b10010000000);
+    EXPECT_EQ(e.totalLen, 4);
+    EXPECT_EQ(e.value, -2);
+}
+
+TEST(HuffTableTest, TestUnresolvedLookup)
+{
+    const HuffTable table = MakeTable();
+
+    // Code fits, but the 12 difference bits not
+    HuffTable::Entry e = table.lookup(0b11011111111);
+    EXPECT_EQ(e.totalLen, 0);
+    EXPECT_EQ(e.codeLen, 3);
+    EXPECT_EQ(e.value, 12);
+
+    // Code longer than the lookup bits
+    e = table.lookup(0b11100000000);
+    EXPECT_EQ(e.totalLen, 0);
+    EXPECT_EQ(e.codeLen, 0);
+}
+
+TEST(HuffTableTest, TestDecodeLong)
+{
+    const HuffTable table = MakeTable();
+    int codeLen = 0, diffLen = 0;
+
+    EXPECT_TRUE(table.decodeLong(0b1110000000000000, codeLen, diffLen));
+    EXPECT_EQ(codeLen, 12);
+    EXPECT_EQ(diffLen, 4);
+
+    EXPECT_TRUE(table.decodeLong(0b1110000000010011, codeLen, diffLen));
+    EXPECT_EQ(codeLen, 14);
+    EXPECT_EQ(diffLen, 5);
+
+    EXPECT_FALSE(table.decodeLong(0xffff, codeLen, diffLen));
+}
+
+TEST(HuffTableTest, TestOversubscribed)
+{
+    uint8_t counts[16] = {0, 200, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    uint8_t values[256] = {};
+    EXPECT_FALSE(HuffTable::isPrefixCode(counts));
+
+    // Rejected table stays empty
+    HuffTable table;
+    table(counts, values);
+    HuffTable::Entry e = table.lookup(0);
+    EXPECT_EQ(e.codeLen, 0);
+    EXPECT_EQ(e.totalLen, 0);
+
+    // Complete code with all lengths used up is still fine
+    counts[1] = 4;
+    EXPECT_TRUE(HuffTable::isPrefixCode(counts));
+    counts[2] = 1;
+    EXPECT_FALSE(HuffTable::isPrefixCode(counts));
+
+    // Counts of the test table above
+    const uint8_t valid[16] = {0, 3, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0};
+    EXPECT_TRUE(HuffTable::isPrefixCode(valid));
+}
+
+TEST(HuffTableTest, TestExtend)
+{
+    EXPECT_EQ(HuffTable::extend(0, 0), 0);
+    EXPECT_EQ(HuffTable::extend(0, 1), -1);
+    EXPECT_EQ(HuffTable::extend(1, 1), 1);
+    EXPECT_EQ(HuffTable::extend(0b011, 3), -4);
+    EXPECT_EQ(HuffTable::extend(0b100, 3), 4);
+    EXPECT_EQ(HuffTable::extend(0, 12), -4095);
+    EXPECT_EQ(HuffTable::extend(4095, 12), 4095);
+}
@@ -0,0 +1,162 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "TestImage.hpp"
+
+#include "Demosaic/AHD.hpp"
+#include "Demosaic/HQLinear.hpp"
+#include "Demosaic/Hybrid.hpp"
+
+#include <cmath>
+#include <random>
+#include <tuple>
+
+constexpr int k_width = 1100;
+constexpr int k_height = 540;
+constexpr int k_border = 6;
+constexpr int k_detailColumn = 560; // Detail on the right only
+
+/// <summary>
+/// Flat backdrop on the left, fine detail on the right
+/// </summary>
+static double SceneValue(int row, int col)
+{
+    if (col < k_detailColumn)
+        return 0.4;
+    const double smooth = 0.3 + 0.2 * std::sin(row * 0.05)
+        * std::cos(col * 0.03);
+    return ((row / 3 + col / 5) % 4 == 0) ? smooth + 0.25 : smooth;
+}
+
+/// <summary>
+/// Demosaic the scene by the algorithm
+/// </summary>
+static Image DemosaicScene(Demosaic::IAlgorithm& algorithm)
+{
+    const auto profile = std::make_shared<TestProfile>(
+        k_width, k_height, k_border);
+    const Mosaic mosaic = MakeMosaic(profile->getCFAPattern(),
+        GrayScene(SceneValue), k_width, k_height);
+    return DemosaicMosaic(algorithm, profile, mosaic);
+}
+
+/// <summary>
+/// Flat tiles must be by HQLinear, detailed ones by AHD and
+/// the band along a flat neighbour must be between both.
+/// </summary>
+TEST(HybridTest, TileSelectionTest)
+{
+    Demosaic::AHD ahd;
+    Demosaic::HQLinear hqlinear;
+    Demosaic::Hybrid hybrid;
+    const Image imgAHD = DemosaicScene(ahd);
+    const Image imgHQ = DemosaicScene(hqlinear);
+    const Image imgHybrid = DemosaicScene(hybrid);
+
+    // Tiles on the left are flat, the rest is detailed
+    const Demosaic::AHD::TilePlan plan = ahd.planTiles(imgHybrid);
+    ASSERT_EQ(plan.xCount, 3);
+    ASSERT_EQ(plan.areas.size(), 6u);
+    ASSERT_LT(plan.areas[0].right, k_detailColumn);
+    constexpr int blendWidth = 16;
+
+    int flat = 0, detailed = 0, blended = 0;
+    for (size_t t = 0; t < plan.areas.size(); t++)
+    {
+        const Rect& area = plan.areas[t];
+        const bool isFlat = (t % plan.xCount == 0);
+
+        for (int row = area.top; row < area.bottom; row++) {
+            for (int col = area.left; col < area.right; col++) {
+                const Color::RGB64 v = imgHybrid.getValue(row, col);
+                const Color::RGB64 a = imgAHD.getValue(row, col);
+                const Color::RGB64 h = imgHQ.getValue(row, col);
+
+                if (isFlat) {
+                    flat += (v.r == h.r && v.g == h.g && v.b == h.b);
+                }
+                else if (t % plan.xCount == 1 && col < area.left + blendWidth) {
+                    constexpr double tolerance = 1e-12;
+                    for (const auto& [x, p, q] : {std::tuple{v.r, a.r, h.r},
+                        std::tuple{v.g, a.g, h.g}, std::tuple{v.b, a.b, h.b}}) {
+                        EXPECT_GE(x, std::min(p, q) - tolerance);
+                        EXPECT_LE(x, std::max(p, q) + tolerance);
+                    }
+                    blended++;
+                }
+                else {
+                    detailed += (v.r == a.r && v.g == a.g && v.b == a.b);
+                }
+            }
+        }
+    }
+
+    int flatArea = 0, detailedArea = 0;
+    for (size_t t = 0; t < plan.areas.size(); t++) {
+        const int size = plan.areas[t].getWidth() * plan.areas[t].getHeight();
+        if (t % plan.xCount == 0)
+            flatArea += size;
+        else
+            detailedArea += size;
+    }
+    EXPECT_EQ(flat, flatArea);
+    EXPECT_EQ(detailed + blended, detailedArea);
+    EXPECT_GT(blended, 0);
+}
+
+/// <summary>
+/// Noisy frame with the flat tiles of a dark and a bright backdrop
+/// on the sides must split from the detailed tiles in the middle.
+/// </summary>
+TEST(HybridTest, NoisySelectionTest)
+{
+    const auto profile = std::make_shared<TestProfile>(
+        k_width, k_height, k_border);
+    Image img(profile);
+    img.allocateRGB(k_width, k_height, Precision::Double);
+    Demosaic::Hybrid hybrid;
+    const Demosaic::AHD::TilePlan tiles = Demosaic::AHD().planTiles(img);
+    ASSERT_EQ(tiles.xCount, 3);
+    ASSERT_EQ(tiles.areas.size(), 6u);
+
+    // Detail in the middle column, shot and read noise
+    // amplified by white balance on red and blue
+    const int detailLeft = tiles.areas[1].left;
+    const int detailRight = tiles.areas[1].right;
+    std::mt19937 generator(23);
+    std::normal_distribution<double> normal;
+    const Scene scene = [&](int row, int col) {
+        double v = (col < detailLeft) ? 0.05 : 0.6;
+        if (col >= detailLeft && col < detailRight)
+            v = SceneValue(row, col);
+        const double sigma = std::sqrt(1e-6 + 1e-4 * v);
+        const double n = sigma * normal(generator);
+        return Color::RGB64{v + 2.0 * n, v + n, v + 1.5 * n};
+    };
+    const Mosaic mosaic = MakeMosaic(
+        profile->getCFAPattern(), scene, k_width, k_height);
+
+    const Demosaic::AHD::TilePlan plan = hybrid.selectTiles(mosaic, img);
+    ASSERT_EQ(plan.areas.size(), tiles.areas.size());
+    for (size_t t = 0; t < plan.areas.size(); t++) {
+        EXPECT_EQ(plan.selected[t], t % plan.xCount == 1) << "Tile " << t;
+    }
+}
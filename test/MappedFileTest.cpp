@@ -0,0 +1,68 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "ImageIO/MappedFile.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <istream>
+
+TEST(MappedFileTest, TestStreamRead)
+{
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "RawDevMappedFileTest.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        for (int c = 0; c < 1000; c++)
+            out.put(static_cast<char>(c & 0xff));
+    }
+
+    MappedFile map;
+    ASSERT_TRUE(map.open(path.string()));
+    ASSERT_EQ(map.size(), 1000u);
+    EXPECT_EQ(map.data()[300], 300 & 0xff);
+
+    // Parsing through the stream interface
+    std::istream in(&map);
+    char buff[4];
+    in.seekg(510);
+    in.read(buff, 4);
+    EXPECT_TRUE(in.good());
+    EXPECT_EQ(static_cast<uint8_t>(buff[0]), 510 & 0xff);
+    EXPECT_EQ(static_cast<uint8_t>(buff[3]), 513 & 0xff);
+    EXPECT_EQ(in.tellg(), 514);
+
+    in.seekg(-2, std::ios::end);
+    EXPECT_EQ(in.tellg(), 998);
+    in.read(buff, 4); // Read behind the end
+    EXPECT_TRUE(in.eof());
+
+    map.close();
+    EXPECT_FALSE(map.isOpen());
+    std::filesystem::remove(path);
+}
+
+TEST(MappedFileTest, TestMissingFile)
+{
+    MappedFile map;
+    EXPECT_FALSE(map.open("RawDevMappedFileTest.missing"));
+    EXPECT_FALSE(map.isOpen());
+}
@@ -0,0 +1,108 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "Structures/Mosaic.hpp"
+
+constexpr int k_width = 6;
+constexpr int k_height = 4;
+
+static Mosaic MakeScaled(CFAPattern cfa)
+{
+    Mosaic mosaic(cfa);
+    Plane values(k_width, k_height, Precision::Double);
+
+    for (int row = 0; row < k_height; ++row) {
+        for (int col = 0; col < k_width; ++col) {
+            values.set(row, col, (row * k_width + col) / 100.0);
+        }
+    }
+    mosaic.allocateRaw(k_width, k_height);
+    mosaic.setScaled(std::move(values));
+    return mosaic;
+}
+
+TEST(MosaicTest, RawValues)
+{
+    Mosaic mosaic;
+    EXPECT_TRUE(mosaic.empty());
+
+    mosaic.allocateRaw(k_width, k_height);
+    EXPECT_EQ(mosaic.getWidth(), k_width);
+    EXPECT_EQ(mosaic.getHeight(), k_height);
+    EXPECT_FALSE(mosaic.isScaled());
+
+    mosaic.getRawRow(2)[3] = 1234;
+    EXPECT_EQ(mosaic.getRaw(2, 3), 1234);
+}
+
+TEST(MosaicTest, ScaledReleasesRaw)
+{
+    const Mosaic mosaic = MakeScaled(CFAPattern::Filter::RGGB);
+    EXPECT_TRUE(mosaic.isScaled());
+    EXPECT_FALSE(mosaic.empty());
+    EXPECT_EQ(mosaic.getWidth(), k_width);
+    EXPECT_EQ(mosaic.getHeight(), k_height);
+}
+
+TEST(MosaicTest, FilterChannelOnly)
+{
+    const CFAPattern cfa(CFAPattern::Filter::GRBG);
+    const Mosaic mosaic = MakeScaled(cfa);
+
+    for (int row = 0; row < k_height; ++row) {
+        for (int col = 0; col < k_width; ++col) {
+            const double value = (row * k_width + col) / 100.0;
+            const Color::RGB64 rgb = mosaic.getValue(row, col);
+
+            switch (cfa(row, col)) {
+            case CFAPattern::Color::RED:
+                EXPECT_EQ(mosaic.getValueR(row, col), value);
+                EXPECT_EQ(mosaic.getValueG(row, col), 0.0);
+                EXPECT_EQ(mosaic.getValueB(row, col), 0.0);
+                EXPECT_EQ(rgb.r, value);
+                break;
+            case CFAPattern::Color::BLUE:
+                EXPECT_EQ(mosaic.getValueR(row, col), 0.0);
+                EXPECT_EQ(mosaic.getValueG(row, col), 0.0);
+                EXPECT_EQ(mosaic.getValueB(row, col), value);
+                EXPECT_EQ(rgb.b, value);
+                break;
+            default:
+                EXPECT_EQ(mosaic.getValueR(row, col), 0.0);
+                EXPECT_EQ(mosaic.getValueG(row, col), value);
+                EXPECT_EQ(mosaic.getValueB(row, col), 0.0);
+                EXPECT_EQ(rgb.g, value);
+                break;
+            }
+            EXPECT_EQ(rgb.r + rgb.g + rgb.b, value);
+            EXPECT_EQ(mosaic.getValueX(row, col, cfa(row, col)), value);
+        }
+    }
+}
+
+TEST(MosaicTest, Clear)
+{
+    Mosaic mosaic = MakeScaled(CFAPattern::Filter::BGGR);
+    mosaic.clear();
+    EXPECT_TRUE(mosaic.empty());
+    EXPECT_EQ(mosaic.getWidth(), 0);
+    EXPECT_EQ(mosaic.getHeight(), 0);
+}
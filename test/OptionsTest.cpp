@@ -33,6 +33,7 @@ TEST(OptionsTest, DefaultsTest)
     EXPECT_EQ(opt.getDemosaicIter(), 3);
     EXPECT_EQ(opt.getColorProfile(), ColorProfile::sRGB);
     EXPECT_EQ(opt.getBitDepth(), 8);
+    EXPECT_EQ(opt.getPrecision(), k_defaultPrecision);
     EXPECT_NEAR(opt.getTemperature(), 5000, tolerance);
     EXPECT_EQ(opt.getTint(), 0);
     EXPECT_NEAR(opt.getExposure(), 0, tolerance);
@@ -40,6 +41,7 @@ TEST(OptionsTest, DefaultsTest)
     EXPECT_EQ(opt.getNoCrop(), false);
     EXPECT_EQ(opt.getNoProcess(),false);
     EXPECT_EQ(opt.getVerbose(), false);
+    EXPECT_EQ(opt.getDecodeIndex(), false);
     EXPECT_EQ(opt.getArtistName(), std::string(""));
 }
 
@@ -57,3 +59,90 @@ TEST(OptionsTest, InputFileTest)
     EXPECT_EQ(errors, 0);
     EXPECT_EQ(opt.getInputFile().getPath(), fileName);
 }
+
+TEST(OptionsTest, PrecisionTest)
+{
+    const char* args[] = {"exe", "-P", "float", "cosi.cr2"};
+    constexpr int argc = sizeof(args) / sizeof(char*);
+
+    CmdLine::Parser p;
+    p.addOption("P", "Precision", "", CmdLine::OptionType::STRING);
+    EXPECT_EQ(p.parse(argc, args), 0);
+
+    Options opt;
+    const int errors = opt.process(p);
+    EXPECT_EQ(errors, 0);
+    EXPECT_EQ(opt.getPrecision(), Precision::Float);
+}
+
+TEST(OptionsTest, DemosaicAlgTest)
+{
+    const char* args[] = {"exe", "-d", "rcd", "cosi.cr2"};
+    constexpr int argc = sizeof(args) / sizeof(char*);
+
+    CmdLine::Parser p;
+    p.addOption("d", "Demosaic", "", CmdLine::OptionType::STRING);
+    EXPECT_EQ(p.parse(argc, args), 0);
+
+    Options opt;
+    const int errors = opt.process(p);
+    EXPECT_EQ(errors, 0);
+    EXPECT_EQ(opt.getDemosaicAlg(), Demosaic::AlgorithmType::RCD);
+
+    const char* argsHybrid[] = {"exe", "-d", "hybrid", "cosi.cr2"};
+    CmdLine::Parser ph;
+    ph.addOption("d", "Demosaic", "", CmdLine::OptionType::STRING);
+    EXPECT_EQ(ph.parse(argc, argsHybrid), 0);
+
+    Options optHybrid;
+    EXPECT_EQ(optHybrid.process(ph), 0);
+    EXPECT_EQ(optHybrid.getDemosaicAlg(), Demosaic::AlgorithmType::Hybrid);
+}
+
+TEST(OptionsTest, Fast8Test)
+{
+    const char* args[] = {"exe", "-F", "-b", "16", "cosi.cr2"};
+    constexpr int argc = sizeof(args) / sizeof(char*);
+
+    CmdLine::Parser p;
+    p.addOption("b", "BitDepth", "", CmdLine::OptionType::INT);
+    p.addSwitch("F", "Fast 8-bit", true);
+    EXPECT_EQ(p.parse(argc, args), 0);
+
+    Options opt; // Fast path writes only 8 bits
+    EXPECT_EQ(opt.process(p), 1);
+
+    const char* args8[] = {"exe", "-F", "cosi.cr2"};
+    CmdLine::Parser p8;
+    p8.addSwitch("F", "Fast 8-bit", true);
+    EXPECT_EQ(p8.parse(3, args8), 0);
+
+    Options opt8; // Defaults to HQLinear
+    EXPECT_EQ(opt8.process(p8), 0);
+    EXPECT_TRUE(opt8.getFast8());
+    EXPECT_EQ(opt8.getDemosaicAlg(), Demosaic::AlgorithmType::HQLinear);
+}
+
+TEST(OptionsTest, HalfSizeTest)
+{
+    const char* args[] = {"exe", "-H", "cosi.cr2"};
+    constexpr int argc = sizeof(args) / sizeof(char*);
+
+    CmdLine::Parser p;
+    p.addSwitch("F", "Fast 8-bit", true);
+    p.addSwitch("H", "Half size", true);
+    EXPECT_EQ(p.parse(argc, args), 0);
+
+    Options opt;
+    EXPECT_EQ(opt.process(p), 0);
+    EXPECT_TRUE(opt.getHalfSize());
+
+    const char* argsFast[] = {"exe", "-H", "-F", "cosi.cr2"};
+    CmdLine::Parser pFast;
+    pFast.addSwitch("F", "Fast 8-bit", true);
+    pFast.addSwitch("H", "Half size", true);
+    EXPECT_EQ(pFast.parse(4, argsFast), 0);
+
+    Options optFast; // Not in the fast path
+    EXPECT_EQ(optFast.process(pFast), 1);
+}
@@ -0,0 +1,170 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "TestImage.hpp"
+
+#include "Demosaic/AHD.hpp"
+#include "Demosaic/Bilinear.hpp"
+#include "Demosaic/HQLinear.hpp"
+#include "Demosaic/RCD.hpp"
+
+constexpr int k_width = 160;
+constexpr int k_height = 120;
+constexpr int k_border = 4;
+
+// Tolerance between float and double results
+constexpr double k_tolerance = 1e-6;
+
+/// <summary>
+/// Allowed difference from the double precision results
+/// </summary>
+struct Tolerance {
+    double max, mean; // Plane values
+    int output16;     // Codes of the 16-bit output
+};
+
+// Kernels compute in float, the rounding adds up over the RCD steps
+constexpr Tolerance k_floatTolerance{10 * k_tolerance, k_tolerance, 1};
+// RCD green ratios of pixels two apart amplify it on the edges
+constexpr Tolerance k_rcdFloatTolerance{20 * k_tolerance, k_tolerance, 1};
+// AHD may select the other direction on a few edge pixels by float Lab
+constexpr Tolerance k_ahdFloatTolerance{2e-4, k_tolerance, 8};
+// AHD may select the other direction on some edge pixels with half input
+constexpr Tolerance k_halfTolerance{0.05, 2e-4, 3300};
+
+/// <summary>
+/// Smooth synthetic scene with some edges
+/// </summary>
+static double SceneValue(int row, int col)
+{
+    const double smooth = 0.25 + 0.2 * std::sin(row * 0.07)
+        * std::cos(col * 0.05) + 0.001 * (row + col);
+    return (col / 16 + row / 16) % 3 == 0 ? smooth + 0.3 : smooth;
+}
+
+static void CompareDemosaic(Demosaic::IAlgorithm& algorithm,
+    Precision precision = Precision::Float,
+    const Tolerance& tolerance = k_floatTolerance)
+{
+    const auto profile = std::make_shared<TestProfile>(
+        k_width, k_height, k_border);
+    const CFAPattern cfa = profile->getCFAPattern();
+    const Mosaic rawDouble = MakeMosaic(cfa,
+        GrayScene(SceneValue), k_width, k_height, Precision::Double);
+    const Mosaic rawFloat = MakeMosaic(cfa,
+        GrayScene(SceneValue), k_width, k_height, precision);
+    const Image imgDouble = DemosaicMosaic(algorithm, profile, rawDouble);
+    const Image imgFloat = DemosaicMosaic(algorithm, profile, rawFloat);
+
+    double maxError = 0.0, sumError = 0.0;
+    for (int row = 0; row < k_height; ++row) {
+        for (int col = 0; col < k_width; ++col) {
+            const Color::RGB64 d = imgDouble.getValue(row, col);
+            const Color::RGB64 f = imgFloat.getValue(row, col);
+            for (const double error : {std::abs(f.r - d.r),
+                std::abs(f.g - d.g), std::abs(f.b - d.b)}) {
+                maxError = std::max(maxError, error);
+                sumError += error;
+            }
+        }
+    }
+    EXPECT_LE(maxError, tolerance.max);
+    EXPECT_LE(sumError / (3.0 * k_width * k_height), tolerance.mean);
+
+    // 16-bit output differs at most by the given codes
+    Array2D<Color::RGB16> outDouble, outFloat;
+    imgDouble.convert16(outDouble, false);
+    imgFloat.convert16(outFloat, false);
+    for (int row = 0; row < outDouble.getHeight(); ++row) {
+        for (int col = 0; col < outDouble.getWidth(); ++col) {
+            const Color::RGB16 d = outDouble[row][col];
+            const Color::RGB16 f = outFloat[row][col];
+            EXPECT_LE(std::abs(f.r - d.r), tolerance.output16);
+            EXPECT_LE(std::abs(f.g - d.g), tolerance.output16);
+            EXPECT_LE(std::abs(f.b - d.b), tolerance.output16);
+        }
+    }
+}
+
+TEST(PrecisionTest, PlaneValues)
+{
+    Plane plane(k_width, k_height, Precision::Float);
+    EXPECT_EQ(plane.getPrecision(), Precision::Float);
+    EXPECT_EQ(plane.getWidth(), k_width);
+    EXPECT_EQ(plane.getHeight(), k_height);
+
+    plane.set(3, 4, 0.1);
+    EXPECT_EQ(plane.get(3, 4), static_cast<double>(0.1f));
+    EXPECT_NEAR(plane.get(3, 4), 0.1, k_tolerance);
+
+    Plane exact(k_width, k_height, Precision::Double);
+    exact.set(3, 4, 0.1);
+    EXPECT_EQ(exact.get(3, 4), 0.1);
+}
+
+TEST(PrecisionTest, BilinearTest)
+{
+    Demosaic::Bilinear algorithm;
+    CompareDemosaic(algorithm);
+}
+
+TEST(PrecisionTest, HQLinearTest)
+{
+    Demosaic::HQLinear algorithm;
+    CompareDemosaic(algorithm);
+}
+
+TEST(PrecisionTest, AHDTest)
+{
+    Demosaic::AHD algorithm;
+    CompareDemosaic(algorithm, Precision::Float, k_ahdFloatTolerance);
+}
+
+TEST(PrecisionTest, RCDTest)
+{
+    Demosaic::RCD algorithm;
+    CompareDemosaic(algorithm, Precision::Float, k_rcdFloatTolerance);
+}
+
+TEST(PrecisionTest, HalfPlaneValues)
+{
+    Plane plane(k_width, k_height, Precision::Half);
+    EXPECT_EQ(plane.getPrecision(), Precision::Half);
+    EXPECT_EQ(plane.getWidth(), k_width);
+
+    // Relative error under the half mantissa step
+    for (const double value : {0.1, 0.5, 0.999, 1e-3}) {
+        plane.set(3, 4, value);
+        EXPECT_NEAR(plane.get(3, 4), value, value * std::ldexp(1.0, -11));
+    }
+}
+
+TEST(PrecisionTest, HalfBilinearTest)
+{
+    Demosaic::Bilinear algorithm;
+    CompareDemosaic(algorithm, Precision::Half, k_halfTolerance);
+}
+
+TEST(PrecisionTest, HalfAHDTest)
+{
+    Demosaic::AHD algorithm;
+    CompareDemosaic(algorithm, Precision::Half, k_halfTolerance);
+}
@@ -0,0 +1,208 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "TestImage.hpp"
+
+#include "Demosaic/Bilinear.hpp"
+#include "Demosaic/RCD.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+/// <summary>
+/// Demosaic the CFA samples of the scene
+/// </summary>
+static Image DemosaicScene(Demosaic::IAlgorithm& algorithm,
+    const Scene& scene, int width, int height, int border)
+{
+    const auto profile = std::make_shared<TestProfile>(width, height, border);
+    const Mosaic mosaic = MakeMosaic(
+        profile->getCFAPattern(), scene, width, height);
+    return DemosaicMosaic(algorithm, profile, mosaic);
+}
+
+/// <summary>
+/// Flat colors on the whole active area, so the tiles and the
+/// mirrored border are used correctly too
+/// </summary>
+static void CheckFlatColors(int width, int height, int border)
+{
+    // Only the small constants against division by zero
+    Demosaic::RCD rcd;
+    CheckFlatColors(rcd, width, height, border, 0, 1e-4);
+}
+
+TEST(RCDTest, FlatColorsTest)
+{
+    CheckFlatColors(100, 80, 4);
+}
+
+TEST(RCDTest, FlatColorsPhaseTest)
+{
+    // Odd borders and sizes start rows with the other phase
+    CheckFlatColors(101, 83, 5);
+}
+
+TEST(RCDTest, FlatColorsTilesTest)
+{
+    CheckFlatColors(461, 397, 5);
+}
+
+/// <summary>
+/// Colored scene with smooth parts and sharp edges
+/// </summary>
+static Color::RGB64 SceneValue(int row, int col)
+{
+    const double smooth = 0.25 + 0.2 * std::sin(row * 0.07)
+        * std::cos(col * 0.05);
+    const double edge = (col / 16 + row / 16) % 3 == 0 ? 0.3 : 0.0;
+    return {0.8 * smooth + edge, smooth + edge, 0.6 * smooth + edge};
+}
+
+TEST(RCDTest, AccuracyTest)
+{
+    constexpr int width = 400, height = 300, border = 4;
+    Demosaic::RCD rcd;
+    Demosaic::Bilinear bilinear;
+    const Image imgRCD = DemosaicScene(rcd, SceneValue, width, height, border);
+    const Image imgBilinear = DemosaicScene(bilinear, SceneValue, width, height, border);
+
+    // RCD must be closer to the scene than bilinear interpolation
+    double errorRCD = 0.0, errorBilinear = 0.0;
+    for (int row = border + 2; row < height - border - 2; ++row) {
+        for (int col = border + 2; col < width - border - 2; ++col) {
+            const Color::RGB64 scene = SceneValue(row, col);
+            const Color::RGB64 r = imgRCD.getValue(row, col);
+            const Color::RGB64 b = imgBilinear.getValue(row, col);
+            errorRCD += std::abs(r.r - scene.r) + std::abs(r.g - scene.g)
+                + std::abs(r.b - scene.b);
+            errorBilinear += std::abs(b.r - scene.r) + std::abs(b.g - scene.g)
+                + std::abs(b.b - scene.b);
+        }
+    }
+    EXPECT_LT(errorRCD, 0.5 * errorBilinear);
+}
+
+/// <summary>
+/// Green of RCD v2.3 on a red or blue pixel, straight from the paper
+/// </summary>
+/// <remarks>
+/// Works on the whole mosaic without tiles, so the pixel must be at
+/// least 8 pixels inside of the active area.
+/// </remarks>
+static double ReferenceGreen(const std::function<double(int, int)>& cfa,
+    int row, int col)
+{
+    constexpr double eps = 1e-5, epssq = 1e-10;
+    auto sqr = [](double x) { return x * x; };
+    auto vhDir = [&](int r, int c) {
+        auto v = [&](int r, int c) {
+            return sqr((cfa(r - 3, c) - cfa(r - 1, c) - cfa(r + 1, c)
+                + cfa(r + 3, c)) - 3 * (cfa(r - 2, c) + cfa(r + 2, c))
+                + 6 * cfa(r, c));
+        };
+        auto h = [&](int r, int c) {
+            return sqr((cfa(r, c - 3) - cfa(r, c - 1) - cfa(r, c + 1)
+                + cfa(r, c + 3)) - 3 * (cfa(r, c - 2) + cfa(r, c + 2))
+                + 6 * cfa(r, c));
+        };
+        const double vstat = std::max(epssq,
+            v(r - 1, c) + v(r, c) + v(r + 1, c));
+        const double hstat = std::max(epssq,
+            h(r, c - 1) + h(r, c) + h(r, c + 1));
+        return vstat / (vstat + hstat);
+    };
+    auto lpf = [&](int r, int c) {
+        return cfa(r, c) + 0.5 * (cfa(r - 1, c) + cfa(r + 1, c)
+            + cfa(r, c - 1) + cfa(r, c + 1))
+            + 0.25 * (cfa(r - 1, c - 1) + cfa(r - 1, c + 1)
+            + cfa(r + 1, c - 1) + cfa(r + 1, c + 1));
+    };
+
+    // Cardinal gradients
+    const double ngrad = eps + std::abs(cfa(row - 1, col) - cfa(row + 1, col))
+        + std::abs(cfa(row, col) - cfa(row - 2, col))
+        + std::abs(cfa(row - 1, col) - cfa(row - 3, col))
+        + std::abs(cfa(row - 2, col) - cfa(row - 4, col));
+    const double sgrad = eps + std::abs(cfa(row - 1, col) - cfa(row + 1, col))
+        + std::abs(cfa(row, col) - cfa(row + 2, col))
+        + std::abs(cfa(row + 1, col) - cfa(row + 3, col))
+        + std::abs(cfa(row + 2, col) - cfa(row + 4, col));
+    const double wgrad = eps + std::abs(cfa(row, col - 1) - cfa(row, col + 1))
+        + std::abs(cfa(row, col) - cfa(row, col - 2))
+        + std::abs(cfa(row, col - 1) - cfa(row, col - 3))
+        + std::abs(cfa(row, col - 2) - cfa(row, col - 4));
+    const double egrad = eps + std::abs(cfa(row, col - 1) - cfa(row, col + 1))
+        + std::abs(cfa(row, col) - cfa(row, col + 2))
+        + std::abs(cfa(row, col + 1) - cfa(row, col + 3))
+        + std::abs(cfa(row, col + 2) - cfa(row, col + 4));
+
+    // Cardinal estimations by the same colored sites two pixels away
+    const double l2 = 2 * lpf(row, col);
+    const double nest = cfa(row - 1, col) * l2
+        / (eps + lpf(row, col) + lpf(row - 2, col));
+    const double sest = cfa(row + 1, col) * l2
+        / (eps + lpf(row, col) + lpf(row + 2, col));
+    const double west = cfa(row, col - 1) * l2
+        / (eps + lpf(row, col) + lpf(row, col - 2));
+    const double eest = cfa(row, col + 1) * l2
+        / (eps + lpf(row, col) + lpf(row, col + 2));
+    const double vest = (sgrad * nest + ngrad * sest) / (ngrad + sgrad);
+    const double hest = (wgrad * eest + egrad * west) / (egrad + wgrad);
+
+    // Refined discrimination
+    const double central = vhDir(row, col);
+    const double neighbourhood = 0.25 * (vhDir(row - 1, col - 1)
+        + vhDir(row - 1, col + 1) + vhDir(row + 1, col - 1)
+        + vhDir(row + 1, col + 1));
+    const double disc = std::abs(0.5 - central) < std::abs(0.5 - neighbourhood)
+        ? neighbourhood : central;
+    return disc * hest + (1 - disc) * vest;
+}
+
+TEST(RCDTest, ReferenceGreenTest)
+{
+    constexpr int width = 100, height = 80, border = 4;
+    const auto profile = std::make_shared<TestProfile>(width, height, border);
+    const CFAPattern cfa = profile->getCFAPattern();
+    auto sample = [&](int row, int col) {
+        const Color::RGB64 value = SceneValue(row, col);
+        switch (cfa(row, col)) {
+        case CFAPattern::Color::RED: return value.r;
+        case CFAPattern::Color::BLUE: return value.b;
+        default: return value.g;
+        }
+    };
+    Demosaic::RCD rcd;
+    const Image img = DemosaicScene(rcd, SceneValue, width, height, border);
+
+    // Relative differences only by the eps constants
+    for (int row = border + 8; row < height - border - 8; ++row) {
+        for (int col = border + 8; col < width - border - 8; ++col) {
+            if (CFAPattern::isGreen(cfa(row, col)))
+                continue;
+            const double expect = ReferenceGreen(sample, row, col);
+            ASSERT_NEAR(img.getValue(row, col).g, expect, 1e-4 * expect)
+                << row << ", " << col;
+        }
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.hpp"
+#include "TestImage.hpp"
+
+#include "Demosaic/RowAdvice.hpp"
+
+constexpr int k_width = 64;
+constexpr int k_height = 48;
+
+/// <summary>
+/// Only the last finished tile of a row of tiles finishes the row,
+/// whatever order the tiles finish in.
+/// </summary>
+TEST(RowAdviceTest, FinishTest)
+{
+    const auto profile = std::make_shared<TestProfile>(k_width, k_height, 0);
+    const Mosaic mosaic = MakeMosaic(profile->getCFAPattern(),
+        GrayScene([](int, int) { return 0.5; }), k_width, k_height);
+
+    // Two rows of three tiles, one of two
+    Demosaic::RowAdvice advice(mosaic, {0, 0, 0, 1, 1, 2, 2});
+    advice.begin(0, 16);
+    EXPECT_FALSE(advice.finish(2, 0, 16));
+    EXPECT_FALSE(advice.finish(3, 16, 32));
+    EXPECT_FALSE(advice.finish(0, 0, 16));
+    EXPECT_TRUE(advice.finish(4, 16, 32));
+    EXPECT_TRUE(advice.finish(1, 0, 16));
+    EXPECT_FALSE(advice.finish(6, 32, 48));
+    EXPECT_TRUE(advice.finish(5, 32, 48));
+
+    // Bands are rows of their own
+    Demosaic::RowAdvice bands(mosaic, 3);
+    for (int band = 2; band >= 0; band--) {
+        EXPECT_TRUE(bands.finish(band, band * 16, band * 16 + 16));
+    }
+}
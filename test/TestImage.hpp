@@ -0,0 +1,201 @@
+/*
+ * This file is part of RawDev;
+ * see <https://github.com/petrk23/RawDev>.
+ *
+ * Copyright (C) 2020-2025 Petr Krajník
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+Synthetic images shared by the tests
+*/
+#include "CamProfiles/CamProfile.hpp"
+#include "Demosaic/Algorithm.hpp"
+#include "Structures/Image.hpp"
+#include "Structures/Plane.hpp"
+
+#include <functional>
+#include <memory>
+
+/// <summary>
+/// Camera profile of a synthetic raw image
+/// </summary>
+/// <remarks>
+/// Color matrices are from the 6D, so the images can be also
+/// processed into RGB.
+/// </remarks>
+class TestProfile : public CamProfile {
+public:
+    TestProfile(Rect active, Rect crop,
+        CFAPattern::Filter filter = CFAPattern::Filter::RGGB);
+    TestProfile(int width, int height, int border,
+        CFAPattern::Filter filter = CFAPattern::Filter::RGGB);
+    TestProfile(const CamProfile& camera, int width, int height, int border);
+
+    void setLevels(Color::RGB64 black, Color::RGB64 white);
+
+    std::string_view getCameraName() const override;
+    CamID getCameraID() const override;
+};
+
+/// <summary>
+/// Scene color at the sensor position
+/// </summary>
+using Scene = std::function<Color::RGB64(int row, int col)>;
+
+Scene GrayScene(const std::function<double(int row, int col)>& value);
+Mosaic MakeMosaic(CFAPattern cfa, const Scene& scene,
+    int width, int height, Precision precision = Precision::Double);
+Image DemosaicMosaic(Demosaic::IAlgorithm& algorithm,
+    const std::shared_ptr<CamProfile>& profile, const Mosaic& mosaic);
+void CheckFlatColors(Demosaic::IAlgorithm& algorithm, int width,
+    int height, int border, int margin, double tolerance);
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline TestProfile::TestProfile(
+    Rect active, Rect crop, CFAPattern::Filter filter)
+    : CamProfile(5'000)
+{
+    const auto cam = MakeCamProfile(CamID::EOS_6D, 5'000);
+
+    if (filter != getCFAPattern().getFilter())
+        setCFAPattern(filter);
+    setActiveArea(active);
+    setCrop(crop);
+    setColorMatrix(cam->getColorMatrix(), cam->getColorMatrix());
+}
+
+/// <summary>
+/// Profile with the same border on all sides as active area and crop
+/// </summary>
+inline TestProfile::TestProfile(
+    int width, int height, int border, CFAPattern::Filter filter)
+    : TestProfile(Rect(Point(border, border),
+            Point(width - border, height - border)),
+        Rect(Point(border, border), Point(width - border, height - border)),
+        filter)
+{
+}
+
+/// <summary>
+/// Profile with all colors of the camera, maps included
+/// </summary>
+inline TestProfile::TestProfile(
+    const CamProfile& camera, int width, int height, int border)
+    : CamProfile(camera)
+{
+    const Rect area(Point(border, border),
+        Point(width - border, height - border));
+    setActiveArea(area);
+    setCrop(area);
+}
+
+inline void TestProfile::setLevels(Color::RGB64 black, Color::RGB64 white)
+{
+    setBlackLevel(black);
+    setWhiteLevel(white);
+}
+
+inline std::string_view TestProfile::getCameraName() const
+{
+    return "Test";
+}
+
+inline CamID TestProfile::getCameraID() const
+{
+    return CamID::EOS_6D;
+}
+
+/// <summary>
+/// Scene with the same value in all colors
+/// </summary>
+inline Scene GrayScene(const std::function<double(int row, int col)>& value)
+{
+    return [value](int row, int col) {
+        const double v = value(row, col);
+        return Color::RGB64{v, v, v};
+    };
+}
+
+/// <summary>
+/// Scaled mosaic sampling the scene through the CFA
+/// </summary>
+inline Mosaic MakeMosaic(CFAPattern cfa, const Scene& scene,
+    int width, int height, Precision precision)
+{
+    Mosaic mosaic(cfa);
+    Plane values(width, height, precision);
+
+    mosaic.allocateRaw(width, height);
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            const Color::RGB64 value = scene(row, col);
+            switch (cfa(row, col)) {
+            case CFAPattern::Color::RED:
+                values.set(row, col, value.r);
+                break;
+            case CFAPattern::Color::BLUE:
+                values.set(row, col, value.b);
+                break;
+            default:
+                values.set(row, col, value.g);
+                break;
+            }
+        }
+    }
+    mosaic.setScaled(std::move(values));
+    return mosaic;
+}
+
+/// <summary>
+/// Demosaic the mosaic into a new image of the profile
+/// </summary>
+inline Image DemosaicMosaic(Demosaic::IAlgorithm& algorithm,
+    const std::shared_ptr<CamProfile>& profile, const Mosaic& mosaic)
+{
+    Image img(profile);
+    img.allocateRGB(mosaic);
+    algorithm.demosaic(mosaic, img);
+    return img;
+}
+
+/// <summary>
+/// Every CFA color with its own flat level must give the same
+/// RGB value on all pixels, so all phases are used correctly.
+/// </summary>
+/// <param name="margin">Pixels inside the active area not checked</param>
+/// <param name="tolerance">Allowed difference from the levels</param>
+inline void CheckFlatColors(Demosaic::IAlgorithm& algorithm, int width,
+    int height, int border, int margin, double tolerance)
+{
+    constexpr Color::RGB64 level{0.2, 0.5, 0.8};
+    const auto profile = std::make_shared<TestProfile>(width, height, border);
+    const Mosaic mosaic = MakeMosaic(profile->getCFAPattern(),
+        [&](int, int) { return level; }, width, height);
+    const Image img = DemosaicMosaic(algorithm, profile, mosaic);
+
+    const int first = border + margin;
+    for (int row = first; row < height - first; ++row) {
+        for (int col = first; col < width - first; ++col) {
+            const Color::RGB64 value = img.getValue(row, col);
+            ASSERT_NEAR(value.r, level.r, tolerance) << row << ", " << col;
+            ASSERT_NEAR(value.g, level.g, tolerance) << row << ", " << col;
+            ASSERT_NEAR(value.b, level.b, tolerance) << row << ", " << col;
+        }
+    }
+}
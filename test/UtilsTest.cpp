@@ -86,6 +86,23 @@ TEST(UtilsTest, CompareDoubleTest)
     EXPECT_EQ(Utils::compareDouble(&b, &a), 1);
 }
 
+TEST(UtilsTest, Median9Test)
+{
+    std::mt19937 gen(9);
+    std::uniform_int_distribution<int> dist(-5, 5); // With duplicates
+    std::array<double, 9> v;
+
+    for (int i = 0; i < 10'000; ++i) {
+        for (double& x : v) {
+            x = dist(gen);
+        }
+        const double med = Utils::median9(
+            v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8]);
+        std::sort(v.begin(), v.end());
+        EXPECT_EQ(med, v[4]);
+    }
+}
+
 TEST(UtilsTest, LinearInterpolationTest)
 {
     // First variant